@@ -0,0 +1,361 @@
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include "../include/NewtonCG.h"
+#include "../include/inout.h"
+
+/*
+ * BRANCH OF STEADY STATES BY CONTINUATION IN CHEMICAL POTENTIAL
+ * *************************************************************
+ *
+ * Solve the steady state equation for a sequence of chemical potentials
+ * (and optionally interaction strengths) in a single run.   Each Newton
+ * solve start from a secant prediction with the two previous solutions
+ * of the branch, instead of a cold start from the initial guess file.
+ *
+ * REQUIRED FILES
+ * **************
+ *
+ * setup/fileId_init.dat, setup/fileId_eq.dat and setup/fileId_domain.dat
+ *
+ *      as in mu_steady. The initial guess is used only for the first
+ *      point of the branch and the interaction strength in eq.dat  is
+ *      the one of the first point.
+ *
+ * setup/fileId_mulist.dat (only to sweep a list)
+ *
+ *      text file with the number of points in the first line and then
+ *      one pair of numbers "mu g" per line
+ *
+ * COMMAND LINE ARGUMENTS
+ * **********************
+ *
+ * fileId mu1 mu2 n [g2] [cg] [prec]
+ *
+ *      fileId -> the prefix of required file names
+ *      mu1    -> chemical potential of the first point
+ *      mu2    -> chemical potential of the last point
+ *      n      -> number of points equally spaced in [mu1, mu2]
+ *      g2     -> (optional) interaction strength of the last point. The
+ *                values of g are equally spaced as well
+ *      cg     -> (optional) 'pipelined' to use the pipelined CG
+ *      prec   -> (optional) preconditioner as in mu_steady
+ *
+ * fileId list [cg] [prec]
+ *
+ *      sweep the values of mu and g given in setup/fileId_mulist.dat
+ *
+ * CALL
+ * ****
+ *
+ * ./mu_continuation fileId mu1 mu2 n [g2] [pipelined] [prec]
+ * ./mu_continuation fileId list [pipelined] [prec]
+ *
+ * OUTPUT FILES
+ * ************
+ *
+ * ../gp_data/fileId_mubranch.bin
+ *
+ *      binary file with two int, the number of grid points M + 1 and
+ *      of points in the branch, followed by one record for each point
+ *      of the branch made of the doubles mu, g and final |L0f|,  then
+ *      M + 1 double complex with the steady state. If Newton-CG does
+ *      not converge in some point (e.g. near a fold) the continuation
+ *      stops there, and the number of points in the header is the one
+ *      of records written.
+ *
+ * **************************************************************************/
+
+int main(int argc, char * argv[])
+{
+
+    /* DEFINE THE NUMBER OF THREADS BASED ON THE COMPUTER */
+    mkl_set_num_threads(omp_get_max_threads() / 2);
+    omp_set_num_threads(omp_get_max_threads() / 2);
+
+    double start, time_used; // show time taken for the whole branch
+
+    int i, k, trash; // counters and useless returned values
+
+    int nrec;        // number of points recorded in the branch file
+
+    int cgtype = CG_STANDARD; // Conjugate-Gradient variant
+
+    int prectype = PREC_TRIDIAG; // Preconditioner of Conjugate-Gradient
+
+    int nopt; // Position of first optional argument
+
+    int npts;           // Number of points in the branch
+
+    struct IterNCG It;
+
+    if (argc < 3 || argc > 8)
+    {
+        printf("\nInvalid number of command line arguments, ");
+        printf("expected from 2 to 7.\n\n");
+        return -1;
+    }
+
+    if (strcmp(argv[2], "list") == 0) nopt = 3;
+    else                              nopt = 5;
+
+    for (i = nopt; i < argc; i++)
+    {
+        if (argv[i][0] == 'p') cgtype = CG_PIPELINED;
+        if (argv[i][0] == 'b') prectype = PREC_BLOCKTRI;
+        if (argv[i][0] == 'i') prectype = PREC_ILU0;
+        if (argv[i][0] == 'f') prectype = PREC_SPECTRAL;
+    }
+
+
+
+    /*          ********************************************          */
+    /*          Setup domain of solution and method to solve          */
+    /*          ********************************************          */
+
+
+
+    double x1, x2, dx;  // Position domain = [x1, x2] interval
+    unsigned int M;     // M is number of dx
+    Rarray x;           // Discretized positions Vector
+
+    char fname_in[60];      // file configuration names
+    FILE * eq_setup_file;   // pointer to file
+
+    strcpy(fname_in, "setup/");
+    strcat(fname_in, argv[1]);
+    strcat(fname_in, "_domain.dat");
+
+    printf("\nLooking for %s\n", fname_in);
+
+    eq_setup_file = fopen(fname_in, "r");
+
+    if (eq_setup_file == NULL)  // impossible to open file
+    { printf("ERROR: impossible to open file %s\n", fname_in); return -1; }
+
+    trash = fscanf(eq_setup_file, "%lf %lf %d", &x1, &x2, &M);
+
+    fclose(eq_setup_file); // finish reading of file
+
+    dx = (x2 - x1) / M;
+    x  = rarrDef(M + 1);
+    rarrFillInc(M + 1, x1, dx, x);
+
+
+
+    /*                    *************************                    */
+    /*                    Setup equation parameters                    */
+    /*                    *************************                    */
+
+
+
+    double a2,                  // second order derivative coef.
+           inter,               // interaction strength coef.
+           lambda,              // potential parameter
+           a1imag;
+
+    double complex a1;          // First order derivative coef.
+
+    Rarray V = rarrDef(M + 1);  // Potential in discretized positions
+
+    strcpy(fname_in, "setup/");
+    strcat(fname_in, argv[1]);
+    strcat(fname_in, "_eq.dat");
+
+    printf("\nLooking for %s\n", fname_in);
+
+    eq_setup_file = fopen(fname_in, "r");
+
+    if (eq_setup_file == NULL)  // impossible to open file
+    { printf("ERROR: impossible to open file %s\n", fname_in); return -1; }
+
+    trash = fscanf(eq_setup_file, "%lf %lf %lf %lf",
+                   &a2, &a1imag, &inter, &lambda);
+
+    fclose(eq_setup_file); // finish reading of file
+
+    a1 = 0 + a1imag * I;
+
+    rarrFill(M + 1, 0, V);
+    V[M/2] = lambda / dx;
+
+    printf("\nEquation coef. and domain successfully setted up.\n");
+
+
+
+    /*                  *****************************                  */
+    /*                  Values of parameters to sweep                  */
+    /*                  *****************************                  */
+
+
+
+    double mu1, mu2, g2; // Limits of the range
+
+    Rarray mu, g;        // Values of chemical potential and interaction
+
+    if (strcmp(argv[2], "list") == 0)
+    {
+        strcpy(fname_in, "setup/");
+        strcat(fname_in, argv[1]);
+        strcat(fname_in, "_mulist.dat");
+
+        printf("\nLooking for %s\n", fname_in);
+
+        eq_setup_file = fopen(fname_in, "r");
+
+        if (eq_setup_file == NULL)  // impossible to open file
+        { printf("ERROR: impossible to open file %s\n", fname_in); return -1; }
+
+        trash = fscanf(eq_setup_file, "%d", &npts);
+
+        mu = rarrDef(npts);
+        g = rarrDef(npts);
+
+        for (k = 0; k < npts; k++)
+            trash = fscanf(eq_setup_file, "%lf %lf", &mu[k], &g[k]);
+
+        fclose(eq_setup_file); // finish reading of file
+    }
+    else
+    {
+        if (argc < 5)
+        {
+            printf("\nExpected mu1 mu2 n to sweep a range.\n\n");
+            return -1;
+        }
+
+        sscanf(argv[2], "%lf", &mu1);
+        sscanf(argv[3], "%lf", &mu2);
+        sscanf(argv[4], "%d", &npts);
+
+        g2 = inter;
+        if (argc > 5 && strchr("0123456789+-.", argv[5][0]) != NULL)
+            sscanf(argv[5], "%lf", &g2);
+
+        if (npts < 2)
+        {
+            printf("\nExpected at least 2 points in the branch.\n\n");
+            return -1;
+        }
+
+        mu = rarrDef(npts);
+        g = rarrDef(npts);
+
+        rarrFillInc(npts, mu1, (mu2 - mu1) / (npts - 1), mu);
+        rarrFillInc(npts, inter, (g2 - inter) / (npts - 1), g);
+    }
+
+
+
+    /*        ************************************************        */
+    /*            CONTINUATION WITH NEWTON-CG IN EACH POINT           */
+    /*        ************************************************        */
+
+
+
+    double real, imag; // to read data from file
+
+    double ds = 0, ds_old; // distance between consecutive points (mu, g)
+
+    Carray f0 = carrDef(M + 1); // Current point of the branch
+    Carray f1 = carrDef(M + 1); // Solution in the previous point
+    Carray f2 = carrDef(M + 1); // Solution two points before
+
+    strcpy(fname_in, "setup/");
+    strcat(fname_in, argv[1]);
+    strcat(fname_in, "_init.dat");
+
+    printf("\nLooking for %s\n", fname_in);
+
+    eq_setup_file = fopen(fname_in, "r");
+
+    if (eq_setup_file == NULL)  // impossible to open file
+    { printf("ERROR: impossible to open file %s\n", fname_in); return -1; }
+
+    for (i = 0; i < M + 1; i++)
+    {
+        trash = fscanf(eq_setup_file, " (%lf+%lfj)", &real, &imag);
+        f0[i] = real + I * imag;
+    }
+
+    fclose(eq_setup_file); // finish the reading of file
+
+    char fname_out[60];
+
+    strcpy(fname_out, "../gp_data/");
+    strcat(fname_out, argv[1]);
+    strcat(fname_out, "_mubranch.bin");
+
+    FILE * branch_file = fopen(fname_out, "wb");
+
+    if (branch_file == NULL)  // impossible to open file
+    { printf("ERROR: impossible to open file %s\n", fname_out); return -1; }
+
+    // the number of points is written again at the end with the points
+    // actually recorded
+    k = M + 1;
+    nrec = 0;
+    fwrite(&k, sizeof(int), 1, branch_file);
+    fwrite(&nrec, sizeof(int), 1, branch_file);
+
+    printf("\nGot Initial attempt. Starting continuation ...\n");
+
+    ds_old = 1;
+    start = omp_get_wtime();
+
+    for (k = 0; k < npts; k++)
+    {
+        if (k > 0) ds = hypot(mu[k] - mu[k-1], g[k] - g[k-1]);
+
+        // Predictor : secant with the two previous points of the branch
+        // or only the previous solution for the second point
+        if (k > 1 && ds_old > 0)
+        {
+            carrSub(M + 1, f1, f2, f0);
+            carrUpdate(M + 1, f1, ds / ds_old, f0, f0);
+        }
+        else if (k == 1) carrCopy(M + 1, f1, f0);
+
+        printf("\n\nPoint %d of %d : mu = %.6lf  g = %.6lf\n",
+               k + 1, npts, mu[k], g[k]);
+
+        It = ncg(M + 1, 1E-7, 50, dx, a2, a1, g[k], mu[k], V, f0,
+                 cgtype, prectype);
+
+        iteration_info(It);
+
+        if (!It.converged)
+        {
+            printf("\nNewton-CG did not converge, stopping the branch ");
+            printf("after %d points\n", nrec);
+            break;
+        }
+
+        fwrite(&mu[k], sizeof(double), 1, branch_file);
+        fwrite(&g[k], sizeof(double), 1, branch_file);
+        fwrite(&It.res, sizeof(double), 1, branch_file);
+        fwrite(f0, sizeof(double complex), M + 1, branch_file);
+        nrec = nrec + 1;
+
+        // Shift the solutions used by the predictor
+        carrCopy(M + 1, f1, f2);
+        carrCopy(M + 1, f0, f1);
+        if (k > 0) ds_old = ds;
+    }
+
+    time_used = (double) (omp_get_wtime() - start);
+    printf("\nTime taken in continuation : %.3f s\n", time_used);
+
+    fseek(branch_file, sizeof(int), SEEK_SET);
+    fwrite(&nrec, sizeof(int), 1, branch_file);
+    fclose(branch_file);
+
+    /*** release memory ***/
+
+    free(x); free(V); free(f0); free(f1); free(f2); free(mu); free(g);
+
+    /* END */
+
+    printf("\n");
+    return 0;
+}
@@ -2,6 +2,7 @@
 #include <stdio.h>
 #include <math.h>
 #include "../include/NewtonCG.h"
+#include "../include/inout.h"
 
 /* 
  * OBTAIN AN STEADY STATE USING NEWTON METHOD FOR OPERATORS
@@ -38,15 +39,20 @@
  * COMMAND LINE ARGUMENTS
  * **********************
  * 
- * mu fileId
+ * mu fileId [cg] [prec]
  *
  *      mu     -> Value of chemical potential
  *      fileId -> the prefix of required file name
+ *      cg     -> (optional) 'pipelined' to use the pipelined CG in
+ *                the Newton iterations, better for large grids
+ *      prec   -> (optional) preconditioner of CG: 'tridiag' (default)
+ *                'block' (2 x 2 blocks coupling real and imaginary
+ *                parts), 'ilu' (incomplete LU) or 'fft' (spectral)
  *
  * CALL
  * ****
  *
- * ./mu_steady mu fileId
+ * ./mu_steady mu fileId [pipelined] [tridiag|block|ilu|fft]
  *
  * OUTPUT FILES
  * ************
@@ -64,15 +70,27 @@ int main(int argc, char * argv[])
 
     int trash; // Useless returned values
 
+    int cgtype = CG_STANDARD; // Conjugate-Gradient variant
+
+    int prectype = PREC_TRIDIAG; // Preconditioner of Conjugate-Gradient
+
     struct IterNCG It;
 
-    if (argc != 3)
+    if (argc < 3 || argc > 5)
     {
         printf("\nInvalid number of command line arguments, ");
-        printf("expected 2.\n\n");
+        printf("expected from 2 to 4.\n\n");
         return -1;
     }
 
+    for (int i = 3; i < argc; i++)
+    {
+        if (argv[i][0] == 'p') cgtype = CG_PIPELINED;
+        if (argv[i][0] == 'b') prectype = PREC_BLOCKTRI;
+        if (argv[i][0] == 'i') prectype = PREC_ILU0;
+        if (argv[i][0] == 'f') prectype = PREC_SPECTRAL;
+    }
+
 
 
     /*          ********************************************          */
@@ -186,12 +204,19 @@ int main(int argc, char * argv[])
     printf("\nGot Initial attempt. Calling NewtonCG routines ...\n");
 
     start  = omp_get_wtime();
+    It = ncg(M + 1, 1E-7, 50, dx, a2, a1, inter, mu, V, f0, cgtype,
+             prectype);
     time_used = (double) (omp_get_wtime() - start);
-    It = ncg(M + 1, 1E-7, 50, dx, a2, a1, inter, mu, V, f0);
     printf("\nTime taken NewtonCG : %.3f ms\n", time_used * 1E3);
 
     iteration_info(It);
 
+    if (!It.converged)
+    {
+        printf("\nERROR : Newton-CG did not converge, nothing recorded\n\n");
+        return -1;
+    }
+
 
 
     /*                          ***********                          */
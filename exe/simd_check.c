@@ -0,0 +1,263 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "array_memory.h"
+#include "array_operations.h"
+#include "array_simd.h"
+
+/*
+ * CHECK THE SIMD KERNELS AGAINST THE SCALAR LOOPS
+ * ***********************************************
+ *
+ * For every instruction set available in the processor  (see simdLevel)
+ * the routines of array_operations that dispatch to the SIMD kernels are
+ * compared with the scalar path (simdForce(SIMD_NONE)) on random data:
+ *
+ *      carrMultiply, carrUpdate, rcarrUpdate, carrAbs2, carrDot
+ *
+ * All lengths from 1 to 40 are tried, to cover the tails shorter than a
+ * register, some odd sizes around powers of 2,  and  one  size  above
+ * OMP_MIN_SIZE that goes through the threaded chunks. Each length is
+ * taken with the arrays aligned and shifted by one element, and the
+ * product also with the output equal to the second input.
+ *
+ * CALL
+ * ****
+ *
+ * ./simd_check
+ *
+ * Print one line for each instruction set checked and return nonzero if
+ * some result differs from the scalar one by more than a few rounding
+ * errors (the kernels use fused multiply-add).
+ *
+ * **************************************************************************/
+
+
+
+#define CHECK_TOL 1E-14
+
+
+
+static double crandom()
+{
+    return 2.0 * rand() / RAND_MAX - 1.0;
+}
+
+
+
+static double maxRelDiff(int n, Carray a, Carray b)
+{
+
+/** Largest difference relative to the largest element of b **/
+
+    int
+        i;
+
+    double
+        diff,
+        scale;
+
+    diff = 0;
+    scale = 1E-300;
+
+    for (i = 0; i < n; i++)
+    {
+        if (cabs(a[i] - b[i]) > diff) diff = cabs(a[i] - b[i]);
+        if (cabs(b[i]) > scale) scale = cabs(b[i]);
+    }
+
+    return diff / scale;
+}
+
+
+
+static double rmaxRelDiff(int n, Rarray a, Rarray b)
+{
+    int
+        i;
+
+    double
+        diff,
+        scale;
+
+    diff = 0;
+    scale = 1E-300;
+
+    for (i = 0; i < n; i++)
+    {
+        if (fabs(a[i] - b[i]) > diff) diff = fabs(a[i] - b[i]);
+        if (fabs(b[i]) > scale) scale = fabs(b[i]);
+    }
+
+    return diff / scale;
+}
+
+
+
+static int checkLength(int level, int n, int shift)
+{
+
+/** Compare all kernels in the given level with the scalar loops for one
+  * length. Return the number of failures **/
+
+    int
+        i,
+        fail;
+
+    double
+        err;
+
+    double complex
+        z,
+        dot,
+        dotref;
+
+    Rarray
+        r,
+        abs2,
+        abs2ref;
+
+    Carray
+        v1,
+        v2,
+        out,
+        ref;
+
+    // the extra element allows shifted (not aligned) pointers
+    v1 = carrDef(n + 1) + shift;
+    v2 = carrDef(n + 1) + shift;
+    out = carrDef(n + 1) + shift;
+    ref = carrDef(n + 1) + shift;
+    r = rarrDef(n + 1) + shift;
+    abs2 = rarrDef(n + 1) + shift;
+    abs2ref = rarrDef(n + 1) + shift;
+
+    for (i = 0; i < n; i++)
+    {
+        v1[i] = crandom() + I * crandom();
+        v2[i] = crandom() + I * crandom();
+        r[i] = crandom();
+    }
+
+    z = crandom() + I * crandom();
+    fail = 0;
+
+    simdForce(SIMD_NONE);
+    carrMultiply(n, v1, v2, ref);
+    simdForce(level);
+    carrMultiply(n, v1, v2, out);
+    err = maxRelDiff(n, out, ref);
+    if (err > CHECK_TOL)
+    { printf("\n  carrMultiply n = %d : %.2E", n, err); fail++; }
+
+    // output in place of the second input
+    carrCopy(n, v2, out);
+    carrMultiply(n, v1, out, out);
+    err = maxRelDiff(n, out, ref);
+    if (err > CHECK_TOL)
+    { printf("\n  carrMultiply in place n = %d : %.2E", n, err); fail++; }
+
+    simdForce(SIMD_NONE);
+    carrUpdate(n, v1, z, v2, ref);
+    simdForce(level);
+    carrUpdate(n, v1, z, v2, out);
+    err = maxRelDiff(n, out, ref);
+    if (err > CHECK_TOL)
+    { printf("\n  carrUpdate n = %d : %.2E", n, err); fail++; }
+
+    simdForce(SIMD_NONE);
+    rcarrUpdate(n, v1, z, r, ref);
+    simdForce(level);
+    rcarrUpdate(n, v1, z, r, out);
+    err = maxRelDiff(n, out, ref);
+    if (err > CHECK_TOL)
+    { printf("\n  rcarrUpdate n = %d : %.2E", n, err); fail++; }
+
+    simdForce(SIMD_NONE);
+    carrAbs2(n, v1, abs2ref);
+    simdForce(level);
+    carrAbs2(n, v1, abs2);
+    err = rmaxRelDiff(n, abs2, abs2ref);
+    if (err > CHECK_TOL)
+    { printf("\n  carrAbs2 n = %d : %.2E", n, err); fail++; }
+
+    // the sums are done in another order, the error grows with n
+    simdForce(SIMD_NONE);
+    dotref = carrDot(n, v1, v2);
+    simdForce(level);
+    dot = carrDot(n, v1, v2);
+    err = cabs(dot - dotref) / (carrMod(n, v1) * carrMod(n, v2));
+    if (err > CHECK_TOL * sqrt(n))
+    { printf("\n  carrDot n = %d : %.2E", n, err); fail++; }
+
+    free(v1 - shift);
+    free(v2 - shift);
+    free(out - shift);
+    free(ref - shift);
+    free(r - shift);
+    free(abs2 - shift);
+    free(abs2ref - shift);
+
+    return fail;
+}
+
+
+
+int main()
+{
+
+    int
+        i,
+        k,
+        level,
+        maxlevel,
+        shift,
+        fail,
+        total;
+
+    // odd sizes around powers of 2 and one threaded size
+    int
+        sizes[] = {63, 64, 65, 127, 129, 255, 257, 1023, 1025,
+                   OMP_MIN_SIZE + 7};
+
+    char
+        names[3][8] = {"none", "AVX2", "AVX512"};
+
+    srand(7);
+
+    maxlevel = simdLevel();
+
+    printf("\nBest instruction set available : %s\n", names[maxlevel]);
+
+    if (maxlevel == SIMD_NONE)
+    {
+        printf("\nNo SIMD kernel to check.\n\n");
+        return 0;
+    }
+
+    total = 0;
+
+    for (level = SIMD_AVX2; level <= maxlevel; level++)
+    {
+        fail = 0;
+        for (shift = 0; shift < 2; shift++)
+        {
+            for (i = 1; i <= 40; i++) fail += checkLength(level, i, shift);
+            for (k = 0; k < sizeof(sizes) / sizeof(int); k++)
+            {
+                fail += checkLength(level, sizes[k], shift);
+            }
+        }
+
+        if (fail == 0) printf("\n%-8s : passed", names[level]);
+        else           printf("\n%-8s : %d failures", names[level], fail);
+        total = total + fail;
+    }
+
+    simdForce(SIMD_AVX512);
+
+    printf("\n\n");
+
+    if (total > 0) return 1;
+    return 0;
+}
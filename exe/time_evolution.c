@@ -27,7 +27,9 @@
  *
  *      is a text file with an array of complex numbers of size M + 1
  *      where M is the number of space slices of the domain. Must  be
- *      formatted according to numpy.savetxt function.
+ *      formatted according to numpy.savetxt function. In imaginary time
+ *      an array of other size is taken as the same box with another grid
+ *      and is resampled (FFT or sine series if the boundaries are zero)
  *
  * setup/fileId_eq.dat
  *
@@ -150,6 +152,114 @@ void SaveConf(FILE * f, EqDataPkg EQ, double dt, double N)
 
 
 
+void ReadInit(FILE * f, int M, int periodic, Carray S)
+{
+
+/** Read a single initial condition (imaginary time) from an opened file.
+  * If the number of values does not match the M + 1 grid points of  the
+  * domain, it is assumed to be given in a grid of the same box and it is
+  * resampled, with FFT for periodic boundaries and with a sine series if
+  * it must vanish at the boundaries **/
+
+    int
+        j,
+        n,
+        trash;
+
+    double
+        real,
+        imag;
+
+    Carray
+        data;
+
+    n = 0;
+    while (fscanf(f, " (%lf%lfj)", &real, &imag) == 2) n = n + 1;
+    rewind(f);
+
+    if (n < 2)  // empty, truncated or malformed file
+    {
+        printf("\n\n\tERROR: %d values read for the initial condition\n\n",
+               n);
+        exit(EXIT_FAILURE);
+    }
+
+    if (n == M + 1) data = S;
+    else            data = carrDef(n);
+
+    for (j = 0; j < n; j++)
+    {
+        trash = fscanf(f, " (%lf%lfj)", &real, &imag);
+        data[j] = real + I * imag;
+    }
+
+    if (data == S) return;
+
+    printf("\nResampling initial condition from %d to %d points", n, M + 1);
+
+    if (periodic) carrResample(n, data, M + 1, S);
+    else        carrResampleSine(n, data, M + 1, S);
+
+    free(data);
+}
+
+
+
+
+
+void ReadProtocol(char prefix[], EqDataPkg EQ, TimePotPkg * P,
+     struct TimeRamp * G)
+{
+
+/** Read the time dependent protocol from input/prefix_td.dat, with two
+  * lines "t1 t2 final" for the ramped parameter of the potential  and
+  * for the interaction. The potential name and initial parameters  are
+  * the ones of EQ **/
+
+    int
+        trash;
+
+    double
+        t1,
+        t2,
+        final;
+
+    char
+        fname[100];
+
+    FILE
+        * td_file;
+
+    strcpy(fname, "input/");
+    strcat(fname, prefix);
+    strcat(fname, "_td.dat");
+
+    td_file = fopen(fname, "r");
+
+    if (td_file == NULL)  // impossible to open file
+    {
+        printf("\n\n\tERROR: impossible to open file %s\n\n", fname);
+        exit(EXIT_FAILURE);
+    }
+
+    trash = fscanf(td_file, "%lf %lf %lf", &t1, &t2, &final);
+    *P = TimePotentialDef(EQ->Vname, EQ->p, t1, t2, final);
+
+    trash = fscanf(td_file, "%lf %lf %lf", &t1, &t2, &final);
+    G->t1 = t1;
+    G->t2 = t2;
+    G->v1 = EQ->inter;
+    G->v2 = final;
+    G->func = NULL;
+    G->data = NULL;
+
+    fclose(td_file);
+}
+
+
+
+
+
 EqDataPkg SetupParams(FILE * paramFile, FILE * confFile,
           char Vname[], double * dt, int * N)
 {
@@ -218,6 +328,8 @@ int main(int argc, char * argv[])
         trash,  // returned values from scanf (unused)
         cyclic, // boolean-like to set boundary conditions
         method, // method of integrator
+        nested, // # of coarse grids in imaginary time (0 to disable)
+        cadence, // steps between energy samples in imaginary time
         resetinit;
 
 
@@ -251,14 +363,20 @@ int main(int argc, char * argv[])
 
 
 
+    double
+        E; // Energy of the system at the end of imaginary time evolution
+
     Carray
-        S, // Starts with initial solution, ends with final time-step
-        E; // Energy of the system on each time-step
+        S; // Starts with initial solution, ends with final time-step
 
 
 
     EqDataPkg EQ;
 
+    TimePotPkg TDpot;        // time dependent potential (method 9)
+
+    struct TimeRamp TDinter; // interaction ramp (method 9)
+
 
 
 
@@ -272,6 +390,8 @@ int main(int argc, char * argv[])
     }
 
     i = 1;
+    nested = 0; // optional last lines
+    cadence = 0;
 
     while ( (c  = getc(job_file)) != EOF)
     {
@@ -315,6 +435,14 @@ int main(int argc, char * argv[])
                 fscanf(job_file, "%d", &resetinit);
                 i = i + 1;
                 break;
+            case 9:
+                fscanf(job_file, "%d", &nested);
+                i = i + 1;
+                break;
+            case 10:
+                fscanf(job_file, "%d", &cadence);
+                i = i + 1;
+                break;
         }
 
         ReachNewLine(job_file);
@@ -323,6 +451,8 @@ int main(int argc, char * argv[])
 
     fclose(job_file);
 
+    if (cadence > 0) convCadenceSet(cadence);
+
 
 
 
@@ -483,15 +613,20 @@ int main(int argc, char * argv[])
      
         ===============================================================  */
 
-    E = carrDef(N + 1); // energy at each time step
-
-    for (i = 0; i < M + 1; i++)
+    if (timeinfo == 'i' || timeinfo == 'I')
     {
-        trash = fscanf(orb_file, " (%lf%lfj)", &real, &imag);
-        S[i] = real + I * imag;
+        // FFT integrators (2 and 5) are always periodic
+        ReadInit(orb_file, M, cyclic || method == 2 || method == 5, S);
+        fclose(orb_file);
+    }
+    else
+    {
+        for (i = 0; i < M + 1; i++)
+        {
+            trash = fscanf(orb_file, " (%lf%lfj)", &real, &imag);
+            S[i] = real + I * imag;
+        }
     }
-
-    if (timeinfo == 'i' || timeinfo == 'I') fclose(orb_file);
 
     printf("\nGot Initial condition. Calling time evolution routine\n");
 
@@ -565,6 +700,32 @@ int main(int argc, char * argv[])
                 printf("\nTime taken to solve(sine DVR)");
                 printf(" : %.3f seconds\n", time_used);
                 break;
+            case 8:
+                SSFFTsplit(EQ, N, dt, S, fname, rate);
+                time_used = (double) (omp_get_wtime() - start);
+                printf("\nTime taken to solve(FFT split real/imag)");
+                printf(" : %.3f seconds\n", time_used);
+                break;
+            case 9:
+                ReadProtocol(infname, EQ, &TDpot, &TDinter);
+                SSFFTtd(EQ, TDpot, &TDinter, N, dt, S, fname, rate);
+                free(TDpot);
+                time_used = (double) (omp_get_wtime() - start);
+                printf("\nTime taken to solve(FFT time dependent)");
+                printf(" : %.3f seconds\n", time_used);
+                break;
+            case 10:
+                SSFFTsingle(EQ, N, dt, S, fname, rate);
+                time_used = (double) (omp_get_wtime() - start);
+                printf("\nTime taken to solve(FFT single precision)");
+                printf(" : %.3f seconds\n", time_used);
+                break;
+            case 11:
+                SSCNsingle(EQ, N, dt, cyclic, S, fname, rate);
+                time_used = (double) (omp_get_wtime() - start);
+                printf("\nTime taken to solve(CN-SM single precision)");
+                printf(" : %.3f seconds\n", time_used);
+                break;
         }
     }
 
@@ -573,34 +734,41 @@ int main(int argc, char * argv[])
     {
         sepline();
         printf("\nDoing imaginary time integration #%d\n\n", 1);
-        switch (method)
+        if (nested > 0)
+        {
+            N = ISSnested(EQ, N, dt, cyclic, S, &E, method, nested);
+            time_used = (double) (omp_get_wtime() - start);
+            printf("\nTime taken to solve(nested grids)");
+            printf(" : %.3f seconds\n", time_used);
+        }
+        else switch (method)
         {
             case 1:
-                N = ISSCNRK4(EQ, N, dt, cyclic, S, E);
+                N = ISSCNRK4(EQ, N, dt, cyclic, S, &E);
                 time_used = (double) (omp_get_wtime() - start);
                 printf("\nTime taken to solve(RK4 nonlinear/CN-SM linear)");
                 printf(" : %.3f seconds\n", time_used);
                 break;
             case 2:
-                N = ISSFFTRK4(EQ, N, dt, S, E);
+                N = ISSFFTRK4(EQ, N, dt, S, &E);
                 time_used = (double) (omp_get_wtime() - start);
                 printf("\nTime taken to solve(RK4 nonlinear/FFT linear)");
                 printf(" : %.3f seconds\n", time_used);
                 break;
             case 3:
-                N = ISSCNSM(EQ, N, dt, cyclic, S, E);
+                N = ISSCNSM(EQ, N, dt, cyclic, S, &E);
                 time_used = (double) (omp_get_wtime() - start);
                 printf("\nTime taken to solve(Crank-Nicolson-SM)");
                 printf(" : %.3f seconds\n", time_used);
                 break;
             case 4:
-                N = ISSCNLU(EQ, N, dt, cyclic, S, E);
+                N = ISSCNLU(EQ, N, dt, cyclic, S, &E);
                 time_used = (double) (omp_get_wtime() - start);
                 printf("\nTime taken to solve(Crank-Nicolson-LU)");
                 printf(" : %.3f seconds\n", time_used);
                 break;
             case 5:
-                N = ISSFFT(EQ, N, dt, S, E);
+                N = ISSFFT(EQ, N, dt, S, &E);
                 time_used = (double) (omp_get_wtime() - start);
                 printf("\nTime taken to solve(FFT)");
                 printf(" : %.3f seconds\n", time_used);
@@ -614,7 +782,7 @@ int main(int argc, char * argv[])
 
         carr_txt(fname, M + 1, S);
 
-        fprintf(E_file, "%.10E\n", creal(E[N-1]));
+        fprintf(E_file, "%.10E\n", E);
     }
 
     SaveConf(job_file, EQ, dt, N);
@@ -630,8 +798,6 @@ int main(int argc, char * argv[])
         
         ReleaseEqDataPkg(EQ);
 
-        free(E);
-
         // number of line reading in _conf.dat and _eq.dat files
         sprintf(strnum, "%d", i + 1);
 
@@ -640,8 +806,6 @@ int main(int argc, char * argv[])
 
         rate = 10;
 
-        E = carrDef(N + 1); // energy to record progress of convergence
-
         if (timeinfo == 'r' || timeinfo == 'R')
         {
 
@@ -670,13 +834,8 @@ int main(int argc, char * argv[])
                 printf("\nUsing the same initial condition");
 
                 orb_file = fopen(fname, "r");
-
-                for (j = 0; j < M + 1; j++)
-                {
-                    trash = fscanf(orb_file, " (%lf%lfj)", &real, &imag);
-                    S[j] = real + I * imag;
-                }
-
+                // FFT integrators (2 and 5) are always periodic
+                ReadInit(orb_file, M, cyclic || method == 2 || method == 5, S);
                 fclose(orb_file);
             }
         }
@@ -736,6 +895,32 @@ int main(int argc, char * argv[])
                     printf("\nTime taken to solve(CFDS)");
                     printf(" : %.3f seconds\n", time_used);
                     break;
+                case 8:
+                    SSFFTsplit(EQ, N, dt, S, fname, rate);
+                    time_used = (double) (omp_get_wtime() - start);
+                    printf("\nTime taken to solve(FFT split real/imag)");
+                    printf(" : %.3f seconds\n", time_used);
+                    break;
+                case 9:
+                    ReadProtocol(infname, EQ, &TDpot, &TDinter);
+                    SSFFTtd(EQ, TDpot, &TDinter, N, dt, S, fname, rate);
+                    free(TDpot);
+                    time_used = (double) (omp_get_wtime() - start);
+                    printf("\nTime taken to solve(FFT time dependent)");
+                    printf(" : %.3f seconds\n", time_used);
+                    break;
+                case 10:
+                    SSFFTsingle(EQ, N, dt, S, fname, rate);
+                    time_used = (double) (omp_get_wtime() - start);
+                    printf("\nTime taken to solve(FFT single precision)");
+                    printf(" : %.3f seconds\n", time_used);
+                    break;
+                case 11:
+                    SSCNsingle(EQ, N, dt, cyclic, S, fname, rate);
+                    time_used = (double) (omp_get_wtime() - start);
+                    printf("\nTime taken to solve(CN-SM single precision)");
+                    printf(" : %.3f seconds\n", time_used);
+                    break;
             }
         }
 
@@ -744,34 +929,41 @@ int main(int argc, char * argv[])
         {
             sepline();
             printf("\nDoing imaginary time integration  #%d\n\n", i + 1);
-            switch (method)
+            if (nested > 0)
+            {
+                N = ISSnested(EQ, N, dt, cyclic, S, &E, method, nested);
+                time_used = (double) (omp_get_wtime() - start);
+                printf("\nTime taken to solve(nested grids)");
+                printf(" : %.3f seconds\n", time_used);
+            }
+            else switch (method)
             {
                 case 1:
-                    N = ISSCNRK4(EQ, N, dt, cyclic, S, E);
+                    N = ISSCNRK4(EQ, N, dt, cyclic, S, &E);
                     time_used = (double) (omp_get_wtime() - start);
                     printf("\nTime taken to solve(RK4 nonlinear/CN linear)");
                     printf(" : %.3f seconds\n", time_used);
                     break;
                 case 2:
-                    N = ISSFFTRK4(EQ, N, dt, S, E);
+                    N = ISSFFTRK4(EQ, N, dt, S, &E);
                     time_used = (double) (omp_get_wtime() - start);
                     printf("\nTime taken to solve(RK4 nonlinear/FFT linear)");
                     printf(" : %.3f seconds\n", time_used);
                     break;
                 case 3:
-                    N = ISSCNSM(EQ, N, dt, cyclic, S, E);
+                    N = ISSCNSM(EQ, N, dt, cyclic, S, &E);
                     time_used = (double) (omp_get_wtime() - start);
                     printf("\nTime taken to solve(Crank-Nicolson-SM)");
                     printf(" : %.3f seconds\n", time_used);
                     break;
                 case 4:
-                    N = ISSCNLU(EQ, N, dt, cyclic, S, E);
+                    N = ISSCNLU(EQ, N, dt, cyclic, S, &E);
                     time_used = (double) (omp_get_wtime() - start);
                     printf("\nTime taken to solve(Crank-Nicolson-LU)");
                     printf(" : %.3f seconds\n", time_used);
                     break;
                 case 5:
-                    N = ISSFFT(EQ, N, dt, S, E);
+                    N = ISSFFT(EQ, N, dt, S, &E);
                     time_used = (double) (omp_get_wtime() - start);
                     printf("\nTime taken to solve(FFT)");
                     printf(" : %.3f seconds\n", time_used);
@@ -786,7 +978,7 @@ int main(int argc, char * argv[])
 
             carr_txt(fname, M + 1, S);
 
-            fprintf(E_file, "%.10E\n", creal(E[N-1]));
+            fprintf(E_file, "%.10E\n", E);
 
         }
 
@@ -805,7 +997,6 @@ int main(int argc, char * argv[])
     if (timeinfo == 'r' || timeinfo == 'R') fclose(orb_file);
     fclose(domain_file);
     free(S);
-    free(E);
     ReleaseEqDataPkg(EQ);
     /* ------------------------------------------------------------------- */
 
@@ -0,0 +1,193 @@
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include "multicomp_integrator.h"
+
+/*
+ * REAL TIME EVOLUTION OF COUPLED MULTI-COMPONENT GROSS-PITAEVSKII
+ * ***************************************************************
+ *
+ * REQUIRED FILES
+ * **************
+ *
+ * input/fileId_domain.dat
+ *
+ *      text file with "xi xf M dt N", the domain, its number of slices,
+ *      the time step and the number of steps
+ *
+ * input/fileId_eq.dat
+ *
+ *      text file with the number of components,  second order derivative
+ *      coefficient, imag part of first order derivative, boundary(boolean,
+ *      used only by CN) and the 3 parameters of the potential, followed
+ *      by the ncomp x ncomp symmetric matrix of interaction strengths
+ *
+ * input/fileId_init.dat
+ *
+ *      the ncomp x (M + 1) complex numbers of the initial condition in
+ *      numpy.savetxt format, the components one after the other
+ *
+ * COMMAND LINE ARGUMENTS
+ * **********************
+ *
+ * fileId potential method [rate]
+ *
+ *      fileId    -> the prefix of required file names
+ *      potential -> name of the potential (see linear_potential.h)
+ *      method    -> 'fft' or 'cn'
+ *      rate      -> (optional) record every rate steps (default 10)
+ *
+ * OUTPUT FILES
+ * ************
+ *
+ * output/fileId_mc_realtime.dat
+ *
+ *      all components in each line, one per rate steps
+ *
+ * **************************************************************************/
+
+int main(int argc, char * argv[])
+{
+
+    /* DEFINE THE NUMBER OF THREADS BASED ON THE COMPUTER */
+    mkl_set_num_threads(omp_get_max_threads() / 2);
+    omp_set_num_threads(omp_get_max_threads() / 2);
+
+    double start, time_used; // show time taken for the evolution
+
+    int i, N, trash; // counters and useless returned values
+
+    int M, ncomp, cyclic, rate;
+
+    double xi, xf, dt, a2, a1imag, p[3], real, imag;
+
+    double g[MAX_COMP * MAX_COMP];
+
+    char fname[100];
+
+    FILE * in_file;
+
+    EqDataPkgMC EQ;
+
+    Carray S;
+
+    if (argc < 4 || argc > 5)
+    {
+        printf("\nInvalid number of command line arguments, ");
+        printf("expected 3 or 4.\n\n");
+        return -1;
+    }
+
+    rate = 10;
+    if (argc == 5) sscanf(argv[4], "%d", &rate);
+
+
+
+    /*                 ************************************                 */
+    /*                 Setup domain and equation parameters                 */
+    /*                 ************************************                 */
+
+
+
+    strcpy(fname, "input/");
+    strcat(fname, argv[1]);
+    strcat(fname, "_domain.dat");
+
+    printf("\nLooking for %s\n", fname);
+
+    in_file = fopen(fname, "r");
+
+    if (in_file == NULL)  // impossible to open file
+    { printf("ERROR: impossible to open file %s\n", fname); return -1; }
+
+    trash = fscanf(in_file, "%lf %lf %d %lf %d", &xi, &xf, &M, &dt, &N);
+
+    fclose(in_file);
+
+    strcpy(fname, "input/");
+    strcat(fname, argv[1]);
+    strcat(fname, "_eq.dat");
+
+    printf("\nLooking for %s\n", fname);
+
+    in_file = fopen(fname, "r");
+
+    if (in_file == NULL)  // impossible to open file
+    { printf("ERROR: impossible to open file %s\n", fname); return -1; }
+
+    trash = fscanf(in_file, "%d %lf %lf %d %lf %lf %lf", &ncomp, &a2,
+                   &a1imag, &cyclic, &p[0], &p[1], &p[2]);
+
+    if (ncomp < 1 || ncomp > MAX_COMP)
+    {
+        printf("\nERROR : number of components must be from 1 to %d\n\n",
+               MAX_COMP);
+        return -1;
+    }
+
+    for (i = 0; i < ncomp * ncomp; i++) trash = fscanf(in_file, "%lf", &g[i]);
+
+    fclose(in_file);
+
+    EQ = PackEqDataMC(ncomp, M + 1, xi, xf, a2, a1imag * I, g, argv[2], p);
+    S = carrDef(ncomp * (M + 1));
+
+
+
+    /*                      *************************                      */
+    /*                      Read the initial condition                     */
+    /*                      *************************                      */
+
+
+
+    strcpy(fname, "input/");
+    strcat(fname, argv[1]);
+    strcat(fname, "_init.dat");
+
+    printf("\nLooking for %s\n", fname);
+
+    in_file = fopen(fname, "r");
+
+    if (in_file == NULL)  // impossible to open file
+    { printf("ERROR: impossible to open file %s\n", fname); return -1; }
+
+    for (i = 0; i < ncomp * (M + 1); i++)
+    {
+        trash = fscanf(in_file, " (%lf%lfj)", &real, &imag);
+        S[i] = real + I * imag;
+    }
+
+    fclose(in_file);
+
+    printf("\nGot Initial condition of %d components\n", ncomp);
+
+
+
+    /*                      *************************                      */
+    /*                      CALL INTEGRATION ROUTINE                       */
+    /*                      *************************                      */
+
+
+
+    start = omp_get_wtime();
+
+    strcpy(fname, "output/");
+    strcat(fname, argv[1]);
+    strcat(fname, "_mc_realtime.dat");
+
+    if (argv[3][0] == 'f') SSFFTmc(EQ, N, dt, S, fname, rate);
+    else                   SSCNmc(EQ, N, dt, cyclic, S, fname, rate);
+
+    time_used = (double) (omp_get_wtime() - start);
+    printf("\nTime taken in %d time steps : %.3f s\n", N, time_used);
+
+    /*** release memory ***/
+
+    free(S);
+    ReleaseEqDataPkgMC(EQ);
+
+    /* END */
+
+    printf("\n");
+    return 0;
+}
@@ -0,0 +1,217 @@
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include "multidim_integrator.h"
+
+/*
+ * TIME EVOLUTION OF GROSS-PITAEVSKII IN 2 OR 3 DIMENSIONS
+ * *******************************************************
+ *
+ * REQUIRED FILES
+ * **************
+ *
+ * input/fileId_domain.dat
+ *
+ *      text file with "dim dt N" in the first line, the  number  of
+ *      dimensions (2 or 3), the time step and the number of steps,
+ *      followed by one line "xi xf M" for each axis (x, y, z) with M
+ *      the number of slices of the axis
+ *
+ * input/fileId_eq.dat
+ *
+ *      text file with the laplacian coefficient, interaction strength
+ *      and the 3 parameters of the potential (see GetPotentialMD)
+ *
+ * input/fileId_init.dat
+ *
+ *      the (M + 1) x (M + 1) (x (M + 1)) complex numbers of the initial
+ *      condition in the numpy.savetxt format of a flattened array  with
+ *      x the fastest index
+ *
+ * COMMAND LINE ARGUMENTS
+ * **********************
+ *
+ * fileId potential method time [rate]
+ *
+ *      fileId    -> the prefix of required file names
+ *      potential -> harmonic, ring or zero
+ *      method    -> 'fft' (periodic) or 'adi' (zero boundary)
+ *      time      -> 'real' or 'imag'
+ *      rate      -> (optional) record every rate steps (default 10)
+ *
+ * OUTPUT FILES
+ * ************
+ *
+ * output/fileId_md_realtime.dat
+ *
+ *      solution over the whole grid in each line, one per rate steps
+ *
+ * output/fileId_md_imagtime.dat
+ *
+ *      final state of imaginary time as column vector
+ *
+ * **************************************************************************/
+
+int main(int argc, char * argv[])
+{
+
+    /* DEFINE THE NUMBER OF THREADS BASED ON THE COMPUTER */
+    mkl_set_num_threads(omp_get_max_threads() / 2);
+    omp_set_num_threads(omp_get_max_threads() / 2);
+
+    double start, time_used; // show time taken for the evolution
+
+    int d, i, N, trash; // counters and useless returned values
+
+    int dim, rate;
+
+    int Mdx[3];         // number of slices in each axis
+
+    double xi[3], xf[3], dt, E;
+
+    double a2, inter, p[3], real, imag;
+
+    char fname[100];
+
+    FILE * in_file;
+
+    EqDataPkgMD EQ;
+
+    Carray S;
+
+    if (argc < 5 || argc > 6)
+    {
+        printf("\nInvalid number of command line arguments, ");
+        printf("expected 4 or 5.\n\n");
+        return -1;
+    }
+
+    rate = 10;
+    if (argc == 6) sscanf(argv[5], "%d", &rate);
+
+
+
+    /*                 ************************************                 */
+    /*                 Setup domain and equation parameters                 */
+    /*                 ************************************                 */
+
+
+
+    strcpy(fname, "input/");
+    strcat(fname, argv[1]);
+    strcat(fname, "_domain.dat");
+
+    printf("\nLooking for %s\n", fname);
+
+    in_file = fopen(fname, "r");
+
+    if (in_file == NULL)  // impossible to open file
+    { printf("ERROR: impossible to open file %s\n", fname); return -1; }
+
+    trash = fscanf(in_file, "%d %lf %d", &dim, &dt, &N);
+
+    if (dim != 2 && dim != 3)
+    {
+        printf("\nERROR : number of dimensions must be 2 or 3\n\n");
+        fclose(in_file);
+        return -1;
+    }
+
+    for (d = 0; d < dim; d++)
+    {
+        trash = fscanf(in_file, "%lf %lf %d", &xi[d], &xf[d], &Mdx[d]);
+        Mdx[d] = Mdx[d] + 1;
+    }
+
+    fclose(in_file);
+
+    strcpy(fname, "input/");
+    strcat(fname, argv[1]);
+    strcat(fname, "_eq.dat");
+
+    printf("\nLooking for %s\n", fname);
+
+    in_file = fopen(fname, "r");
+
+    if (in_file == NULL)  // impossible to open file
+    { printf("ERROR: impossible to open file %s\n", fname); return -1; }
+
+    trash = fscanf(in_file, "%lf %lf %lf %lf %lf", &a2, &inter,
+                   &p[0], &p[1], &p[2]);
+
+    fclose(in_file);
+
+    EQ = PackEqDataMD(dim, Mdx, xi, xf, a2, inter, argv[2], p);
+    S = carrDef(EQ->Mtot);
+
+
+
+    /*                      *************************                      */
+    /*                      Read the initial condition                     */
+    /*                      *************************                      */
+
+
+
+    strcpy(fname, "input/");
+    strcat(fname, argv[1]);
+    strcat(fname, "_init.dat");
+
+    printf("\nLooking for %s\n", fname);
+
+    in_file = fopen(fname, "r");
+
+    if (in_file == NULL)  // impossible to open file
+    { printf("ERROR: impossible to open file %s\n", fname); return -1; }
+
+    for (i = 0; i < EQ->Mtot; i++)
+    {
+        trash = fscanf(in_file, " (%lf%lfj)", &real, &imag);
+        S[i] = real + I * imag;
+    }
+
+    fclose(in_file);
+
+    printf("\nGot Initial condition of %d points in %d dimensions\n",
+           EQ->Mtot, dim);
+
+
+
+    /*                      *************************                      */
+    /*                      CALL INTEGRATION ROUTINE                       */
+    /*                      *************************                      */
+
+
+
+    start = omp_get_wtime();
+
+    strcpy(fname, "output/");
+    strcat(fname, argv[1]);
+
+    if (argv[4][0] == 'r' || argv[4][0] == 'R')
+    {
+        strcat(fname, "_md_realtime.dat");
+        if (argv[3][0] == 'f') SSFFTmd(EQ, N, dt, S, fname, rate);
+        else                   SSADImd(EQ, N, dt, S, fname, rate);
+    }
+    else
+    {
+        strcat(fname, "_md_imagtime.dat");
+        if (argv[3][0] == 'f') N = ISSFFTmd(EQ, N, dt, S, &E);
+        else                   N = ISSADImd(EQ, N, dt, S, &E);
+        carr_txt(fname, EQ->Mtot, S);
+        printf("\nFinal energy per particle : %.10lf\n", E);
+    }
+
+    time_used = (double) (omp_get_wtime() - start);
+    printf("\nTime taken in %d time steps : %.3f s\n", N, time_used);
+
+    /*** release memory ***/
+
+    free(S);
+    ReleaseEqDataPkgMD(EQ);
+
+    /* END */
+
+    printf("\n");
+    return 0;
+}
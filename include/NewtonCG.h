@@ -6,9 +6,9 @@
 #endif
 
 #include <limits.h>
-#include "GP_functional.h"
+#include "functional.h"
 #include "iterative_solver.h"
-#include "rmatrix_operations.h"
+#include "matrix_operations.h"
 
 struct IterNCG{
     int newton;
@@ -17,12 +17,59 @@ struct IterNCG{
     int cg_total;
     int cg_max;
     int cg_min;
+    int backtracks;    // step reductions done by the line search
+    double eta_min;    // smallest forcing term used
+    double eta_max;    // largest  forcing term used
+    double res;        // final modulus of L0f
+    int converged;     // 0 if maxiter was exceeded before reaching tol
 };
 
+/* Inexact Newton parameters. The CG of each Newton step stops when the
+ * linear residue is below eta |L0f|,  with the forcing term eta chosen
+ * as in Eisenstat and Walker, "Choosing the forcing terms in an inexact
+ * Newton method", SIAM J. Sci. Comput. 17 (1996) 16-32 (choice 2):
+ *
+ *      eta = EW_GAMMA (|L0f| / |L0f_old|) ^ EW_ALPHA
+ *
+ * safeguarded and limited to [0.5 tol / |L0f|, EW_ETAMAX]. The steps
+ * are globalized by backtracking until |L0f| decreases enough  */
+
+#define EW_ETA0    0.5   // forcing term of the first Newton step
+#define EW_ETAMAX  0.9
+#define EW_GAMMA   0.9
+#define EW_ALPHA   2.0
+#define LS_SUFDEC  1E-4  // sufficient decrease factor in line search
+#define LS_MAXBACK 20    // maximum number of step halvings
+
 void iteration_info(struct IterNCG It);
 
+/* Linearized GP operator around f0, applied without assembling a matrix.
+ * x and Jx are concatenated (real, imag) arrays of size 2M. The stencil
+ * coefficients are those of the finite differences used by applyL0  */
+
+struct GPJacobian{
+    int M;
+    double offd;    // a2 / dx^2
+    double diag;    // - 2 a2 / dx^2 - mu
+    double ddx;     // Im(a1) / (2 dx)
+    double inter;
+    Rarray V;
+    Carray f0;
+};
+
+double GPJacobianApply(int n, Rarray x, Rarray Jx, void * data);
+
+/* Newton-CG for steady states with chemical potential mu. The inner
+ * linear systems are solved by standard or pipelined preconditioned CG
+ * according to cgtype (CG_STANDARD or CG_PIPELINED). The preconditioner
+ * is chosen by prectype (PREC_TRIDIAG, PREC_BLOCKTRI, PREC_ILU0  or
+ * PREC_SPECTRAL, see iterative_solver.h). Except for the tridiagonal
+ * one they include the potential and interaction terms and are updated
+ * in every Newton step. If tol is not reached in maxiter iterations
+ * return with converged = 0 and f0 the last iterate */
+
 struct IterNCG ncg(int M, double tol, int maxiter, double dx, double a2,
                    double complex a1, double inter, double mu, Rarray V,
-                   Carray f0);
+                   Carray f0, int cgtype, int prectype);
 
 #endif
@@ -3,6 +3,7 @@
 
 #include <complex.h>
 #include <mkl.h>
+#include <mkl_dfti.h>
 
 
 
@@ -30,6 +31,26 @@
  *
  *
  *
+ * Split complex arrays
+ * ====================
+ *
+ * Besides the interleaved double complex arrays, complex
+ * vectors may be stored in two real planes (Structure of
+ * Arrays).  Operations that touch only one part, or that
+ * multiply by real arrays, vectorize better this way.
+ *
+ *
+ *
+ * Single precision complex arrays
+ * ===============================
+ *
+ * Used only to propagate the wave function  in  the
+ * mixed precision integrators,  that  move half of
+ * the bytes in memory bound loops. Every reduction
+ * (norm, energy) is still accumulated in double.
+ *
+ *
+ *
  * The Compressed-Column-Storage(CCS) of a Matrix
  * ==============================================
  *
@@ -83,6 +104,25 @@ typedef double complex ** Cmatrix;
 
 
 
+/******** Complex vector with split real/imag parts *******/
+
+struct SplitC
+{
+    int  n;     // number of complex elements
+    Rarray re;  // real parts
+    Rarray im;  // imaginary parts
+};
+
+typedef struct SplitC * SCarray;
+
+
+
+/************* Single precision complex vector ************/
+
+typedef float complex * CFarray;
+
+
+
 /******* Compressed Column storage of an n x n Matrix *****/
 
 struct CCS
@@ -107,4 +147,132 @@ struct RCCS
 
 typedef struct RCCS * RCCSmat;
 
+
+
+/****** Factorization of an hermitian matrix (LAPACK) ******/
+
+struct HermFactor
+{
+    int  n;        // dimension of the (square) matrix
+    int  posdef;   // 1 for Cholesky (positive definite) 0 for Bunch-Kaufman
+    int * ipiv;    // pivoting indexes from Bunch-Kaufman (unused if posdef)
+    CMKLarray LU;  // factors in row major layout (lower triangular part)
+};
+
+typedef struct HermFactor * HermFactMat;
+
+
+
+/****** Factorization of a real (cyclic) tridiagonal matrix ******/
+
+struct RTriFactor
+{
+    int  n;        // dimension of the system
+    int  cyclic;   // 1 if there are corner (periodic) elements
+    double vlast;  // last element of Sherman-Morrison vector v
+    double denom;  // Sherman-Morrison denominator 1 + v . z
+    Rarray upper;  // upper diagonal
+    Rarray l;      // multipliers of L (lower diagonal over pivot)
+    Rarray uinv;   // inverse of pivots of U
+    Rarray z;      // Sherman-Morrison correction vector (if cyclic)
+};
+
+typedef struct RTriFactor * RTriFactMat;
+
+
+
+/*** Single precision factorization of a complex cyclic tridiagonal ***/
+
+struct CFTriFactor
+{
+    int  n;              // dimension of the system
+    int  cyclic;         // 1 if there are corner (periodic) elements
+    float complex vlast; // last element of Sherman-Morrison vector v
+    float complex denom; // Sherman-Morrison denominator 1 + v . z
+    CFarray upper;       // upper diagonal
+    CFarray l;           // multipliers of L (lower diagonal over pivot)
+    CFarray uinv;        // inverse of pivots of U
+    CFarray z;           // Sherman-Morrison correction vector (if cyclic)
+};
+
+typedef struct CFTriFactor * CFTriFactMat;
+
+
+
+/****** Factorization of a real 2 x 2 block tridiagonal matrix ******/
+
+struct RBlockTriFactor
+{
+    int  n;        // number of 2 x 2 blocks in the diagonal
+    Rarray lower;  // lower diagonal blocks (4 numbers each, row major)
+    Rarray c;      // upper blocks multiplied by the inverse pivots
+    Rarray sinv;   // inverse of the pivot blocks
+};
+
+typedef struct RBlockTriFactor * RBlockTriFactMat;
+
+
+
+/****** Incomplete LU factorization without fill-in - ILU(0) ******/
+
+struct RILU0
+{
+    int  n;        // dimension of the system
+    int  m;        // number of non-zero elements per row
+    int * col;     // column indexes sorted in each row (row major)
+    int * diag;    // position of the diagonal element in each row
+    Rarray vec;    // L (unit diagonal omitted) and U in the positions of A
+};
+
+typedef struct RILU0 * RILUmat;
+
+
+
+/****** Spectral (FFT) inverse of a periodic constant stencil ******/
+
+struct RSpecPrec
+{
+    int  n;        // number of grid points (complex transform size)
+    Rarray sinv;   // inverse of the stencil symbol (includes FFT scale)
+    Carray work;   // transform buffer
+    DFTI_DESCRIPTOR_HANDLE desc;
+};
+
+typedef struct RSpecPrec * RSpecPrecMat;
+
+
+
+/****** Persistent workspace of preconditioned Conjugate-Gradient ******/
+
+struct CCGWorkspace
+{
+    int  n;        // size of the system
+    Carray r;      // residue
+    Carray d;      // direction
+    Carray Ad;     // matrix applied to direction
+    Carray z;      // preconditioner applied to residue
+    Carray l;      // multipliers of tridiagonal preconditioner factors
+    Carray uinv;   // inverse of pivots of tridiagonal preconditioner
+};
+
+typedef struct CCGWorkspace * CCGwork;
+
+struct RCGWorkspace
+{
+    int  n;        // size of the system
+    Rarray r;      // residue
+    Rarray d;      // direction
+    Rarray Ad;     // matrix applied to direction
+    Rarray z;      // preconditioner applied to residue
+    RTriFactMat P; // factorization of tridiagonal preconditioner
+    // Extra vectors of pipelined CG (NULL until RCGpipe is called)
+    Rarray w;      // matrix applied to z
+    Rarray m;      // preconditioner applied to w
+    Rarray Am;     // matrix applied to m
+    Rarray q;      // preconditioner applied to Ad
+    Rarray Aq;     // matrix applied to q
+};
+
+typedef struct RCGWorkspace * RCGwork;
+
 #endif
@@ -13,6 +13,12 @@ Rarray rarrDef(int n);
 Carray carrDef(int n);
 // Allocate complex vector
 
+SCarray scarrDef(int n);
+// Allocate complex vector with split real and imaginary parts
+
+CFarray cfarrDef(int n);
+// Allocate single precision complex vector
+
 CMKLarray CMKLdef(int n);
 // Allocate MKL's complex vector
 
@@ -25,6 +31,31 @@ Cmatrix cmatDef(int m, int n);
 CCSmat ccsmatDef(int n, int max_nonzeros);
 // Allocate CCS matrix structure with n rows
 
+RCCSmat rccsmatDef(int n, int max_nonzeros);
+// Allocate CCS matrix structure with n rows and real entries
+
+HermFactMat hermfactDef(int n, int posdef);
+// Allocate structure to hold factorization of hermitian n x n matrix
+
+RTriFactMat rtrifactDef(int n);
+// Allocate structure to hold factorization of real tridiagonal matrix
+
+CFTriFactMat cftrifactDef(int n);
+// Allocate single precision factorization of complex tridiagonal matrix
+
+RBlockTriFactMat rblocktrifactDef(int n);
+// Allocate factorization of real tridiagonal matrix of n 2 x 2 blocks
+
+RILUmat rilu0Def(int n, int max_nonzeros);
+// Allocate incomplete LU factorization of n x n sparse real matrix
+
+RSpecPrecMat rspecprecDef(int n);
+// Allocate spectral preconditioner and FFT descriptor of n points
+
+CCGwork ccgworkDef(int n);
+RCGwork rcgworkDef(int n);
+// Allocate vectors used by Conjugate-Gradient of systems of size n
+
 
 
 void rmatFree(int m, Rmatrix M);
@@ -39,4 +70,29 @@ void CCSFree(CCSmat M);
 void RCCSFree(RCCSmat M);
 // Relase CCS matrix with real entries
 
+void SCarrFree(SCarray v);
+// Release complex vector with split parts
+
+void HermFactFree(HermFactMat F);
+// Release factorization of hermitian matrix
+
+void RTriFactFree(RTriFactMat F);
+// Release factorization of real tridiagonal matrix
+
+void CFTriFactFree(CFTriFactMat F);
+// Release single precision factorization of complex tridiagonal matrix
+
+void RBlockTriFactFree(RBlockTriFactMat F);
+// Release factorization of real block tridiagonal matrix
+
+void RILU0Free(RILUmat F);
+// Release incomplete LU factorization
+
+void RSpecPrecFree(RSpecPrecMat P);
+// Release spectral preconditioner and its FFT descriptor
+
+void CCGworkFree(CCGwork W);
+void RCGworkFree(RCGwork W);
+// Release Conjugate-Gradient workspace
+
 #endif
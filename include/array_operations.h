@@ -7,6 +7,26 @@
 
 #include <math.h>
 #include "array.h"
+#include "array_simd.h"
+
+
+
+/* The loops are shared among the OpenMP threads only for arrays with at
+ * least OMP_MIN_SIZE elements, value that can be changed in runtime by
+ * ompMinSize. Inside a parallel region the routines run serially,  so
+ * the integrators can open a single region and give each thread its own
+ * chunk of the arrays (see ompChunk)                                 */
+
+#define OMP_MIN_SIZE 10000
+
+// Set the minimum size to use threads
+void ompMinSize(int n);
+
+// 1 if a loop of size n should be shared among threads, 0 otherwise
+int ompWorthy(int n);
+
+// Contiguous chunk of [0, n) of the calling thread in a parallel region
+void ompChunk(int n, int * start, int * len);
 
 
 
@@ -123,8 +143,20 @@ double rarrReduction(int n, Rarray v);
 
 
 
+// Number of elements processed at once by vector math exponentials
+#define EXP_BLOCK 512
+
 // take exponential of each component of z * v.
 void carrExp(int n, double complex z, Carray v, Carray ans);
 void rcarrExp(int n, double complex z, Rarray v, Carray ans);
 
+// Multiply by expV[i] and by the nonlinear phase exp(i h |v[i]|^2)
+void carrPhaseMultiply(int n, double h, Carray expV, Carray v, Carray ans);
+
+// Accuracy of exponentials 'H'(high), 'L'(low) or 'E'(enhanced performance)
+void carrExpAccuracy(char mode);
+
+// VML mode currently set by carrExpAccuracy
+MKL_INT64 carrExpMode();
+
 #endif
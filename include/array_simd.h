@@ -0,0 +1,59 @@
+#ifndef _array_simd_h
+#define _array_simd_h
+
+#include "array.h"
+
+
+
+/* EXPLICIT SIMD KERNELS FOR COMPLEX ARRAYS
+ * *********************************************************
+ *
+ * Description
+ * ===========
+ *
+ * The double complex arithmetic of C99 must handle NaN and
+ * infinity cases in the multiplication, thus the compiler
+ * often gives up vectorization of loops over complex data.
+ * Here the interleaved (real, imag) pairs are treated  as
+ * plain doubles with shuffles to swap/duplicate the parts
+ * and fused multiply-add/sub instructions.
+ *
+ * The routines of array_operations call these kernels if
+ * the processor support the instruction set, detected at
+ * runtime by simdLevel(), otherwise use scalar loops.
+ *
+ * ********************************************************/
+
+
+
+#define SIMD_NONE   0
+#define SIMD_AVX2   1
+#define SIMD_AVX512 2
+
+
+
+int simdLevel();
+// Best instruction set available (detected once and then cached)
+
+void simdForce(int level);
+// Use at most 'level' instruction set. Useful to compare with scalar code
+
+
+
+void carrMultiplyAVX2(int n, Carray v1, Carray v2, Carray v);
+void carrMultiplyAVX512(int n, Carray v1, Carray v2, Carray v);
+
+void carrUpdateAVX2(int n, Carray v1, double complex z, Carray v2, Carray v);
+void carrUpdateAVX512(int n, Carray v1, double complex z, Carray v2, Carray v);
+
+void rcarrUpdateAVX2(int n, Carray v1, double complex z, Rarray v2, Carray v);
+void rcarrUpdateAVX512(int n, Carray v1, double complex z, Rarray v2,
+     Carray v);
+
+void carrAbs2AVX2(int n, Carray v, Rarray vabs);
+void carrAbs2AVX512(int n, Carray v, Rarray vabs);
+
+double complex carrDotAVX2(int n, Carray v1, Carray v2);
+double complex carrDotAVX512(int n, Carray v1, Carray v2);
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef _array_single_h
+#define _array_single_h
+
+#ifdef _OPENMP
+    #include <omp.h>
+#endif
+
+#include <math.h>
+#include "array.h"
+#include "array_operations.h"
+
+
+
+/* OPERATIONS ON SINGLE PRECISION COMPLEX ARRAYS
+ * *********************************************************
+ *
+ * Kernels used by the mixed precision integrators on the
+ * CFarray type (see array.h).  The elements are  stored
+ * and operated in single precision, but the functionals
+ * accumulate in double,  thus  the  norm  of  the  wave
+ * function is not spoiled by the summation of millions
+ * of terms with 7 significant digits. As in array_split
+ * the output may be the same as the last input vector,
+ * except in the tridiagonal product.
+ *
+ * ********************************************************/
+
+
+
+// Convert between double and single precision
+void carr2cf(int n, Carray from, CFarray to);
+void cf2carr(int n, CFarray from, Carray to);
+
+// Element-wise product (v may be v2)
+void cfarrMultiply(int n, CFarray v1, CFarray v2, CFarray v);
+
+// Cyclic tridiagonal matrix times vector, corners as in triCyclicSM
+void cfarrTriMultiply(int n, CFarray upper, CFarray lower, CFarray mid,
+     CFarray v, CFarray ans);
+
+// Vector Modulus squared accumulated in double
+double cfarrMod2(int n, CFarray v);
+
+
+
+/*          ***********************************************
+
+                         SPLIT-STEP KERNELS
+
+            ***********************************************          */
+
+
+
+// Multiply each component of v by exp(z * (V[i] + g |v[i]|^2)). V may
+// be NULL to apply only the nonlinear part
+void cfarrPotentialStep(int n, double complex z, Rarray V, double g,
+     CFarray v);
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef _array_split_h
+#define _array_split_h
+
+#ifdef _OPENMP
+    #include <omp.h>
+#endif
+
+#include <math.h>
+#include "array.h"
+#include "array_operations.h"
+
+
+
+/* OPERATIONS ON COMPLEX ARRAYS WITH SPLIT REAL/IMAG PARTS
+ * *********************************************************
+ *
+ * Counterparts of array_operations for the SCarray type
+ * (see array.h).  Unlike the interleaved routines,  the
+ * output here may be the same as the last input vector,
+ * since each element of the output depends only on the
+ * elements of same index of the inputs.
+ *
+ * ********************************************************/
+
+
+
+// Convert between interleaved and split layouts
+void carr2split(int n, Carray from, SCarray to);
+void split2carr(int n, SCarray from, Carray to);
+
+// Copy elements "from" array "to" array
+void scarrCopy(int n, SCarray from, SCarray to);
+
+// Element-wise product (v may be v2)
+void scarrMultiply(int n, SCarray v1, SCarray v2, SCarray v);
+
+// Element-wise product by a real array (v may be v2)
+void rscarrMultiply(int n, Rarray v1, SCarray v2, SCarray v);
+
+// multiply all elements by a complex scalar (ans may be v)
+void scarrScalarMultiply(int n, SCarray v, double complex z, SCarray ans);
+
+// Update-like operation v[i] = v1[i] + z * v2[i] (v may be v1 or v2)
+void scarrUpdate(int n, SCarray v1, double complex z, SCarray v2, SCarray v);
+
+// Take absolute(complex) squared value for each component
+void scarrAbs2(int n, SCarray v, Rarray vabs);
+
+// Default scalar product. Convention <v1*, v2>
+double complex scarrDot(int n, SCarray v1, SCarray v2);
+
+// Vector Modulus squared
+double scarrMod2(int n, SCarray v);
+
+
+
+/*          ***********************************************
+
+                         SPLIT-STEP KERNELS
+
+            ***********************************************          */
+
+
+
+// Multiply each component of v by exp(z * pot[i])
+void rscarrExpMultiply(int n, double complex z, Rarray pot, SCarray v);
+
+// Multiply each component of v by exp(z * (V[i] + g |v[i]|^2))
+void scarrPotentialStep(int n, double complex z, Rarray V, double g,
+     SCarray v);
+
+#endif
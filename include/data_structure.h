@@ -44,6 +44,77 @@ typedef struct _EquationDataPkg * EqDataPkg;
 
 
 
+/* Equation in 2 or 3 dimensions with isotropic second order derivative.
+ * The grid is stored with x the fastest index,  thus  the  point (i,j,k)
+ * is at (k * Mpos[1] + j) * Mpos[0] + i. For dim = 2 the z axis has  a
+ * single point (Mpos[2] = 1 and dx[2] = 1)                             */
+
+struct _EquationDataPkgMD
+{
+
+    char
+        Vname[80]; // One-Body potential
+
+    int
+        dim,       // number of dimensions (2 or 3)
+        Mtot,      // total number of grid points
+        Mpos[3];   // # of discretized positions in each axis
+
+    double
+        dx[3],     // space step in each axis
+        xi[3],     // initial position discretized value in each axis
+        xf[3],     // final position discretized value in each axis
+        a2,        // factor multiplying the laplacian
+        inter,     // know as g, contact interaction strength
+        * V;       // Array with the values of one-particle potential
+
+    double
+        p[3];      // Parameters to generate one-particle potential values
+
+};
+
+typedef struct _EquationDataPkgMD * EqDataPkgMD;
+
+
+
+/* Coupled equations of ncomp components (binary mixture or spinor) in
+ * 1D.  All components share the grid, the derivatives coefficients and
+ * the trap potential.  The wave functions are stored contiguously, the
+ * component c in S[c * Mpos] up to S[c * Mpos + Mpos - 1],  and g is
+ * the symmetric matrix of intra (diagonal) and inter-species strengths */
+
+#define MAX_COMP 3
+
+struct _EquationDataPkgMC
+{
+
+    char
+        Vname[80]; // One-Body potential
+
+    int
+        ncomp,     // number of components (up to MAX_COMP)
+        Mpos;      // # of discretized positions (# divisions + 1)
+
+    double
+        dx,        // space step
+        xi,        // initial position discretized value
+        xf,        // final position discretized value
+        a2,        // factor multiplying d2 / dx2
+        * V;       // Array with the values of one-particle potential
+
+    double
+        g[MAX_COMP][MAX_COMP], // contact interaction strengths
+        p[3];      // Parameters to generate one-particle potential values
+
+    double complex
+        a1;        // factor multiplying d / dx (pure imaginary)
+
+};
+
+typedef struct _EquationDataPkgMC * EqDataPkgMC;
+
+
+
 /* ======================================================================== *
  *                                                                          *
  *                           FUNCTION PROTOTYPES                            *
@@ -58,6 +129,16 @@ EqDataPkg PackEqData(int,double,double,double,double,doublec,char [],double []);
 
 void ReleaseEqDataPkg (EqDataPkg);
 
+EqDataPkgMD PackEqDataMD(int dim, int Mpos[], double xi[], double xf[],
+            double a2, double inter, char Vname[], double p[]);
+
+void ReleaseEqDataPkgMD (EqDataPkgMD);
+
+EqDataPkgMC PackEqDataMC(int ncomp, int Mpos, double xi, double xf,
+            double a2, doublec a1, double g[], char Vname[], double p[]);
+
+void ReleaseEqDataPkgMC (EqDataPkgMC);
+
 
 
 #endif
@@ -8,6 +8,7 @@
 #include "iterative_solver.h"
 #include "matrix_operations.h"
 #include "observables.h"
+#include "interpolation.h"
 #include "inout.h"
 #include "rk4.h"
 #include "data_structure.h"
@@ -55,7 +56,7 @@
  *
  *  M is the number of discretized points (size of arrays)
  *  N is the number of time-steps to be propagated the initial condition
- *  E end up with the energy on every time-step
+ *  E end up with the energy of the final state
  *
  *  CN methods supports both cyclic and zero boundary condition as
  *  identified by the cyclic(boolean) parameter.
@@ -66,8 +67,50 @@
 
 
 
+/* The convergence is monitored with the energy sampled every convCadence()
+ * time-steps, from which the last CONV_WINDOW samples are kept in a ring
+ * buffer, thus the memory does not depend on the number of steps.  The
+ * evolution stops when the spread of the window and the drift given by a
+ * least squares line fitted to it are both below CONV_TOL relative to the
+ * mean energy of the window                                            */
 
-int ISSCNSM(EqDataPkg, int N, double dT, int cyclic, Carray S, Carray E);
+#define CONV_WINDOW 16
+#define CONV_CADENCE 10
+#define CONV_TOL 1E-11
+
+struct ConvMonitor
+{
+
+    int
+        count,  // number of samples since the last reset
+        next;   // position in the ring buffer of the next sample
+
+    double
+        E[CONV_WINDOW]; // last energies sampled
+
+};
+
+// Set the number of time-steps between two samples of the energy
+void convCadenceSet(int n);
+
+// Number of time-steps between two samples of the energy
+int convCadence();
+
+// Discard all samples
+void convReset(struct ConvMonitor * mon);
+
+// Add a sample of the energy and return 1 if the plateau was reached
+int convUpdate(struct ConvMonitor * mon, double E);
+
+// Print why the evolution stopped and check the virial relative to E
+void convReport(int converged, double E, double vir);
+
+
+
+
+
+
+int ISSCNSM(EqDataPkg, int N, double dT, int cyclic, Carray S, double * E);
 /* ---------------------------------------------------------
  * Crank-Nicolson with Sherman-Morrison to solve linear part
  * --------------------------------------------------------- */
@@ -76,7 +119,7 @@ int ISSCNSM(EqDataPkg, int N, double dT, int cyclic, Carray S, Carray E);
 
 
 
-int ISSCNLU(EqDataPkg, int N, double dT, int cyclic, Carray S, Carray E);
+int ISSCNLU(EqDataPkg, int N, double dT, int cyclic, Carray S, double * E);
 /* ---------------------------------------------------------
  * Crank-Nicolson with LU decomposition to solve linear part
  * --------------------------------------------------------- */
@@ -85,7 +128,7 @@ int ISSCNLU(EqDataPkg, int N, double dT, int cyclic, Carray S, Carray E);
 
 
 
-int ISSFFT(EqDataPkg, int N, double dT, Carray S, Carray E);
+int ISSFFT(EqDataPkg, int N, double dT, Carray S, double * E);
 /* -------------------------------------------------------
  * Use MKL fourier tranform routine to compute derivatives
  * ------------------------------------------------------- */
@@ -112,7 +155,7 @@ void NonLinearVIDDT(int M, double t, Carray Psi, Carray FullPot, Carray Dpsi);
 
 
 
-int ISSCNRK4(EqDataPkg, int N, double dT, int cyclic, Carray S, Carray E);
+int ISSCNRK4(EqDataPkg, int N, double dT, int cyclic, Carray S, double * E);
 /* ---------------------------------------
  * Crank-Nicolson with Sherman-Morrison to
  * solve linear part and RK4 to  nonlinear
@@ -122,10 +165,28 @@ int ISSCNRK4(EqDataPkg, int N, double dT, int cyclic, Carray S, Carray E);
 
 
 
-int ISSFFTRK4(EqDataPkg, int N, double dT, Carray S, Carray E);
+int ISSFFTRK4(EqDataPkg, int N, double dT, Carray S, double * E);
 /* ------------------------------------------------------------
  * Use FFT to solve linear part and RK4 for nonderivatives part
  * ------------------------------------------------------------ */
 
 
+
+
+
+/* Coarsest grid allowed by the nested grids continuation, whose number
+ * of points is reduced by half in each level while it is even        */
+
+#define NESTED_MIN_M 32
+
+int ISSnested(EqDataPkg, int N, double dT, int cyclic, Carray S, double * E,
+              int method, int levels);
+/* ---------------------------------------------------------------------
+ * Converge in up to 'levels' nested coarse grids before the given  one,
+ * prolonging the solution of each grid as starting point of  the  next
+ * finer grid. 'method' identify the integrator as in time_evolution:
+ * (1) ISSCNRK4 (2) ISSFFTRK4 (3) ISSCNSM (4) ISSCNLU (5) ISSFFT
+ * --------------------------------------------------------------------- */
+
+
 #endif
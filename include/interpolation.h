@@ -3,8 +3,35 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <mkl_dfti.h>
+#include "array_operations.h"
+#include "array_memory.h"
+#include "tridiagonal_solver.h"
 
 
+
+/* Interpolate data given in the grid xs (of size n, increasing) at the
+ * points x (of size nx) inside [xs[0], xs[n-1]]. The grid point of each
+ * x is found in O(1) if xs is uniform and by bisection otherwise,  and
+ * the points are shared among OpenMP threads for large nx.
+ *
+ * lagrange use the barycentric formula with 'chunk' grid points  around
+ * each x and precomputed weights, whereas spline is a natural cubic spline
+ * whose second derivatives are computed once for all points         */
+
 void lagrange(int, int, double[], double[], int, double[], double[]);
+void carrLagrange(int n, int chunk, double xs[], Carray ys, int nx,
+     double x[], Carray y);
+
+void spline(int n, double xs[], double ys[], int nx, double x[], double y[]);
+void carrSpline(int n, double xs[], Carray ys, int nx, double x[], Carray y);
+
+// From n grid points to the 2n - 1 points of the grid with half spacing
+void carrProlong(int n, Carray coarse, int cyclic, Carray fine);
+
+// Change the number of grid points of a periodic function (FFT) or of a
+// function that vanishes at the boundaries (sine series) keeping the norm
+void carrResample(int n, Carray from, int m, Carray to);
+void carrResampleSine(int n, Carray from, int m, Carray to);
 
 #endif
@@ -12,6 +12,108 @@
 
 
 
+int CCGsolve(CCGwork W, CCSmat A, Carray b, Carray x, double eps,
+    int maxiter, Carray upper, Carray lower, Carray mid);
+/* Pre-conditioned CG using the vectors of workspace W (see ccgworkDef)
+ * ********************************************************************
+ *
+ * x has the initial guess and ends up with the solution. The tridiagonal
+ * given by upper, lower and mid is used as pre-conditioner. To solve
+ * many systems of the same size, as in Newton methods, allocate W once
+ * and reuse it. Return the number of iterations.
+ *
+ * ********************************************************************/
+
+
+
+/* Real linear operator Ax = A(x) given as function. It must also return
+ * the scalar product <x, Ax>, that CG needs right after the product  and
+ * can be accumulated in the same sweep.  Everything else the  operator
+ * requires (matrix, coefficients, current state) is passed in data    */
+typedef double (* RLinearOp)(int n, Rarray x, Rarray Ax, void * data);
+
+
+
+/* Real preconditioner z = P r given as function, with the factorization
+ * or any other data it needs passed in data (see the functions below) */
+typedef void (* RPrecond)(int n, Rarray r, Rarray z, void * data);
+
+
+
+int RCGprec(RCGwork W, RLinearOp A, void * data, RPrecond P,
+    void * pdata, Rarray b, Rarray x, double eps, int maxiter);
+int RCGpipePrec(RCGwork W, RLinearOp A, void * data, RPrecond P,
+    void * pdata, Rarray b, Rarray x, double eps, int maxiter);
+/* Standard and pipelined CG with the matrix given by the operator A and
+ * the preconditioner given by P. P must be set up before the call   */
+
+
+
+int RCGop(RCGwork W, RLinearOp A, void * data, Rarray b, Rarray x,
+    double eps, int maxiter, Rarray upper, Rarray lower, Rarray mid);
+/* Matrix-free version of RCGsolve where the product with the matrix  is
+ * computed by A(n, x, Ax, data). If mid[0] = 0 the preconditioner is
+ * not factorized and each application calls realtri */
+
+
+
+int RCGsolve(RCGwork W, RCCSmat A, Rarray b, Rarray x, double eps,
+    int maxiter, Rarray upper, Rarray lower, Rarray mid);
+/* Same as CCGsolve for real entries */
+
+
+
+int RCGpipe(RCGwork W, RCCSmat A, Rarray b, Rarray x, double eps,
+    int maxiter, Rarray upper, Rarray lower, Rarray mid);
+/* Pipelined variant of RCGsolve, with a single reduction point in each
+ * iteration that does not depend on the matrix-vector multiplication.
+ * Scales better for large systems on many threads. Use the same W.  */
+
+
+
+/* PRECONDITIONERS
+ * ********************************************************************
+ *
+ * Each apply function is a RPrecond and its data is the structure
+ * given in the comment. Set up before use with the routine indicated.
+ *
+ *      precTri      : RTriFactMat, realtriFactor (tridiagonal_solver)
+ *      precBlockTri : RBlockTriFactMat, rblocktriFactor (2 x 2 blocks
+ *                     coupling the real and imaginary parts)
+ *      precILU0     : RILUmat, rilu0Factor of a RCCS matrix
+ *      precSpectral : RSpecPrecMat, rspecprecSetup of a periodic and
+ *                     constant coefficient stencil, applied with FFT
+ *
+ * ********************************************************************/
+
+void precTri(int n, Rarray r, Rarray z, void * data);
+void precBlockTri(int n, Rarray r, Rarray z, void * data);
+void precILU0(int n, Rarray r, Rarray z, void * data);
+void precSpectral(int n, Rarray r, Rarray z, void * data);
+
+void rilu0Factor(int n, RCCSmat A, RILUmat F);
+void rspecprecSetup(RSpecPrecMat P, double offd, double diag, double ddx);
+
+/* Choice of the preconditioner where it is selectable (see ncg) */
+#define PREC_TRIDIAG  0
+#define PREC_BLOCKTRI 1
+#define PREC_ILU0     2
+#define PREC_SPECTRAL 3
+
+
+
+/* Choice of the CG variant where the solver is selectable (see ncg) */
+#define CG_STANDARD  0
+#define CG_PIPELINED 1
+
+
+
+int RCGpipeOp(RCGwork W, RLinearOp A, void * data, Rarray b, Rarray x,
+    double eps, int maxiter, Rarray upper, Rarray lower, Rarray mid);
+/* Matrix-free version of RCGpipe (see RCGop) */
+
+
+
 int CCG(int n, CCSmat A, Carray b, Carray x, double eps, int maxiter, 
                Carray upper, Carray lower, Carray mid);
 /* As in MpreCCG solve tridiagonal system to apply pre-conditioning */
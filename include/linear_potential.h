@@ -1,4 +1,3 @@
-
 #ifndef _linear_potential_h
 #define _linear_potential_h
 
@@ -12,4 +11,108 @@ void deltabarrier(int , Rarray , Rarray , double);
 
 void GetPotential(int , char [], Rarray , Rarray , double , double , double );
 
+
+
+/* TIME DEPENDENT POTENTIALS AND INTERACTION
+ * ****************************************
+ *
+ * A parameter changes linearly from v1 to v2 in [t1, t2] and is  kept
+ * constant outside, so the integrators know when V or g are static and
+ * reuse their exponentials. The implemented protocols are
+ *
+ *      movingbarrier : barrier of height p[0] and width p[1] (as  the
+ *                      static 'barrier') with center moving from p[2]
+ *      rampharmonic  : harmonic trap with frequency ramped from p[0]
+ *
+ * and the interaction ramp g(t) (Feshbach resonance). The initial value
+ * of the ramped parameter is set by GetPotential from the p[] given.
+ *
+ * Other protocols are given by the user as callbacks. TimePotFunc  set
+ * V at time t from the values V has at the previous call  and  return
+ * the number of points changed starting at *first, that are the  only
+ * exponentials the integrators recompute.  The first call is at t = 0
+ * and must fill all the M points of V. TimeRampFunc  return  g(t).  In
+ * both data is any structure the user needs (e.g. a table), passed in
+ * every call.
+ *
+ * Only the split-step FFT (SSFFTtd) take time dependent V and g,  the
+ * Crank-Nicolson integrators keep them static                       */
+
+typedef int (* TimePotFunc)(int M, Rarray x, double t, Rarray V,
+        int * first, void * data);
+
+typedef double (* TimeRampFunc)(double t, void * data);
+
+struct TimeRamp
+{
+    double
+        t1,     // start of the ramp
+        t2,     // end of the ramp
+        v1,     // value until t1
+        v2;     // value from t2
+
+    TimeRampFunc
+        func;   // user value in time (NULL for the linear ramp)
+
+    void
+        * data; // passed to func
+};
+
+struct TimePotential
+{
+
+    char
+        name[80];           // protocol (any static potential also allowed)
+
+    double
+        p[3],               // parameters as in GetPotential
+        now;                // current value of the ramped parameter
+
+    struct TimeRamp
+        ramp;               // barrier center / trap frequency
+
+    TimePotFunc
+        func;               // user protocol (NULL for the named ones)
+
+    void
+        * data;             // passed to func
+
+};
+
+typedef struct TimePotential * TimePotPkg;
+
+// Value of the ramped parameter at time t
+double rampValue(struct TimeRamp * r, double t);
+
+// Setup a protocol ending with the parameter equal to 'final' at t2
+TimePotPkg TimePotentialDef(char name[], double p[], double t1, double t2,
+           double final);
+
+// Protocol given by the user callback f (name set to 'user')
+TimePotPkg TimePotentialUser(TimePotFunc f, void * data);
+
+// Set V at t = 0 on the whole grid
+void TimePotentialInit(int M, Rarray x, TimePotPkg P, Rarray V);
+
+// Update V to time t. Return the number of points changed from *first
+int TimePotentialUpdate(int M, Rarray x, double t, TimePotPkg P, Rarray V,
+    int * first);
+
+
+
+/* POTENTIALS IN 2 AND 3 DIMENSIONS
+ * ********************************
+ *
+ * V is given on the grid of the multidimensional integrators, with x
+ * the fastest index and z the slowest: V[(k * My + j) * Mx + i]. The
+ * positions of each axis are in x[0], x[1] and x[2] (if dim = 3)
+ *
+ *      harmonic : anisotropic trap with frequencies p[0], p[1], p[2]
+ *      ring     : annular trap p[0]^2 (r - p[1])^2 / 2 with r in  the
+ *                 xy-plane, plus harmonic frequency p[2] along z
+ *      zero     : no potential                                       */
+
+void GetPotentialMD(int dim, int M[], char name[], Rarray x[], Rarray V,
+     double p[]);
+
 #endif
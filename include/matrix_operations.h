@@ -51,6 +51,11 @@ void setValueCCS(int n, int i, int j, int col, double complex z, CCSmat M);
 
 
 
+void setValueRCCS(int n, int i, int j, int col, double x, RCCSmat M);
+/*                  Same as above for real CCS matrix                    */
+
+
+
 CCSmat tri2CCS(int n, Carray upper, Carray lower, Carray mid);
 /* Fill a Sparse Matrix in Compressed Column Storage format from a tridiagonal
  * ***************************************************************************
@@ -126,8 +131,42 @@ void RCCSvec(int n, Rarray vals, int * cols, int m, Rarray vec, Rarray ans);
 
 
 
+int HermitianFactor(int M, Cmatrix A, HermFactMat F);
+/* Factorize an hermitian matrix and keep the factors in F
+ * *******************************************************
+ *
+ *  M is the dimension of A. Only the lower triangular part is used
+ *  F must be allocated with hermfactDef(M, posdef) and may be used
+ *    to store successive factorizations of matrices of same size
+ *  posdef = 1 uses Cholesky (A positive definite) and otherwise the
+ *    Bunch-Kaufman diagonal pivoting method.
+ *
+ *  Return the LAPACK info parameter (zero for success), or -1 as
+ *    for an illegal first argument if M differs from the size of F
+ *
+ * *******************************************************/
+
+
+
+int HermitianSolve(HermFactMat F, Carray b, Carray x);
+/* Solve A . x = b using the factors of A stored in F */
+
+
+
+int HermitianSolveMulti(HermFactMat F, int nrhs, Cmatrix B, Cmatrix X);
+/* Solve A . X = B for nrhs right-hand-sides stored as columns of B
+ * ****************************************************************
+ *
+ *  B and X have M(lines) by nrhs(columns)
+ *
+ * ****************************************************************/
+
+
+
 int HermitianInv(int M, Cmatrix A, Cmatrix A_inv);
-/* Invert an hermitian matrix */
+/* Invert an hermitian matrix. Whenever possible prefer to factorize
+ * with HermitianFactor and apply the inverse by HermitianSolve that
+ * avoid the O(M^3) cost of the explicit inverse. */
 
 
 #endif
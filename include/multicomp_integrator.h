@@ -0,0 +1,87 @@
+#ifndef _multicomp_integrator_h
+#define _multicomp_integrator_h
+
+#include <mkl.h>
+#include <mkl_dfti.h>
+
+#include "tridiagonal_solver.h"
+#include "array_operations.h"
+#include "observables.h"
+#include "inout.h"
+#include "data_structure.h"
+
+
+
+
+
+/*  ======================================================================  *
+ *
+ *       INTEGRATORS FOR COUPLED MULTI-COMPONENT GROSS-PITAEVSKII
+ *
+ *  ======================================================================  */
+
+
+
+
+
+/* =======================================================================
+ *
+ *
+ * i dS_c/dt = ( a2 d^2/dx^2 + a1 d/dx + V + sum_d g_cd |S_d|^2 ) S_c
+ *
+ *
+ * for c = 0, ..., ncomp - 1,  with the components stored contiguously in
+ * S as described in EqDataPkgMC (see data_structure.h),  each one  with
+ * its own boundary point.  The split-step is the same of the 1D methods
+ * and is done on all components together
+ *
+ *  - Potential part : a single parallel region where each thread takes
+ *                     its chunk of the grid, computes |S_d|^2 for  all
+ *                     components and then the coupled exponential  of
+ *                     each one. The coupling costs only additions  of
+ *                     the densities already in cache.
+ *
+ *  - FFT : one MKL descriptor with ncomp transforms at distance  Mpos,
+ *          computed in a single call, and the exponential of the
+ *          derivatives repeated to multiply all components at once.
+ *
+ *  - CN  : all components share the Crank-Nicolson matrix, thus  the
+ *          right hand sides are interleaved and solved by triDiagMulti
+ *          with a single factorization. In the cyclic case the Sherman-
+ *          Morrison correction vector is solved once before the loop.
+ *
+ * ======================================================================= */
+
+
+
+
+
+void ObservablesMC(EqDataPkgMC, Carray S, struct GPObservables * obs,
+     Rarray norms);
+/* ------------------------------------------------------------------
+ * Total kinetic, trap and interaction (intra and inter-species)
+ * energies, virial and norm summed over components, with energy and
+ * chem per particle. norms (if not NULL) has the norm of each one
+ * ------------------------------------------------------------------ */
+
+
+
+
+
+void SSFFTmc(EqDataPkgMC, int N, double dt, Carray S, char fname[], int n);
+/* --------------------------------------------------------------
+ * Split-step with batched FFT. Record all components in a line of
+ * fname on every n steps
+ * -------------------------------------------------------------- */
+
+
+
+
+
+void SSCNmc(EqDataPkgMC, int N, double dt, int cyclic, Carray S,
+     char fname[], int n);
+/* --------------------------------------------------------------
+ * Split-step with Crank-Nicolson for the linear part, as SSCNSM
+ * -------------------------------------------------------------- */
+
+#endif
@@ -0,0 +1,91 @@
+#ifndef _multidim_integrator_h
+#define _multidim_integrator_h
+
+#include <mkl.h>
+#include <mkl_dfti.h>
+
+#include "tridiagonal_solver.h"
+#include "array_operations.h"
+#include "imagtime_integrator.h"
+#include "inout.h"
+#include "data_structure.h"
+
+
+
+
+
+/*  ======================================================================  *
+ *
+ *        INTEGRATORS FOR GROSS-PITAEVSKII IN 2 AND 3 DIMENSIONS
+ *
+ *  ======================================================================  */
+
+
+
+
+
+/* =======================================================================
+ *
+ *
+ * i dS/dt = ( a2 (d^2/dx^2 + d^2/dy^2 + d^2/dz^2) + V + inter |S|^2 ) S
+ *
+ *
+ * The wave function S is given over the whole grid of EqDataPkgMD, with
+ * x the fastest index (see data_structure.h), including the last point
+ * of each axis that is the boundary,  as in the 1D integrators.  Both
+ * methods split the potential part (linear and nonlinear) in two half
+ * steps around the derivatives part
+ *
+ *  - FFT : multidimensional MKL transform done in place  over  the
+ *          interior points with the strides of the grid, thus there
+ *          is no copy to a compact array. Periodic boundary.
+ *
+ *  - ADI : Crank-Nicolson along one axis at a time (Alternating
+ *          Direction). Since V is in the exponential, the operators
+ *          of each axis commute and the splitting keeps the second
+ *          order. The lines of an axis are solved ADI_BATCH at  once
+ *          by triDiagMulti, gathered in a buffer of each thread with
+ *          the lines interleaved. Zero boundary.
+ *
+ * The routines with I prefix propagate in imaginary time,  renormalizing
+ * the wave function and stopping at convergence as the 1D ones.
+ *
+ * ======================================================================= */
+
+
+
+
+
+// Number of lines of an axis solved at once in ADI
+#define ADI_BATCH 32
+
+
+
+void ObservablesMD(EqDataPkgMD, Carray S, struct GPObservables * obs);
+/* ------------------------------------------------------------------
+ * Fill energy, chem, kinetic, trap, inter, virial and norm with  the
+ * rectangle rule over the interior points and forward differences
+ * ------------------------------------------------------------------ */
+
+
+
+
+
+void SSFFTmd(EqDataPkgMD, int N, double dt, Carray S, char fname[], int n);
+void SSADImd(EqDataPkgMD, int N, double dt, Carray S, char fname[], int n);
+/* ---------------------------------------------------------------
+ * Real time evolution recording the whole grid in a line of fname
+ * on every n steps
+ * --------------------------------------------------------------- */
+
+
+
+
+
+int ISSFFTmd(EqDataPkgMD, int N, double dT, Carray S, double * E);
+int ISSADImd(EqDataPkgMD, int N, double dT, Carray S, double * E);
+/* -----------------------------------------------------------
+ * Imaginary time evolution. Return the number of steps done
+ * ----------------------------------------------------------- */
+
+#endif
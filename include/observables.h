@@ -7,6 +7,55 @@
 
 
 
+/* FUSED OBSERVABLES OF GROSS-PITAEVSKII WAVE FUNCTIONS
+ * *********************************************************
+ *
+ * All quantities are integrated by Simpson's rule (see Rsimps) and
+ * the derivative is the fourth order finite difference of dxFD with
+ * periodic boundary f[M-1] = f[0].  Observables computes every one
+ * requested in flags in a single sweep over f,  with the derivative
+ * evaluated on the fly and all integrals in a single reduction.
+ *
+ * The other functions are shortcuts that return a single value.
+ *
+ * ********************************************************/
+
+
+
+#define OBS_ENERGY  1    // energy per particle
+#define OBS_CHEM    2    // chemical potential
+#define OBS_KINETIC 4    // kinetic energy - a2 |f'|^2
+#define OBS_TRAP    8    // potential energy V |f|^2
+#define OBS_INTER   16   // interaction energy g |f|^4 / 2
+#define OBS_VIRIAL  32   // 2 trap - 2 kinetic - interaction
+#define OBS_NORM    64   // integral of |f|^2
+#define OBS_R2      128  // sqrt<x^2> in symmetric domain
+#define OBS_ALL     255
+
+
+
+struct GPObservables
+{
+    double complex energy;
+    double complex chem;
+    double kinetic;
+    double trap;
+    double inter;
+    double virial;
+    double norm;
+    double r2;
+};
+
+
+
+void Observables(int M, double dx, double a2, doublec a1, double g,
+     Rarray V, Carray f, int flags, struct GPObservables * obs);
+/* Fill in obs the quantities selected in flags (OR of the OBS_ values).
+ * V is not accessed if none of energy, chem, trap or virial is asked.
+ * The fields not selected may have partial values. */
+
+
+
 doublec KinectE(int M, double a2, doublec a1, double dx, Carray psi);
 
 
@@ -7,10 +7,13 @@
 #include "tridiagonal_solver.h"
 #include "matrix_operations.h"
 #include "array_operations.h"
+#include "array_split.h"
+#include "array_single.h"
 #include "observables.h"
 #include "inout.h"
 #include "rk4.h"
 #include "data_structure.h"
+#include "linear_potential.h"
 
 
 
@@ -95,6 +98,55 @@ void SSFFT(EqDataPkg, int N, double dt, Carray S, char fname[], int n);
 
 
 
+void SSFFTtd(EqDataPkg, TimePotPkg P, struct TimeRamp * G, int N,
+     double dt, Carray S, char fname[], int n);
+/* -------------------------------------------------------
+ * Same as SSFFT with time dependent potential/interaction
+ * ------------------------------------------------------- */
+
+
+
+
+
+void SSFFTsplit(EqDataPkg, int N, double dt, Carray S, char fname[], int n);
+/* -------------------------------------------------------
+ * Same as SSFFT with real/imag parts in separated arrays
+ * ------------------------------------------------------- */
+
+
+
+
+
+void SSFFTsingle(EqDataPkg, int N, double dt, Carray S, char fname[], int n);
+void SSCNsingle(EqDataPkg, int N, double dt, int cyclic, Carray S,
+     char fname[], int n);
+/* -------------------------------------------------------------------
+ * Same as SSFFT and SSCNSM propagating in single precision. Norm and
+ * energy are computed in double from the solution converted back.
+ *
+ * ERROR BENCHMARK : harmonic trap with inter = 10,  M = 257 in
+ * [-10, 10], displaced gaussian with momentum and dt = 1E-3. The
+ * single precision solution is compared to the double  precision
+ * one of the same method: dS relative L2 distance, dE/E relative
+ * energy and dN absolute norm difference
+ *
+ *                   1E3 steps              1E4 steps
+ *   method    dS     dE/E    dN       dS     dE/E    dN
+ *   FFT      7E-6    2E-6   8E-7     1E-4    8E-6   2E-5
+ *   CN       1E-5    1E-6   2E-6     7E-4    2E-5   8E-5
+ *
+ * The errors grow faster than linearly with the number of steps, the
+ * rounding of each step does not cancel and is carried by the dynamics.
+ * 10 times more steps give dS about 15 times larger  in  FFT  and  60
+ * times in CN, whose matrices are not exactly unitary after rounding.
+ * Do not extrapolate the table to longer runs, use it for scans where
+ * about 4 digits are enough, or check with the double methods.
+ * ------------------------------------------------------------------- */
+
+
+
+
+
 void NonLinearDDT(int M, double t, Carray Psi, Carray inter, Carray Dpsi);
 /* --------------------------------------------------------------------
  * Time-derivative from nonlinear part after split-step (called in RK4)
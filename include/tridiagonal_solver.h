@@ -59,12 +59,33 @@ void triDiag(int n, Carray restrict upper, Carray restrict lower,
  * RHS (Right Hand side) vector of A . x = RHS
  * ans ends up with solution
  *
+ * Large systems (see ompWorthy) are partitioned among the threads and
+ * solved by the SPIKE algorithm when at least 3 threads are available
+ * and the call is not inside a parallel region.  The  same  holds for
+ * realtri. Small systems use the sequential Thomas algorithm.
+ *
  * **************************************************************/
 
 
 
 
 
+void triDiagMulti(int n, int k, Carray upper, Carray lower, Carray mid,
+     Carray RHS, Carray ans);
+/* Solve Tri-diagonal linear system for k right hand sides at once
+ * ***************************************************************
+ *
+ * Same arguments of triDiag, but RHS and ans have size n * k with the
+ * k vectors interleaved: RHS[i * k + j] is the i-th row of the j-th
+ * right hand side.  The matrix is factorized only once  and  the loops
+ * over the k vectors use contiguous memory and vector instructions.
+ *
+ * ***************************************************************/
+
+
+
+
+
 void triCyclicLU(int n, Carray upper, Carray lower, Carray mid,
                  Carray RHS, Carray ans);
 /* Solve Cyclic Tri-diagonal linear system using Modified LU decomposition
@@ -113,4 +134,79 @@ void triCyclicSM(int n, Carray upper, Carray lower, Carray mid,
 void realtri(int n, Rarray upper, Rarray lower, Rarray mid, Rarray RHS,
              Rarray ans);
 
+
+
+
+
+
+void realtriFactor(int n, Rarray upper, Rarray lower, Rarray mid,
+     RTriFactMat F);
+void realtriCyclicFactor(int n, Rarray upper, Rarray lower, Rarray mid,
+     RTriFactMat F);
+void realtriFactSolve(RTriFactMat F, int k, Rarray RHS, Rarray ans);
+/* Factorize once and solve real (cyclic) tridiagonal systems
+ * **********************************************************
+ *
+ * realtriFactor takes the diagonals as realtri, with mid[0] != 0.  In
+ * realtriCyclicFactor the corners are upper[n-1] and lower[n-1] as in
+ * triCyclicSM. F is allocated by rtrifactDef(n).  The solve  takes  k
+ * right hand sides interleaved, as in triDiagMulti, and reuse the same
+ * factorization in every call.
+ *
+ * ********************************************************/
+
+
+
+
+
+RTriFactMat triCyclicImagFactor(int n, Carray upper, Carray lower,
+            Carray mid);
+void triCyclicFactSolve(RTriFactMat F, Carray RHS, Carray ans);
+/* Complex cyclic tridiagonal matrix with pure imaginary coefficients
+ * ******************************************************************
+ *
+ * triCyclicImagFactor returns the factorization of R = A / i  or NULL
+ * if some coefficient has nonzero real part. triCyclicFactSolve solve
+ * R x = RHS for complex RHS, with the real and imaginary parts handled
+ * as two real right hand sides, half of the complex arithmetic work.
+ *
+ * ******************************************************************/
+
+
+
+
+
+
+void cftriCyclicFactor(int n, Carray upper, Carray lower, Carray mid,
+     CFTriFactMat F);
+void cftriFactSolve(CFTriFactMat F, CFarray RHS, CFarray ans);
+/* Complex cyclic tridiagonal systems solved in single precision
+ * *************************************************************
+ *
+ * The diagonals and corners are given in double as  in  triCyclicSM
+ * and factorized in double, then rounded to single precision  in  F
+ * allocated by cftrifactDef(n). The solve moves half of  the  bytes
+ * of the double complex version, used by the mixed precision CN.
+ *
+ * *************************************************************/
+
+
+
+
+
+
+void rblocktriFactor(int n, Rarray upper, Rarray lower, Rarray mid,
+     RBlockTriFactMat F);
+void rblocktriSolve(RBlockTriFactMat F, Rarray RHS, Rarray ans);
+/* Real tridiagonal matrix of 2 x 2 blocks (not cyclic)
+ * ****************************************************
+ *
+ * Each block is stored in 4 consecutive numbers (row major).  mid has
+ * n blocks, upper and lower n - 1 with the same convention of realtri.
+ * F is allocated by rblocktrifactDef(n). The two components of block
+ * j are in RHS[j] and RHS[j + n], as a complex system written in real
+ * form with the real parts first. Fails for singular pivot blocks.
+ *
+ * ****************************************************/
+
 #endif
@@ -9,12 +9,110 @@ void iteration_info(struct IterNCG It)
     printf("\n\t%d Min CG iterations in a Newton loop", It.cg_min);
     printf("\n\t%d CG iterations altogether", It.cg_total);
     printf("\n\tMean of %.1f CG iterations per Newton loop", It.cg_mean);
-    printf("\n\tStd  +- %.1f in CG iterations\n", It.cg_std);
+    printf("\n\tStd  +- %.1f in CG iterations", It.cg_std);
+    printf("\n\t%d step reductions in line search", It.backtracks);
+    printf("\n\tForcing terms between %.2E and %.2E", It.eta_min, It.eta_max);
+    printf("\n\tFinal modulus of L0f %.2E\n", It.res);
+}
+
+double GPJacobianApply(int n, Rarray x, Rarray Jx, void * data)
+{
+    /*** Jx = J . x and return <x, Jx> (RLinearOp for RCGop) ***/
+
+    struct GPJacobian * J = (struct GPJacobian *) data;
+
+    int j, jm, jp, M = J->M;
+
+    double re, im, xr, xi, int_rr, int_ri, int_ii, dot = 0;
+
+    Rarray xre = x, xim = x + M, Jre = Jx, Jim = Jx + M;
+
+    #pragma omp parallel for private(j, jm, jp, re, im, xr, xi, int_rr, \
+            int_ri, int_ii) reduction(+:dot) if (ompWorthy(M))
+    for (j = 0; j < M; j++) {
+        jm = (j == 0) ? M - 1 : j - 1; // periodic boundary
+        jp = (j == M - 1) ? 0 : j + 1;
+
+        re = creal(J->f0[j]);
+        im = cimag(J->f0[j]);
+        int_rr = J->inter * (3 * re * re + im * im);
+        int_ii = J->inter * (re * re + 3 * im * im);
+        int_ri = 2 * J->inter * re * im;
+
+        xr = xre[j];
+        xi = xim[j];
+
+        // Second order derivative, first order coupling real to imaginary
+        // and the diagonal plus interaction terms in each equation
+        Jre[j] = J->offd * (xre[jm] + xre[jp]) + J->ddx * (xim[jm] - xim[jp])
+               + (J->diag + J->V[j] + int_rr) * xr + int_ri * xi;
+        Jim[j] = J->offd * (xim[jm] + xim[jp]) + J->ddx * (xre[jp] - xre[jm])
+               + (J->diag + J->V[j] + int_ii) * xi + int_ri * xr;
+
+        dot += xr * Jre[j] + xi * Jim[j];
+    }
+
+    return dot;
+}
+
+static void jacobianBlocks(struct GPJacobian * J, Rarray mid)
+{
+    /*** 2 x 2 diagonal blocks (real, imag) of Jacobian for precBlockTri ***/
+
+    int j, M = J->M;
+
+    double re, im;
+
+    #pragma omp parallel for private(j, re, im) if (ompWorthy(M))
+    for (j = 0; j < M; j++) {
+        re = creal(J->f0[j]);
+        im = cimag(J->f0[j]);
+        mid[4 * j] = J->diag + J->V[j] + J->inter * (3 * re * re + im * im);
+        mid[4 * j + 1] = 2 * J->inter * re * im;
+        mid[4 * j + 2] = 2 * J->inter * re * im;
+        mid[4 * j + 3] = J->diag + J->V[j] + J->inter * (re * re + 3 * im * im);
+    }
+}
+
+static void jacobianAssemble(struct GPJacobian * J, RCCSmat A)
+{
+    /*** Same operator as GPJacobianApply in RCCS format for rilu0Factor ***/
+
+    int j, jm, jp, M = J->M, N = 2 * J->M;
+
+    double re, im, int_ri;
+
+    for (j = 0; j < M; j++) {
+        jm = (j == 0) ? M - 1 : j - 1; // periodic boundary
+        jp = (j == M - 1) ? 0 : j + 1;
+
+        re = creal(J->f0[j]);
+        im = cimag(J->f0[j]);
+        int_ri = 2 * J->inter * re * im;
+
+        // Real equation
+        setValueRCCS(N, j, 0, jm, J->offd, A);
+        setValueRCCS(N, j, 1, j,
+                     J->diag + J->V[j] + J->inter * (3 * re * re + im * im), A);
+        setValueRCCS(N, j, 2, jp, J->offd, A);
+        setValueRCCS(N, j, 3, jm + M, J->ddx, A);
+        setValueRCCS(N, j, 4, j + M, int_ri, A);
+        setValueRCCS(N, j, 5, jp + M, - J->ddx, A);
+
+        // Imaginary equation
+        setValueRCCS(N, j + M, 0, jm, - J->ddx, A);
+        setValueRCCS(N, j + M, 1, j, int_ri, A);
+        setValueRCCS(N, j + M, 2, jp, J->ddx, A);
+        setValueRCCS(N, j + M, 3, jm + M, J->offd, A);
+        setValueRCCS(N, j + M, 4, j + M,
+                     J->diag + J->V[j] + J->inter * (re * re + 3 * im * im), A);
+        setValueRCCS(N, j + M, 5, jp + M, J->offd, A);
+    }
 }
 
 struct IterNCG ncg(int M, double tol, int maxiter, double dx, double a2,
                    double complex a1, double inter, double mu, Rarray V,
-                   Carray f0)
+                   Carray f0, int cgtype, int prectype)
 {
     /*** Structure to analyse convergence ***/
 
@@ -24,16 +122,26 @@ struct IterNCG ncg(int M, double tol, int maxiter, double dx, double a2,
     iterations.cg_max = 0;
     iterations.cg_min = INT_MAX;
     iterations.cg_std = 0;
+    iterations.backtracks = 0;
+    iterations.eta_min = EW_ETAMAX;
+    iterations.eta_max = 0;
+    iterations.converged = 1;
 
     int * cgiterations = (int * ) malloc(maxiter * sizeof(int));
 
     int j,
+        k,          // Number of step reductions in line search
         ni,         // Number of Newton iterations
         cgi,        // Count number of CG iterations needed in a Newton loop
         N = 2 * M;  // N the size of the concatenated system (real + imag)
 
     double EPS, eps;  // Accepted Error for Newton and CG methods respectively
 
+    double EPS_old,   // Modulus of L0f in previous Newton iteration
+           eta,       // Forcing term (relative tolerance of CG)
+           eta_safe,  // Safeguard to avoid sudden decrease of eta
+           lambda;    // Step length of line search
+
     /***     First order derivative with purely imaginary coeficient     ***/
 
     double ddx = cimag(a1) / (2 * dx);
@@ -43,20 +151,26 @@ struct IterNCG ncg(int M, double tol, int maxiter, double dx, double a2,
     double diag = - 2 * a2 / (dx * dx), // main diagonal values
            offd = a2 / (dx * dx);       // off  diagonal values
 
-    /***              Terms that come from interaction part              ***/
+    /***   Jacobian applied directly from f0 (see GPJacobianApply)   ***/
 
-    double int_rr, // variation of real part of real equation
-           int_ri, //     ''    of imag part of real equation
-           int_ii; //     ''    of imag part of imag equation
+    struct GPJacobian J;
+    J.M = M;
+    J.offd = offd;
+    J.diag = diag - mu;
+    J.ddx = ddx;
+    J.inter = inter;
+    J.V = V;
+    J.f0 = f0;
 
-    RCCSmat A = emptyRCCS(N, 6); // Six non-zero elements per line
+    RCGwork W = rcgworkDef(N); // CG vectors reused in all Newton steps
 
     Carray L0f = carrDef(M);  // Complex Right hand side
     Rarray rhs = rarrDef(N);  // Right hand side of linear system
-    Rarray abs2 = rarrDef(M);
 
     Rarray xcg = rarrDef(N); // Solution of linear system by CG method
 
+    Carray fold = carrDef(M); // Solution before the step in line search
+
     /*** Tri-diagonal system to use as preconditioning ***/
 
     Rarray upper = rarrDef(N - 1);
@@ -69,68 +183,52 @@ struct IterNCG ncg(int M, double tol, int maxiter, double dx, double a2,
     upper[M - 1] = - ddx;
     lower[M - 1] = - ddx;
 
-    /*      ********************************************************      */
-    /*       CONSTANT PART OF THE SYSTEM THAT ARISES FROM REAL PART       */
-    /*      ********************************************************      */
-
-    /*** setup first line ***/
-
-    setValueRCCS(N, 0, 1, 1, offd, A);
-    setValueRCCS(N, 0, 2, M - 1, offd, A);
-    // First order derivative couples real to imaginary system
-    setValueRCCS(N, 0, 4, M + 1, - ddx, A);
-    setValueRCCS(N, 0, 5, N - 1, ddx, A);
-
-    /*** setup last line ***/
-
-    setValueRCCS(N, M - 1, 0, 0, offd, A);
-    setValueRCCS(N, M - 1, 1, M - 2, offd, A);
-    // First order derivative couples real to imaginary
-    setValueRCCS(N, M - 1, 3, M, - ddx, A);
-    setValueRCCS(N, M - 1, 4, N - 2, ddx, A);
-
-    /** Kernel (no cyclic terms) **/
-    for (j = 1; j < M - 1; j++) {
-        setValueRCCS(N, j, 0, j - 1, offd, A);
-        setValueRCCS(N, j, 2, j + 1, offd, A);
-        // First Order derivative
-        setValueRCCS(N, j, 3, j - 1 + M, ddx, A);
-        setValueRCCS(N, j, 5, j + 1 + M, - ddx, A);
-    }
-
-    /*      *********************************************************      */
-    /*     CONSTANT PART OF THE SYSTEM THAT ARISES FROM IMAGINARY PART     */
-    /*      *********************************************************      */
-
-    /*** setup first line ***/
-
-    setValueRCCS(N, M, 4, M + 1, offd, A);
-    setValueRCCS(N, M, 5, N - 1, offd, A);
-    // First order derivative couples real to imaginary
-    setValueRCCS(N, M, 1, 1, ddx, A);
-    setValueRCCS(N, M, 2, M - 1, - ddx, A);
-
-    /*** setup last line ***/
-
-    setValueRCCS(N, N - 1, 3, M, offd, A);
-    setValueRCCS(N, N - 1, 4, N - 2, offd, A);
-    // First order derivative couples real to imaginary
-    setValueRCCS(N, N - 1, 0, 0, ddx, A);
-    setValueRCCS(N, N - 1, 1, M - 2, - ddx, A);
-
-    /** Kernel (no cyclic terms) **/
-    for (j = M + 1; j < N - 1; j++) {
-        setValueRCCS(N, j, 3, j - 1, offd, A);
-        setValueRCCS(N, j, 5, j + 1, offd, A);
-        // First Order derivative
-        setValueRCCS(N, j, 0, j - 1 - M, - ddx, A);
-        setValueRCCS(N, j, 2, j + 1 - M, ddx, A);
+    /*** Preconditioner chosen by prectype ***/
+
+    RPrecond prec = precTri;
+    void * pdata = W->P;
+
+    RBlockTriFactMat B = NULL;  // 2 x 2 block tridiagonal
+    Rarray bup = NULL, blo = NULL, bmid = NULL;
+
+    RCCSmat A = NULL;           // Assembled Jacobian for ILU(0)
+    RILUmat F = NULL;
+
+    RSpecPrecMat S = NULL;      // Spectral (FFT)
+
+    double shift;               // mean diagonal of spectral preconditioner
+
+    switch (prectype) {
+        case PREC_BLOCKTRI:
+            B = rblocktrifactDef(M);
+            bup = rarrDef(4 * (M - 1));
+            blo = rarrDef(4 * (M - 1));
+            bmid = rarrDef(4 * M);
+            for (j = 0; j < M - 1; j++) {
+                bup[4 * j] = offd;  bup[4 * j + 1] = - ddx;
+                bup[4 * j + 2] = ddx;  bup[4 * j + 3] = offd;
+                blo[4 * j] = offd;  blo[4 * j + 1] = ddx;
+                blo[4 * j + 2] = - ddx;  blo[4 * j + 3] = offd;
+            }
+            prec = precBlockTri;
+            pdata = B;
+            break;
+        case PREC_ILU0:
+            A = rccsmatDef(N, 6); // Six non-zero elements per line
+            F = rilu0Def(N, 6);
+            prec = precILU0;
+            pdata = F;
+            break;
+        case PREC_SPECTRAL:
+            S = rspecprecDef(M);
+            prec = precSpectral;
+            pdata = S;
+            break;
+        default:
+            // does not depend on f0, factorized only once
+            realtriFactor(N, upper, lower, mid, W->P);
     }
 
-    /*     *********************************************************     */
-    /*        ITERATION DEPEDENT PART ARISES FROM NON-LINEARITIES        */
-    /*     *********************************************************     */
-
     applyL0(M, f0, dx, a2, a1, V, inter, mu, L0f);
     EPS = carrMod(M, L0f);
     
@@ -138,69 +236,94 @@ struct IterNCG ncg(int M, double tol, int maxiter, double dx, double a2,
 
     printf("\n\t%.2E in Initial Guess\n", EPS);
 
+    eta = EW_ETA0;
+    EPS_old = EPS;
+
     ni = 1; // start Newton iteration counter
     while (EPS > tol)
     {
         if (ni > maxiter) {
             printf("\n\n\tEXCEEDED MAXIMUM NUMBER OF ITERATIONS.\n\n");
-            exit(-1);
+            iterations.converged = 0;
+            break;
         }
 
-        carrAbs2(M, f0, abs2);
         rarrFill(N, 0, xcg); // Aways starts with zero as a guess for CG
 
-        /* Add-up diagonal terms to contribution of second order derivative */
-
-        // First Line
-        int_rr = inter * ( abs2[0] + 2 * creal(f0[0]) * creal(f0[0]) );
-        int_ii = inter * ( abs2[0] + 2 * cimag(f0[0]) * cimag(f0[0]) );
-        setValueRCCS(N, 0, 0, 0, diag + V[0] - mu + int_rr, A);
-        setValueRCCS(N, M, 3, M, diag + V[0] - mu + int_ii, A);
-
-        // Last Line
-        int_rr = inter * ( abs2[M-1] + 2 * creal(f0[M-1]) * creal(f0[M-1]) );
-        int_ii = inter * ( abs2[M-1] + 2 * cimag(f0[M-1]) * cimag(f0[M-1]) );
-        setValueRCCS(N, M - 1, 2, M - 1, diag + V[M-1] - mu + int_rr, A);
-        setValueRCCS(N, N - 1, 5, N - 1, diag + V[M-1] - mu + int_ii, A);
-
-        // Kernel (no cyclic terms)
-        #pragma omp parallel for private(j, int_rr, int_ii, int_ri)
-        for (j = 1; j < M - 1; j++) {
-            int_rr = inter * ( abs2[j] + 2 * creal(f0[j]) * creal(f0[j]) );
-            setValueRCCS(N, j, 1, j, diag + V[j] - mu + int_rr, A);
-            int_ii = inter * ( abs2[j] + 2 * cimag(f0[j]) * cimag(f0[j]) );
-            setValueRCCS(N, j + M, 4, j + M, diag + V[j] - mu + int_ii, A);
-            int_ri = 2 * inter * cimag(f0[j]) * creal(f0[j]);
-            setValueRCCS(N, j, 4, j + M, int_ri, A); // Coupling real to imag
-            setValueRCCS(N, j + M, 1, j, int_ri, A); // Coupling imag to real
+        for (j = 0; j < M; j++) {
+            rhs[j] = - creal(L0f[j]);
+            rhs[j + M] = - cimag(L0f[j]);
         }
 
-        int_ri = 2 * inter * cimag(f0[0]) * creal(f0[0]);
-        setValueRCCS(N, 0, 3, M, int_ri, A); // Coupling real to imag
-        setValueRCCS(N, M, 0, 0, int_ri, A); // Coupling imag to real
+        /*** Update preconditioner with the current f0 ***/
 
-        int_ri = 2 * inter * cimag(f0[M - 1]) * creal(f0[M - 1]);
-        setValueRCCS(N, M - 1, 5, N - 1, int_ri, A); // Coupling real to imag
-        setValueRCCS(N, N - 1, 2, M - 1, int_ri, A); // Coupling imag to real
+        if (prectype == PREC_BLOCKTRI) {
+            jacobianBlocks(&J, bmid);
+            rblocktriFactor(M, bup, blo, bmid, B);
+        }
+        else if (prectype == PREC_ILU0) {
+            jacobianAssemble(&J, A);
+            rilu0Factor(N, A, F);
+        }
+        else if (prectype == PREC_SPECTRAL) {
+            shift = 0;
+            for (j = 0; j < M; j++)
+                shift += V[j] + 2 * inter * cabs(f0[j]) * cabs(f0[j]);
+            rspecprecSetup(S, offd, diag - mu + shift / M, ddx);
+        }
 
-        /*** End of matrix entries ***/
+        /*** Forcing term of Eisenstat-Walker ***/
 
-        for (j = 0; j < M; j++) {
-            rhs[j] = - creal(L0f[j]);
-            rhs[j + M] = - cimag(L0f[j]);
+        if (ni > 1) {
+            eta_safe = EW_GAMMA * pow(eta, EW_ALPHA);
+            eta = EW_GAMMA * pow(EPS / EPS_old, EW_ALPHA);
+            if (eta_safe > 0.1 && eta_safe > eta) eta = eta_safe;
+            if (eta > EW_ETAMAX) eta = EW_ETAMAX;
+            // Do not over-solve when close to the Newton tolerance
+            if (eta < 0.5 * tol / EPS) eta = 0.5 * tol / EPS;
         }
 
-        eps = 0.005 * EPS;
-        cgi = RCG(N, A, rhs, xcg, eps, upper, lower, mid);
+        if (eta < iterations.eta_min) iterations.eta_min = eta;
+        if (eta > iterations.eta_max) iterations.eta_max = eta;
+
+        eps = eta * EPS;
+        if (cgtype == CG_PIPELINED)
+            cgi = RCGpipePrec(W, GPJacobianApply, &J, prec, pdata,
+                              rhs, xcg, eps, N);
+        else
+            cgi = RCGprec(W, GPJacobianApply, &J, prec, pdata,
+                          rhs, xcg, eps, N);
         cgiterations[ni - 1] = cgi;
 
-        /*** update Solution ***/
+        /*** update Solution with backtracking line search ***/
 
-        for (j = 0; j < M; j++) f0[j] += xcg[j] + I * xcg[j + M];
+        carrCopy(M, f0, fold);
+        EPS_old = EPS;
+        lambda = 1;
+
+        for (j = 0; j < M; j++) f0[j] = fold[j] + xcg[j] + I * xcg[j + M];
 
         applyL0(M, f0, dx, a2, a1, V, inter, mu, L0f);
         EPS = carrMod(M, L0f);
 
+        k = 0;
+        while (EPS > (1 - LS_SUFDEC * (1 - eta)) * EPS_old) {
+            if (k == LS_MAXBACK) {
+                printf("\n\tWARNING : line search failed to decrease L0f\n");
+                break;
+            }
+            lambda = 0.5 * lambda;
+            // Forcing term consistent with the shorter step
+            eta = 1 - 0.5 * (1 - eta);
+            for (j = 0; j < M; j++)
+                f0[j] = fold[j] + lambda * (xcg[j] + I * xcg[j + M]);
+            applyL0(M, f0, dx, a2, a1, V, inter, mu, L0f);
+            EPS = carrMod(M, L0f);
+            k += 1;
+        }
+
+        iterations.backtracks += k;
+
         printf("\n\t%.2E in Newton iteration #%d", EPS, ni);
         printf("\n\t%d CG iterations\n", cgi);
 
@@ -219,11 +342,16 @@ struct IterNCG ncg(int M, double tol, int maxiter, double dx, double a2,
     iterations.cg_std = sqrt(iterations.cg_std / (ni - 1));
 
     iterations.newton = ni;
+    iterations.res = EPS;
 
     /*** Release used memory ***/
 
-    free(abs2); RCCSFree(A); free(upper); free(lower); free(mid); free(xcg);
-    free(rhs); free(L0f); free(cgiterations);
+    free(upper); free(lower); free(mid); free(xcg);
+    free(rhs); free(L0f); free(fold); free(cgiterations); RCGworkFree(W);
+
+    if (B != NULL) { RBlockTriFactFree(B); free(bup); free(blo); free(bmid); }
+    if (A != NULL) { RCCSFree(A); RILU0Free(F); }
+    if (S != NULL) RSpecPrecFree(S);
 
     return iterations;
 }
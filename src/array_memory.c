@@ -48,6 +48,50 @@ Carray carrDef(int n)
 
 
 
+SCarray scarrDef(int n)
+{
+
+/** Complex vector of n elements with real and imaginary parts
+  * in separated (contiguous) real arrays **/
+
+    SCarray v = (struct SplitC *) malloc(sizeof(struct SplitC));
+
+    if (v == NULL)
+    {
+        printf("\n\n\n\tMEMORY ERROR : malloc fail for split complex\n\n");
+        exit(EXIT_FAILURE);
+    }
+
+    v->n = n;
+    v->re = rarrDef(n);
+    v->im = rarrDef(n);
+
+    return v;
+}
+
+
+
+
+
+CFarray cfarrDef(int n)
+{
+    float complex * ptr;
+
+    ptr = (float complex * ) malloc( n * sizeof(float complex) );
+
+    if (ptr == NULL)
+    {
+        printf("\n\n\n\tMEMORY ERROR : malloc fail for float complex\n\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return ptr;
+}
+
+
+
+
+
 CMKLarray CMKLdef(int n)
 {
     MKL_Complex16 * ptr;
@@ -149,6 +193,286 @@ CCSmat ccsmatDef(int n, int max_nonzeros)
 
 
 
+RCCSmat rccsmatDef(int n, int max_nonzeros)
+{
+
+/** Return empty CCS representation of real matrix of n rows **/
+
+    RCCSmat M = (struct RCCS *) malloc(sizeof(struct RCCS));
+
+    if (M == NULL)
+    {
+        printf("\n\n\n\tMEMORY ERROR : malloc fail for CCS structure\n\n");
+        exit(EXIT_FAILURE);
+    }
+
+    M->m = max_nonzeros;
+    M->vec = rarrDef(max_nonzeros * n);
+    M->col = (int *) malloc( max_nonzeros * n * sizeof(int) );
+
+    if (M->col == NULL)
+    {
+        printf("\n\n\n\tMEMORY ERROR : malloc fail for integers\n\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return M;
+}
+
+
+
+
+
+HermFactMat hermfactDef(int n, int posdef)
+{
+
+/** Return empty structure to store the factorization of an hermitian
+  * matrix of dimension n. If posdef the Cholesky factorization  will
+  * be stored and no pivoting indexes are required **/
+
+    HermFactMat F = (struct HermFactor *) malloc(sizeof(struct HermFactor));
+
+    if (F == NULL)
+    {
+        printf("\n\n\n\tMEMORY ERROR : malloc fail for factor structure\n\n");
+        exit(EXIT_FAILURE);
+    }
+
+    F->n = n;
+    F->posdef = posdef;
+    F->LU = CMKLdef(n * n);
+    F->ipiv = NULL;
+
+    if (posdef) return F;
+
+    F->ipiv = (int *) malloc( n * sizeof(int) );
+
+    if (F->ipiv == NULL)
+    {
+        printf("\n\n\n\tMEMORY ERROR : malloc fail for integers\n\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return F;
+}
+
+
+
+
+
+RTriFactMat rtrifactDef(int n)
+{
+
+/** Return empty structure to store the factorization of a real cyclic
+  * tridiagonal matrix of dimension n (see realtriCyclicFactor) **/
+
+    RTriFactMat F = (struct RTriFactor *) malloc(sizeof(struct RTriFactor));
+
+    if (F == NULL)
+    {
+        printf("\n\n\n\tMEMORY ERROR : malloc fail for factor structure\n\n");
+        exit(EXIT_FAILURE);
+    }
+
+    F->n = n;
+    F->cyclic = 0;
+    F->vlast = 0;
+    F->denom = 1;
+    F->upper = rarrDef(n);
+    F->l = rarrDef(n);
+    F->uinv = rarrDef(n);
+    F->z = rarrDef(n);
+
+    return F;
+}
+
+
+
+
+
+CFTriFactMat cftrifactDef(int n)
+{
+
+/** Return empty structure to store the single precision factorization
+  * of a complex cyclic tridiagonal matrix (see cftriCyclicFactor) **/
+
+    CFTriFactMat F = (struct CFTriFactor *) malloc(sizeof(struct CFTriFactor));
+
+    if (F == NULL)
+    {
+        printf("\n\n\n\tMEMORY ERROR : malloc fail for factor structure\n\n");
+        exit(EXIT_FAILURE);
+    }
+
+    F->n = n;
+    F->cyclic = 0;
+    F->vlast = 0;
+    F->denom = 1;
+    F->upper = cfarrDef(n);
+    F->l = cfarrDef(n);
+    F->uinv = cfarrDef(n);
+    F->z = cfarrDef(n);
+
+    return F;
+}
+
+
+
+
+
+RBlockTriFactMat rblocktrifactDef(int n)
+{
+
+/** Return empty structure to store the factorization of a real block
+  * tridiagonal matrix with n 2 x 2 blocks (see rblocktriFactor) **/
+
+    RBlockTriFactMat F;
+
+    F = (struct RBlockTriFactor *) malloc(sizeof(struct RBlockTriFactor));
+
+    if (F == NULL)
+    {
+        printf("\n\n\n\tMEMORY ERROR : malloc fail for factor structure\n\n");
+        exit(EXIT_FAILURE);
+    }
+
+    F->n = n;
+    F->lower = rarrDef(4 * n);
+    F->c = rarrDef(4 * n);
+    F->sinv = rarrDef(4 * n);
+
+    return F;
+}
+
+
+
+
+
+RILUmat rilu0Def(int n, int max_nonzeros)
+{
+
+/** Return empty structure to store the ILU(0) factorization of a sparse
+  * real matrix of n rows in CCS format (see rilu0Factor) **/
+
+    RILUmat F = (struct RILU0 *) malloc(sizeof(struct RILU0));
+
+    if (F == NULL)
+    {
+        printf("\n\n\n\tMEMORY ERROR : malloc fail for factor structure\n\n");
+        exit(EXIT_FAILURE);
+    }
+
+    F->n = n;
+    F->m = max_nonzeros;
+    F->vec = rarrDef(max_nonzeros * n);
+    F->col = (int *) malloc( max_nonzeros * n * sizeof(int) );
+    F->diag = (int *) malloc( n * sizeof(int) );
+
+    if (F->col == NULL || F->diag == NULL)
+    {
+        printf("\n\n\n\tMEMORY ERROR : malloc fail for integers\n\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return F;
+}
+
+
+
+
+
+RSpecPrecMat rspecprecDef(int n)
+{
+
+/** Return spectral preconditioner of n grid points with the FFT already
+  * committed. The symbol is set by rspecprecSetup **/
+
+    MKL_LONG
+        s;
+
+    RSpecPrecMat P = (struct RSpecPrec *) malloc(sizeof(struct RSpecPrec));
+
+    if (P == NULL)
+    {
+        printf("\n\n\n\tMEMORY ERROR : malloc fail for preconditioner\n\n");
+        exit(EXIT_FAILURE);
+    }
+
+    P->n = n;
+    P->sinv = rarrDef(n);
+    P->work = carrDef(n);
+
+    s = DftiCreateDescriptor(&P->desc, DFTI_DOUBLE, DFTI_COMPLEX, 1, n);
+    s = DftiCommitDescriptor(P->desc);
+
+    return P;
+}
+
+
+
+
+
+CCGwork ccgworkDef(int n)
+{
+
+/** Return the vectors used in each iteration of Conjugate-Gradient, to
+  * be reused in several calls to solve systems of size n **/
+
+    CCGwork W = (struct CCGWorkspace *) malloc(sizeof(struct CCGWorkspace));
+
+    if (W == NULL)
+    {
+        printf("\n\n\n\tMEMORY ERROR : malloc fail for CG workspace\n\n");
+        exit(EXIT_FAILURE);
+    }
+
+    W->n = n;
+    W->r = carrDef(n);
+    W->d = carrDef(n);
+    W->Ad = carrDef(n);
+    W->z = carrDef(n);
+    W->l = carrDef(n);
+    W->uinv = carrDef(n);
+
+    return W;
+}
+
+
+
+
+
+RCGwork rcgworkDef(int n)
+{
+
+/** Real version of ccgworkDef **/
+
+    RCGwork W = (struct RCGWorkspace *) malloc(sizeof(struct RCGWorkspace));
+
+    if (W == NULL)
+    {
+        printf("\n\n\n\tMEMORY ERROR : malloc fail for CG workspace\n\n");
+        exit(EXIT_FAILURE);
+    }
+
+    W->n = n;
+    W->r = rarrDef(n);
+    W->d = rarrDef(n);
+    W->Ad = rarrDef(n);
+    W->z = rarrDef(n);
+    W->P = rtrifactDef(n);
+    W->w = NULL;
+    W->m = NULL;
+    W->Am = NULL;
+    W->q = NULL;
+    W->Aq = NULL;
+
+    return W;
+}
+
+
+
+
+
 /* ========================================================================
  
                                MEMORY RELEASE
@@ -214,3 +538,151 @@ void RCCSFree(RCCSmat M)
     free(M->vec);
     free(M);
 }
+
+
+
+
+
+void SCarrFree(SCarray v)
+{
+
+/** Release complex vector with split parts **/
+
+    free(v->re);
+    free(v->im);
+    free(v);
+}
+
+
+
+
+
+void HermFactFree(HermFactMat F)
+{
+
+/** Release factorization of hermitian matrix **/
+
+    free(F->ipiv);
+    free(F->LU);
+    free(F);
+}
+
+
+
+
+
+void RTriFactFree(RTriFactMat F)
+{
+
+/** Release factorization of real tridiagonal matrix **/
+
+    free(F->upper);
+    free(F->l);
+    free(F->uinv);
+    free(F->z);
+    free(F);
+}
+
+
+
+
+
+void CFTriFactFree(CFTriFactMat F)
+{
+
+/** Release single precision factorization of complex tridiagonal **/
+
+    free(F->upper);
+    free(F->l);
+    free(F->uinv);
+    free(F->z);
+    free(F);
+}
+
+
+
+
+
+void RBlockTriFactFree(RBlockTriFactMat F)
+{
+
+/** Release factorization of real block tridiagonal matrix **/
+
+    free(F->lower);
+    free(F->c);
+    free(F->sinv);
+    free(F);
+}
+
+
+
+
+
+void RILU0Free(RILUmat F)
+{
+
+/** Release incomplete LU factorization **/
+
+    free(F->vec);
+    free(F->col);
+    free(F->diag);
+    free(F);
+}
+
+
+
+
+
+void RSpecPrecFree(RSpecPrecMat P)
+{
+
+/** Release spectral preconditioner **/
+
+    MKL_LONG
+        s;
+
+    s = DftiFreeDescriptor(&P->desc);
+    free(P->sinv);
+    free(P->work);
+    free(P);
+}
+
+
+
+
+
+void CCGworkFree(CCGwork W)
+{
+
+/** Release Conjugate-Gradient workspace **/
+
+    free(W->r);
+    free(W->d);
+    free(W->Ad);
+    free(W->z);
+    free(W->l);
+    free(W->uinv);
+    free(W);
+}
+
+
+
+
+
+void RCGworkFree(RCGwork W)
+{
+
+/** Release Conjugate-Gradient workspace **/
+
+    free(W->r);
+    free(W->d);
+    free(W->Ad);
+    free(W->z);
+    RTriFactFree(W->P);
+    free(W->w);
+    free(W->m);
+    free(W->Am);
+    free(W->q);
+    free(W->Aq);
+    free(W);
+}
@@ -2,6 +2,93 @@
 
 
 
+// accuracy mode of vector math library (see carrExpAccuracy)
+static MKL_INT64 vml_mode = VML_HA;
+
+// minimum number of elements to open a parallel region (see ompMinSize)
+static int omp_min_size = OMP_MIN_SIZE;
+
+
+
+           /***********************************************
+
+                     THREADING OF ELEMENT-WISE LOOPS
+
+            ***********************************************/
+
+
+
+void ompMinSize(int n)
+{
+
+/** Set the minimum size of the arrays to use OpenMP threads. Below it the
+  * cost to fork/join the threads is larger than the work in the loops **/
+
+    if (n < 1) n = 1;
+    omp_min_size = n;
+}
+
+
+
+int ompWorthy(int n)
+{
+
+/** Decide if a loop of size n must be shared among the threads. Return 0
+  * if already inside a parallel region,  where each thread  call  the
+  * routines on its own chunk of the arrays and the nested regions  are
+  * just overhead (see ompChunk).  The level also counts inactive regions
+  * (a team of one thread by thread limit or dynamic adjustment), where
+  * omp_in_parallel is false **/
+
+#ifdef _OPENMP
+    if (n < omp_min_size) return 0;
+    if (omp_get_level() > 0) return 0;
+    return omp_get_max_threads() > 1;
+#else
+    return 0;
+#endif
+}
+
+
+
+void ompChunk(int n, int * start, int * len)
+{
+
+/** Contiguous chunk of [0, n) of the calling thread in a parallel region.
+  * Out of a parallel region the chunk is the whole range. **/
+
+    int
+        id,
+        nthreads,
+        q,
+        r;
+
+#ifdef _OPENMP
+    id = omp_get_thread_num();
+    nthreads = omp_get_num_threads();
+#else
+    id = 0;
+    nthreads = 1;
+#endif
+
+    q = n / nthreads;
+    r = n % nthreads;
+
+    // first r threads take one extra element
+    if (id < r)
+    {
+        *len = q + 1;
+        *start = id * (q + 1);
+    }
+    else
+    {
+        *len = q;
+        *start = r * (q + 1) + (id - r) * q;
+    }
+}
+
+
+
            /***********************************************
 
                    SETUP VALUES IN VECTOR COMPONENTS
@@ -13,6 +100,8 @@
 void carrFill(int n, double complex z, Carray v)
 {
     int i;
+
+    #pragma omp parallel for private(i) if (ompWorthy(n))
     for (i = 0; i < n; i++) v[i] = z;
 }
 
@@ -21,6 +110,8 @@ void carrFill(int n, double complex z, Carray v)
 void rarrFill(int n, double x, Rarray v)
 {
     int i;
+
+    #pragma omp parallel for private(i) if (ompWorthy(n))
     for (i = 0; i < n; i++) v[i] = x;
 }
 
@@ -45,6 +136,7 @@ void carrCopy(int n, Carray from, Carray to)
 {
     int i;
 
+    #pragma omp parallel for private(i) if (ompWorthy(n))
     for (i = 0; i < n; i++) to[i] = from[i];
 }
 
@@ -54,6 +146,7 @@ void rarrCopy(int n, Rarray from, Rarray to)
 {
     int i;
 
+    #pragma omp parallel for private(i) if (ompWorthy(n))
     for (i = 0; i < n; i++) to[i] = from[i];
 }
 
@@ -66,6 +159,7 @@ void MKL2Carray(int n, CMKLarray a, Carray b)
 
     int i;
 
+    #pragma omp parallel for private(i) if (ompWorthy(n))
     for (i = 0; i < n; i++) b[i] = a[i].real + I * a[i].imag;
 }
 
@@ -78,6 +172,7 @@ void Carray2MKL(int n, Carray b, CMKLarray a)
 
     int i;
 
+    #pragma omp parallel for private(i) if (ompWorthy(n))
     for (i = 0; i < n; i++)
     {
         a[i].real = creal(b[i]);
@@ -99,6 +194,7 @@ void carrRealPart(int n, Carray v, Rarray vreal)
 {
     int i;
     
+    #pragma omp parallel for private(i) if (ompWorthy(n))
     for (i = 0; i < n; i++) vreal[i] = creal(v[i]);
 }
 
@@ -108,6 +204,7 @@ void carrImagPart(int n, Carray v, Rarray vimag)
 {
     int i;
 
+    #pragma omp parallel for private(i) if (ompWorthy(n))
     for (i = 0; i < n; i++) vimag[i] = cimag(v[i]);
 }
 
@@ -117,6 +214,7 @@ void carrConj(int n, Carray v, Carray v_conj)
 {
     int i;
 
+    #pragma omp parallel for private(i) if (ompWorthy(n))
     for (i = 0; i < n; i++) v_conj[i] = conj(v[i]);
 }
 
@@ -126,6 +224,7 @@ void carrAdd(int n, Carray v1, Carray v2, Carray v)
 {
     int i;
 
+    #pragma omp parallel for private(i) if (ompWorthy(n))
     for (i = 0; i < n; i++) v[i] = v1[i] + v2[i];
 }
 
@@ -135,6 +234,7 @@ void rarrAdd(int n, Rarray v1, Rarray v2, Rarray v)
 {
     int i;
 
+    #pragma omp parallel for private(i) if (ompWorthy(n))
     for (i = 0; i < n; i++) v[i] = v1[i] + v2[i];
 }
 
@@ -144,6 +244,7 @@ void carrSub(int n, Carray v1, Carray v2, Carray v)
 {
     int i;
 
+    #pragma omp parallel for private(i) if (ompWorthy(n))
     for (i = 0; i < n; i++) v[i] = v1[i] - v2[i];
 }
 
@@ -153,24 +254,58 @@ void rarrSub(int n, Rarray v1, Rarray v2, Rarray v)
 {
     int i;
 
+    #pragma omp parallel for private(i) if (ompWorthy(n))
     for (i = 0; i < n; i++) v[i] = v1[i] - v2[i];
 }
 
 
 
-void carrMultiply(int n, Carray v1, Carray v2, Carray v)
+static void carrMultiplySerial(int n, Carray v1, Carray v2, Carray v)
 {
     int i;
 
+    switch (simdLevel())
+    {
+        case SIMD_AVX512:
+            carrMultiplyAVX512(n, v1, v2, v);
+            return;
+        case SIMD_AVX2:
+            carrMultiplyAVX2(n, v1, v2, v);
+            return;
+    }
+
     for (i = 0; i < n; i++) v[i] = v1[i] * v2[i];
 }
 
 
 
+void carrMultiply(int n, Carray v1, Carray v2, Carray v)
+{
+    int
+        start,
+        len;
+
+    if (ompWorthy(n))
+    {
+        // Each thread call the serial SIMD kernel on its own chunk
+        #pragma omp parallel private(start, len)
+        {
+            ompChunk(n, &start, &len);
+            carrMultiplySerial(len, v1 + start, v2 + start, v + start);
+        }
+        return;
+    }
+
+    carrMultiplySerial(n, v1, v2, v);
+}
+
+
+
 void rarrMultiply(int n, Rarray v1, Rarray v2, Rarray v)
 {
     int i;
 
+    #pragma omp parallel for private(i) if (ompWorthy(n))
     for (i = 0; i < n; i++) v[i] = v1[i] * v2[i];
 }
 
@@ -180,6 +315,7 @@ void carrScalarMultiply(int n, Carray v, double complex z, Carray ans)
 {
     int i;
 
+    #pragma omp parallel for private(i) if (ompWorthy(n))
     for (i = 0; i < n; i++) ans[i] = v[i] * z;
 }
 
@@ -189,6 +325,7 @@ void rarrScalarMultiply(int n, Rarray v, double z, Rarray ans)
 {
     int i;
 
+    #pragma omp parallel for private(i) if (ompWorthy(n))
     for (i = 0; i < n; i++) ans[i] = v[i] * z;
 }
 
@@ -198,6 +335,7 @@ void carrScalarAdd(int n, Carray v, double complex z, Carray ans)
 {
     int i;
 
+    #pragma omp parallel for private(i) if (ompWorthy(n))
     for (i = 0; i < n; i++) ans[i] = v[i] + z;
 }
 
@@ -207,6 +345,7 @@ void rarrScalarAdd(int n, Rarray v, double z, Rarray ans)
 {
     int i;
 
+    #pragma omp parallel for private(i) if (ompWorthy(n))
     for (i = 0; i < n; i++) ans[i] = v[i] + z;
 }
 
@@ -216,6 +355,7 @@ void carrDiv(int n, Carray v1, Carray v2, Carray v)
 {
     int i;
 
+    #pragma omp parallel for private(i) if (ompWorthy(n))
     for (i = 0; i < n; i++) v[i] = v1[i] / v2[i];
 }
 
@@ -225,34 +365,102 @@ void rarrDiv(int n, Rarray v1, Rarray v2, Rarray v)
 {
     int i;
 
+    #pragma omp parallel for private(i) if (ompWorthy(n))
     for (i = 0; i < n; i++) v[i] = v1[i] / v2[i];
 }
 
 
 
-void carrUpdate(int n, Carray v1, double complex z, Carray v2, Carray v)
+static void carrUpdateSerial(int n, Carray v1, double complex z, Carray v2,
+            Carray v)
 {
     int i;
 
+    switch (simdLevel())
+    {
+        case SIMD_AVX512:
+            carrUpdateAVX512(n, v1, z, v2, v);
+            return;
+        case SIMD_AVX2:
+            carrUpdateAVX2(n, v1, z, v2, v);
+            return;
+    }
+
     for (i = 0; i < n; i++) v[i] = v1[i] + z * v2[i];
 }
 
 
 
-void rcarrUpdate(int n, Carray v1, double complex z, Rarray v2, Carray v)
+void carrUpdate(int n, Carray v1, double complex z, Carray v2, Carray v)
+{
+    int
+        start,
+        len;
+
+    if (ompWorthy(n))
+    {
+        // Each thread call the serial SIMD kernel on its own chunk
+        #pragma omp parallel private(start, len)
+        {
+            ompChunk(n, &start, &len);
+            carrUpdateSerial(len, v1 + start, z, v2 + start, v + start);
+        }
+        return;
+    }
+
+    carrUpdateSerial(n, v1, z, v2, v);
+}
+
+
+
+static void rcarrUpdateSerial(int n, Carray v1, double complex z, Rarray v2,
+            Carray v)
 {
     int i;
 
+    switch (simdLevel())
+    {
+        case SIMD_AVX512:
+            rcarrUpdateAVX512(n, v1, z, v2, v);
+            return;
+        case SIMD_AVX2:
+            rcarrUpdateAVX2(n, v1, z, v2, v);
+            return;
+    }
+
     for (i = 0; i < n; i++) v[i] = v1[i] + z * v2[i];
 }
 
 
 
+void rcarrUpdate(int n, Carray v1, double complex z, Rarray v2, Carray v)
+{
+    int
+        start,
+        len;
+
+    if (ompWorthy(n))
+    {
+        // Each thread call the serial SIMD kernel on its own chunk
+        #pragma omp parallel private(start, len)
+        {
+            ompChunk(n, &start, &len);
+            rcarrUpdateSerial(len, v1 + start, z, v2 + start, v + start);
+        }
+        return;
+    }
+
+    rcarrUpdateSerial(n, v1, z, v2, v);
+}
+
+
+
 void rarrUpdate(int n, Rarray v1, double z, Rarray v2, Rarray v)
 {
 
     int i;
 
+    #pragma omp parallel for private(i) if (ompWorthy(n))
     for (i = 0; i < n; i++) v[i] = v1[i] + z * v2[i];
 }
 
@@ -262,6 +470,7 @@ void carrAbs(int n, Carray v, Rarray vabs)
 {
     int i;
 
+    #pragma omp parallel for private(i) if (ompWorthy(n))
     for (i = 0; i < n; i++) vabs[i] = cabs(v[i]);
 }
 
@@ -271,6 +480,7 @@ void rarrAbs(int n, Rarray v, Rarray vabs)
 {
     int i;
 
+    #pragma omp parallel for private(i) if (ompWorthy(n))
     for (i = 0; i < n; i++) vabs[i] = fabs(v[i]);
 }
 
@@ -280,15 +490,26 @@ void rarrAbs2(int n, Rarray v, Rarray vabs)
 {
     int i;
 
+    #pragma omp parallel for private(i) if (ompWorthy(n))
     for (i = 0; i < n; i++) vabs[i] = v[i] * v[i];
 }
 
 
 
-void carrAbs2(int n, Carray v, Rarray vabs)
+static void carrAbs2Serial(int n, Carray v, Rarray vabs)
 {
     int i;
 
+    switch (simdLevel())
+    {
+        case SIMD_AVX512:
+            carrAbs2AVX512(n, v, vabs);
+            return;
+        case SIMD_AVX2:
+            carrAbs2AVX2(n, v, vabs);
+            return;
+    }
+
     for (i = 0; i < n; i++)
     {
         vabs[i] = creal(v[i]) * creal(v[i]) + cimag(v[i]) * cimag(v[i]);
@@ -297,12 +518,35 @@ void carrAbs2(int n, Carray v, Rarray vabs)
 
 
 
+void carrAbs2(int n, Carray v, Rarray vabs)
+{
+    int
+        start,
+        len;
+
+    if (ompWorthy(n))
+    {
+        // Each thread call the serial SIMD kernel on its own chunk
+        #pragma omp parallel private(start, len)
+        {
+            ompChunk(n, &start, &len);
+            carrAbs2Serial(len, v + start, vabs + start);
+        }
+        return;
+    }
+
+    carrAbs2Serial(n, v, vabs);
+}
+
+
+
 void renormalizeVector(int n, Carray v, double norm)
 {
     int i;
     double renorm;
 
     renorm = norm / carrMod(n, v);
+    #pragma omp parallel for private(i) if (ompWorthy(n))
     for (i = 0; i < n; i ++) v[i] = v[i] * renorm;
 }
 
@@ -316,11 +560,20 @@ void renormalizeVector(int n, Carray v, double norm)
 
 
 
-double complex carrDot(int n, Carray v1, Carray v2)
+static double complex carrDotSerial(int n, Carray v1, Carray v2)
 {
     int i;
 
-    double complex z = 0;
+    double complex
+        z = 0;
+
+    switch (simdLevel())
+    {
+        case SIMD_AVX512:
+            return carrDotAVX512(n, v1, v2);
+        case SIMD_AVX2:
+            return carrDotAVX2(n, v1, v2);
+    }
 
     for (i = 0; i < n; i++) z = z + conj(v1[i]) * v2[i];
 
@@ -329,15 +582,53 @@ double complex carrDot(int n, Carray v1, Carray v2)
 
 
 
+double complex carrDot(int n, Carray v1, Carray v2)
+{
+    int
+        start,
+        len;
+
+    double
+        re = 0,
+        im = 0;
+
+    double complex
+        part;
+
+    if (ompWorthy(n))
+    {
+        // partial sums of each chunk by the serial SIMD kernel
+        #pragma omp parallel private(start, len, part) reduction(+:re, im)
+        {
+            ompChunk(n, &start, &len);
+            part = carrDotSerial(len, v1 + start, v2 + start);
+            re = re + creal(part);
+            im = im + cimag(part);
+        }
+        return re + I * im;
+    }
+
+    return carrDotSerial(n, v1, v2);
+}
+
+
+
 double complex unconj_carrDot(int n, Carray v1, Carray v2)
 {
     int i;
 
-    double complex z = 0;
+    double
+        re = 0,
+        im = 0;
 
-    for (i = 0; i < n; i++) z = z + v1[i] * v2[i];
+    #pragma omp parallel for private(i) reduction(+:re, im) if (ompWorthy(n))
+    for (i = 0; i < n; i++)
+    {
+        re = re + creal(v1[i]) * creal(v2[i]) - cimag(v1[i]) * cimag(v2[i]);
+        im = im + creal(v1[i]) * cimag(v2[i]) + cimag(v1[i]) * creal(v2[i]);
+    }
 
-    return z;
+    return re + I * im;
 }
 
 
@@ -348,6 +639,7 @@ double rarrDot(int n, Rarray v1, Rarray v2)
 
     double z = 0;
 
+    #pragma omp parallel for private(i) reduction(+:z) if (ompWorthy(n))
     for (i = 0; i < n; i++) z = z + v1[i] * v2[i];
 
     return z;
@@ -361,6 +653,7 @@ double carrMod(int n, Carray v)
 
     double mod = 0;
 
+    #pragma omp parallel for private(i) reduction(+:mod) if (ompWorthy(n))
     for (i = 0; i < n; i++)
     {
         mod = mod + creal(v[i]) * creal(v[i]) + cimag(v[i]) * cimag(v[i]);
@@ -377,6 +670,7 @@ double carrMod2(int n, Carray v)
 
     double mod = 0;
 
+    #pragma omp parallel for private(i) reduction(+:mod) if (ompWorthy(n))
     for (i = 0; i < n; i++)
     {
         mod = mod + creal(v[i]) * creal(v[i]) + cimag(v[i]) * cimag(v[i]);
@@ -391,11 +685,18 @@ double complex carrReduction(int n, Carray v)
 {
     int i;
 
-    double complex red = 0;
+    double
+        re = 0,
+        im = 0;
 
-    for (i = 0; i < n; i++) red = red + v[i];
+    #pragma omp parallel for private(i) reduction(+:re, im) if (ompWorthy(n))
+    for (i = 0; i < n; i++)
+    {
+        re = re + creal(v[i]);
+        im = im + cimag(v[i]);
+    }
 
-    return red;
+    return re + I * im;
 }
 
 
@@ -406,6 +707,7 @@ double rarrReduction(int n, Rarray v)
 
     double red = 0;
 
+    #pragma omp parallel for private(i) reduction(+:red) if (ompWorthy(n))
     for (i = 0; i < n; i++) red = red + v[i];
 
     return red;
@@ -421,20 +723,196 @@ double rarrReduction(int n, Rarray v)
 
 
 
+void carrExpAccuracy(char mode)
+{
+
+/** Set the accuracy of the vector math exponentials below, from MKL VML
+  *
+  * 'H' high accuracy (about 1 ulp, default)
+  * 'L' low accuracy (about 4 ulp)
+  * 'E' enhanced performance (about half of the significant bits) **/
+
+    switch (mode)
+    {
+        case 'L':
+            vml_mode = VML_LA;
+            break;
+        case 'E':
+            vml_mode = VML_EP;
+            break;
+        default:
+            vml_mode = VML_HA;
+    }
+}
+
+
+
+MKL_INT64 carrExpMode()
+{
+    return vml_mode;
+}
+
+
+
 void carrExp(int n, double complex z, Carray v, Carray ans)
 {
-    int i;
 
-    #pragma omp parallel for private(i)
-    for (i = 0; i < n; i++) ans[i] = cexp(z * v[i]);
+/** Compute the arguments z * v[i] by blocks that fit in cache and call
+  * the vectorized complex exponential of MKL VML. The double complex
+  * has the same layout of the MKL complex type. **/
+
+    int
+        i,
+        k,
+        len;
+
+    double complex
+        arg[EXP_BLOCK];
+
+    #pragma omp parallel for private(i, k, len, arg) if (ompWorthy(n))
+    for (k = 0; k < n; k += EXP_BLOCK)
+    {
+        len = n - k < EXP_BLOCK ? n - k : EXP_BLOCK;
+        for (i = 0; i < len; i++) arg[i] = z * v[k + i];
+        vmzExp(len, (MKL_Complex16 *) arg, (MKL_Complex16 *) (ans + k),
+               vml_mode);
+    }
 }
 
 
 
 void rcarrExp(int n, double complex z, Rarray v, Carray ans)
 {
-    int i;
 
-    #pragma omp parallel for private(i)
-    for (i = 0; i < n; i++) ans[i] = cexp(z * v[i]);
+/** The exponential of z * v[i] is exp(Re(z) v[i]) (cos + i sin)(Im(z) v[i])
+  *
+  * Since z is the same for all elements, it is checked once for the cases
+  * of pure imaginary z (real time) where just the vectorized sin/cos  is
+  * needed, and real z (imaginary time) where only the real exponential is
+  * computed. The vector math functions of MKL VML are called on blocks of
+  * EXP_BLOCK elements to keep the auxiliar arrays in cache. **/
+
+    int
+        i,
+        k,
+        len;
+
+    double
+        zr,
+        zi,
+        * a,
+        arg[EXP_BLOCK],
+        e[EXP_BLOCK],
+        s[EXP_BLOCK],
+        c[EXP_BLOCK];
+
+    zr = creal(z);
+    zi = cimag(z);
+    a = (double *) ans;
+
+    #pragma omp parallel for private(i, k, len, arg, e, s, c) \
+            if (ompWorthy(n))
+    for (k = 0; k < n; k += EXP_BLOCK)
+    {
+        len = n - k < EXP_BLOCK ? n - k : EXP_BLOCK;
+
+        if (zr == 0)
+        {
+            // pure phase exp(i zi v)
+            for (i = 0; i < len; i++) arg[i] = zi * v[k + i];
+            vmdSinCos(len, arg, s, c, vml_mode);
+            for (i = 0; i < len; i++)
+            {
+                a[2 * (k + i)] = c[i];
+                a[2 * (k + i) + 1] = s[i];
+            }
+            continue;
+        }
+
+        for (i = 0; i < len; i++) arg[i] = zr * v[k + i];
+        vmdExp(len, arg, e, vml_mode);
+
+        if (zi == 0)
+        {
+            // real exponential exp(zr v)
+            for (i = 0; i < len; i++)
+            {
+                a[2 * (k + i)] = e[i];
+                a[2 * (k + i) + 1] = 0;
+            }
+            continue;
+        }
+
+        for (i = 0; i < len; i++) arg[i] = zi * v[k + i];
+        vmdSinCos(len, arg, s, c, vml_mode);
+        for (i = 0; i < len; i++)
+        {
+            a[2 * (k + i)] = e[i] * c[i];
+            a[2 * (k + i) + 1] = e[i] * s[i];
+        }
+    }
+}
+
+
+
+void carrPhaseMultiply(int n, double h, Carray expV, Carray v, Carray ans)
+{
+
+/** Real time potential step with the exponential of the linear potential
+  * given in expV, usually computed once while the potential is static,
+  * so that only the nonlinear phase exp(i h |v[i]|^2) (h = - dt g / 2) is
+  * evaluated at each step:  ans[i] = expV[i] exp(i h |v[i]|^2) v[i] **/
+
+    int
+        i,
+        k,
+        len;
+
+    double
+        re,
+        im,
+        pr,
+        pi,
+        * a,
+        * b,
+        * w,
+        arg[EXP_BLOCK],
+        s[EXP_BLOCK],
+        c[EXP_BLOCK];
+
+    if (h == 0)
+    {
+        carrMultiply(n, expV, v, ans);
+        return;
+    }
+
+    a = (double *) ans;
+    b = (double *) v;
+    w = (double *) expV;
+
+    #pragma omp parallel for private(i, k, len, re, im, pr, pi, arg, s, c) \
+            if (ompWorthy(n))
+    for (k = 0; k < n; k += EXP_BLOCK)
+    {
+        len = n - k < EXP_BLOCK ? n - k : EXP_BLOCK;
+
+        for (i = 0; i < len; i++)
+        {
+            re = b[2 * (k + i)];
+            im = b[2 * (k + i) + 1];
+            arg[i] = h * (re * re + im * im);
+        }
+        vmdSinCos(len, arg, s, c, vml_mode);
+
+        for (i = 0; i < len; i++)
+        {
+            // full phase (c + i s) expV
+            pr = c[i] * w[2 * (k + i)] - s[i] * w[2 * (k + i) + 1];
+            pi = c[i] * w[2 * (k + i) + 1] + s[i] * w[2 * (k + i)];
+            re = b[2 * (k + i)];
+            im = b[2 * (k + i) + 1];
+            a[2 * (k + i)] = pr * re - pi * im;
+            a[2 * (k + i) + 1] = pr * im + pi * re;
+        }
+    }
 }
@@ -0,0 +1,431 @@
+#include "array_simd.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <immintrin.h>
+    #define X86_SIMD
+#endif
+
+
+
+/* The kernels are compiled with target attributes so the rest of the
+ * library does not require AVX flags and the same binary run on any
+ * x86 processor.  Loads/stores are unaligned because the arrays come
+ * from plain malloc.  The tails that do not fill a register are done
+ * by scalar loops identical to the ones in array_operations.c      */
+
+
+
+static int simd_level = -1; // not yet detected
+static int simd_limit = SIMD_AVX512;
+
+
+
+int simdLevel()
+{
+
+/** Return the best instruction set supported by the processor, limited
+  * by the value given in simdForce. The detection is done only once **/
+
+    if (simd_level < 0)
+    {
+        simd_level = SIMD_NONE;
+#ifdef X86_SIMD
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        {
+            simd_level = SIMD_AVX2;
+        }
+        if (__builtin_cpu_supports("avx512f")) simd_level = SIMD_AVX512;
+#endif
+    }
+
+    if (simd_level > simd_limit) return simd_limit;
+
+    return simd_level;
+}
+
+
+
+void simdForce(int level)
+{
+    simd_limit = level;
+}
+
+
+
+#ifdef X86_SIMD
+
+
+
+/*          ***********************************************
+
+                        AVX2 - 2 complex per register
+
+            ***********************************************          */
+
+
+
+__attribute__((target("avx2,fma")))
+void carrMultiplyAVX2(int n, Carray v1, Carray v2, Carray v)
+{
+    int i;
+
+    double
+        * a = (double *) v1,
+        * b = (double *) v2,
+        * c = (double *) v;
+
+    __m256d
+        x,
+        y,
+        yre,
+        yim,
+        xsw;
+
+    for (i = 0; i + 2 <= n; i += 2)
+    {
+        x = _mm256_loadu_pd(a + 2 * i);
+        y = _mm256_loadu_pd(b + 2 * i);
+        yre = _mm256_movedup_pd(y);          // [br br ...]
+        yim = _mm256_permute_pd(y, 0xF);     // [bi bi ...]
+        xsw = _mm256_permute_pd(x, 0x5);     // [ai ar ...]
+        // even lanes ar * br - ai * bi and odd lanes ai * br + ar * bi
+        _mm256_storeu_pd(c + 2 * i,
+                _mm256_fmaddsub_pd(x, yre, _mm256_mul_pd(xsw, yim)));
+    }
+
+    for (; i < n; i++) v[i] = v1[i] * v2[i];
+}
+
+
+
+__attribute__((target("avx2,fma")))
+void carrUpdateAVX2(int n, Carray v1, double complex z, Carray v2, Carray v)
+{
+    int i;
+
+    double
+        * a = (double *) v1,
+        * b = (double *) v2,
+        * c = (double *) v;
+
+    __m256d
+        y,
+        zre = _mm256_set1_pd(creal(z)),
+        zim = _mm256_set1_pd(cimag(z));
+
+    for (i = 0; i + 2 <= n; i += 2)
+    {
+        y = _mm256_loadu_pd(b + 2 * i);
+        y = _mm256_fmaddsub_pd(y, zre,
+            _mm256_mul_pd(_mm256_permute_pd(y, 0x5), zim));
+        _mm256_storeu_pd(c + 2 * i,
+                _mm256_add_pd(_mm256_loadu_pd(a + 2 * i), y));
+    }
+
+    for (; i < n; i++) v[i] = v1[i] + z * v2[i];
+}
+
+
+
+__attribute__((target("avx2,fma")))
+void rcarrUpdateAVX2(int n, Carray v1, double complex z, Rarray v2, Carray v)
+{
+    int i;
+
+    double
+        * a = (double *) v1,
+        * c = (double *) v;
+
+    __m256d
+        x,
+        zz = _mm256_setr_pd(creal(z), cimag(z), creal(z), cimag(z));
+
+    for (i = 0; i + 2 <= n; i += 2)
+    {
+        // duplicate real numbers [x0 x0 x1 x1]
+        x = _mm256_castpd128_pd256(_mm_loadu_pd(v2 + i));
+        x = _mm256_permute4x64_pd(x, 0x50);
+        _mm256_storeu_pd(c + 2 * i,
+                _mm256_fmadd_pd(zz, x, _mm256_loadu_pd(a + 2 * i)));
+    }
+
+    for (; i < n; i++) v[i] = v1[i] + z * v2[i];
+}
+
+
+
+__attribute__((target("avx2,fma")))
+void carrAbs2AVX2(int n, Carray v, Rarray vabs)
+{
+    int i;
+
+    double
+        * a = (double *) v;
+
+    __m256d
+        x,
+        y;
+
+    for (i = 0; i + 4 <= n; i += 4)
+    {
+        x = _mm256_loadu_pd(a + 2 * i);
+        y = _mm256_loadu_pd(a + 2 * i + 4);
+        // horizontal add give the order [0 2 1 3]
+        x = _mm256_hadd_pd(_mm256_mul_pd(x, x), _mm256_mul_pd(y, y));
+        _mm256_storeu_pd(vabs + i, _mm256_permute4x64_pd(x, 0xD8));
+    }
+
+    for (; i < n; i++)
+    {
+        vabs[i] = creal(v[i]) * creal(v[i]) + cimag(v[i]) * cimag(v[i]);
+    }
+}
+
+
+
+__attribute__((target("avx2,fma")))
+double complex carrDotAVX2(int n, Carray v1, Carray v2)
+{
+    int i;
+
+    double
+        re,
+        im,
+        buf[4],
+        * a = (double *) v1,
+        * b = (double *) v2;
+
+    double complex
+        z;
+
+    __m256d
+        x,
+        y,
+        accre = _mm256_setzero_pd(),
+        accim = _mm256_setzero_pd();
+
+    for (i = 0; i + 2 <= n; i += 2)
+    {
+        x = _mm256_loadu_pd(a + 2 * i);
+        y = _mm256_loadu_pd(b + 2 * i);
+        // [ar * br, ai * bi] and [ar * bi, ai * br]
+        accre = _mm256_fmadd_pd(x, y, accre);
+        accim = _mm256_fmadd_pd(x, _mm256_permute_pd(y, 0x5), accim);
+    }
+
+    _mm256_storeu_pd(buf, accre);
+    re = buf[0] + buf[1] + buf[2] + buf[3];
+    _mm256_storeu_pd(buf, accim);
+    im = buf[0] - buf[1] + buf[2] - buf[3];
+
+    z = re + I * im;
+
+    for (; i < n; i++) z = z + conj(v1[i]) * v2[i];
+
+    return z;
+}
+
+
+
+/*          ***********************************************
+
+                      AVX512 - 4 complex per register
+
+            ***********************************************          */
+
+
+
+__attribute__((target("avx512f")))
+void carrMultiplyAVX512(int n, Carray v1, Carray v2, Carray v)
+{
+    int i;
+
+    double
+        * a = (double *) v1,
+        * b = (double *) v2,
+        * c = (double *) v;
+
+    __m512d
+        x,
+        y,
+        yre,
+        yim,
+        xsw;
+
+    for (i = 0; i + 4 <= n; i += 4)
+    {
+        x = _mm512_loadu_pd(a + 2 * i);
+        y = _mm512_loadu_pd(b + 2 * i);
+        yre = _mm512_movedup_pd(y);
+        yim = _mm512_permute_pd(y, 0xFF);
+        xsw = _mm512_permute_pd(x, 0x55);
+        _mm512_storeu_pd(c + 2 * i,
+                _mm512_fmaddsub_pd(x, yre, _mm512_mul_pd(xsw, yim)));
+    }
+
+    for (; i < n; i++) v[i] = v1[i] * v2[i];
+}
+
+
+
+__attribute__((target("avx512f")))
+void carrUpdateAVX512(int n, Carray v1, double complex z, Carray v2, Carray v)
+{
+    int i;
+
+    double
+        * a = (double *) v1,
+        * b = (double *) v2,
+        * c = (double *) v;
+
+    __m512d
+        y,
+        zre = _mm512_set1_pd(creal(z)),
+        zim = _mm512_set1_pd(cimag(z));
+
+    for (i = 0; i + 4 <= n; i += 4)
+    {
+        y = _mm512_loadu_pd(b + 2 * i);
+        y = _mm512_fmaddsub_pd(y, zre,
+            _mm512_mul_pd(_mm512_permute_pd(y, 0x55), zim));
+        _mm512_storeu_pd(c + 2 * i,
+                _mm512_add_pd(_mm512_loadu_pd(a + 2 * i), y));
+    }
+
+    for (; i < n; i++) v[i] = v1[i] + z * v2[i];
+}
+
+
+
+__attribute__((target("avx512f")))
+void rcarrUpdateAVX512(int n, Carray v1, double complex z, Rarray v2,
+     Carray v)
+{
+    int i;
+
+    double
+        * a = (double *) v1,
+        * c = (double *) v;
+
+    __m512i
+        dup = _mm512_setr_epi64(0, 0, 1, 1, 2, 2, 3, 3);
+
+    __m512d
+        x,
+        zz = _mm512_setr_pd(creal(z), cimag(z), creal(z), cimag(z),
+                            creal(z), cimag(z), creal(z), cimag(z));
+
+    for (i = 0; i + 4 <= n; i += 4)
+    {
+        // duplicate real numbers [x0 x0 x1 x1 x2 x2 x3 x3]
+        x = _mm512_castpd256_pd512(_mm256_loadu_pd(v2 + i));
+        x = _mm512_permutexvar_pd(dup, x);
+        _mm512_storeu_pd(c + 2 * i,
+                _mm512_fmadd_pd(zz, x, _mm512_loadu_pd(a + 2 * i)));
+    }
+
+    for (; i < n; i++) v[i] = v1[i] + z * v2[i];
+}
+
+
+
+__attribute__((target("avx512f")))
+void carrAbs2AVX512(int n, Carray v, Rarray vabs)
+{
+    int i;
+
+    double
+        * a = (double *) v;
+
+    __m512i
+        even = _mm512_setr_epi64(0, 2, 4, 6, 8, 10, 12, 14);
+
+    __m512d
+        x,
+        y;
+
+    for (i = 0; i + 8 <= n; i += 8)
+    {
+        x = _mm512_loadu_pd(a + 2 * i);
+        y = _mm512_loadu_pd(a + 2 * i + 8);
+        x = _mm512_mul_pd(x, x);
+        y = _mm512_mul_pd(y, y);
+        // sum with swapped pairs then gather even lanes of both
+        x = _mm512_add_pd(x, _mm512_permute_pd(x, 0x55));
+        y = _mm512_add_pd(y, _mm512_permute_pd(y, 0x55));
+        _mm512_storeu_pd(vabs + i, _mm512_permutex2var_pd(x, even, y));
+    }
+
+    for (; i < n; i++)
+    {
+        vabs[i] = creal(v[i]) * creal(v[i]) + cimag(v[i]) * cimag(v[i]);
+    }
+}
+
+
+
+__attribute__((target("avx512f")))
+double complex carrDotAVX512(int n, Carray v1, Carray v2)
+{
+    int i;
+
+    double
+        re,
+        im,
+        * a = (double *) v1,
+        * b = (double *) v2;
+
+    double complex
+        z;
+
+    __m512d
+        x,
+        y,
+        sign = _mm512_setr_pd(1, -1, 1, -1, 1, -1, 1, -1),
+        accre = _mm512_setzero_pd(),
+        accim = _mm512_setzero_pd();
+
+    for (i = 0; i + 4 <= n; i += 4)
+    {
+        x = _mm512_loadu_pd(a + 2 * i);
+        y = _mm512_loadu_pd(b + 2 * i);
+        accre = _mm512_fmadd_pd(x, y, accre);
+        accim = _mm512_fmadd_pd(x, _mm512_permute_pd(y, 0x55), accim);
+    }
+
+    re = _mm512_reduce_add_pd(accre);
+    im = _mm512_reduce_add_pd(_mm512_mul_pd(accim, sign));
+
+    z = re + I * im;
+
+    for (; i < n; i++) z = z + conj(v1[i]) * v2[i];
+
+    return z;
+}
+
+
+
+#else
+
+
+
+/* Not a x86 processor: simdLevel() is always SIMD_NONE and the kernels
+ * below are never called, but are defined to keep the library linkable */
+
+void carrMultiplyAVX2(int n, Carray v1, Carray v2, Carray v) { }
+void carrMultiplyAVX512(int n, Carray v1, Carray v2, Carray v) { }
+void carrUpdateAVX2(int n, Carray v1, double complex z, Carray v2,
+     Carray v) { }
+void carrUpdateAVX512(int n, Carray v1, double complex z, Carray v2,
+     Carray v) { }
+void rcarrUpdateAVX2(int n, Carray v1, double complex z, Rarray v2,
+     Carray v) { }
+void rcarrUpdateAVX512(int n, Carray v1, double complex z, Rarray v2,
+     Carray v) { }
+void carrAbs2AVX2(int n, Carray v, Rarray vabs) { }
+void carrAbs2AVX512(int n, Carray v, Rarray vabs) { }
+double complex carrDotAVX2(int n, Carray v1, Carray v2) { return 0; }
+double complex carrDotAVX512(int n, Carray v1, Carray v2) { return 0; }
+
+#endif
@@ -0,0 +1,176 @@
+#include "array_single.h"
+
+
+
+/*          ***********************************************
+
+                         PRECISION CONVERSION
+
+            ***********************************************          */
+
+
+
+void carr2cf(int n, Carray from, CFarray to)
+{
+    int i;
+
+    #pragma omp parallel for private(i) if (ompWorthy(n))
+    for (i = 0; i < n; i++) to[i] = (float complex) from[i];
+}
+
+
+
+void cf2carr(int n, CFarray from, Carray to)
+{
+    int i;
+
+    #pragma omp parallel for private(i) if (ompWorthy(n))
+    for (i = 0; i < n; i++) to[i] = (double complex) from[i];
+}
+
+
+
+/*          ***********************************************
+
+                     BASIC ELEMENT-WISE OPERATIONS
+
+            ***********************************************          */
+
+
+
+void cfarrMultiply(int n, CFarray v1, CFarray v2, CFarray v)
+{
+    int i;
+
+    #pragma omp parallel for private(i) if (ompWorthy(n))
+    for (i = 0; i < n; i++) v[i] = v1[i] * v2[i];
+}
+
+
+
+void cfarrTriMultiply(int n, CFarray upper, CFarray lower, CFarray mid,
+     CFarray v, CFarray ans)
+{
+
+/** ans = A . v for the cyclic tridiagonal A with the top right corner in
+  * upper[n-1] and the bottom left in lower[n-1] (zero if not cyclic) as
+  * in cyclic2CCS, without the column indexes of the CCS storage **/
+
+    int i;
+
+    ans[0] = mid[0] * v[0] + upper[0] * v[1] + upper[n-1] * v[n-1];
+
+    #pragma omp parallel for private(i) if (ompWorthy(n))
+    for (i = 1; i < n - 1; i++)
+    {
+        ans[i] = lower[i-1] * v[i-1] + mid[i] * v[i] + upper[i] * v[i+1];
+    }
+
+    ans[n-1] = lower[n-2] * v[n-2] + mid[n-1] * v[n-1] + lower[n-1] * v[0];
+}
+
+
+
+/*          ***********************************************
+
+                               FUNCTIONALS
+
+            ***********************************************          */
+
+
+
+double cfarrMod2(int n, CFarray v)
+{
+    int i;
+
+    double
+        re,
+        im,
+        mod = 0;
+
+    #pragma omp parallel for private(i, re, im) reduction(+:mod) \
+            if (ompWorthy(n))
+    for (i = 0; i < n; i++)
+    {
+        re = crealf(v[i]);
+        im = cimagf(v[i]);
+        mod = mod + re * re + im * im;
+    }
+
+    return mod;
+}
+
+
+
+/*          ***********************************************
+
+                         SPLIT-STEP KERNELS
+
+            ***********************************************          */
+
+
+
+void cfarrPotentialStep(int n, double complex z, Rarray V, double g,
+     CFarray v)
+{
+
+/** Single precision version of scarrPotentialStep. The potential of each
+  * block is computed and the exponentials taken by the single precision
+  * functions of the vector math library, with twice the elements in each
+  * SIMD register than in double **/
+
+    int
+        i,
+        k,
+        len;
+
+    float
+        zr = creal(z),
+        zi = cimag(z),
+        re,
+        im,
+        pot[EXP_BLOCK],
+        e[EXP_BLOCK],
+        s[EXP_BLOCK],
+        c[EXP_BLOCK];
+
+    #pragma omp parallel for private(i, k, len, re, im, pot, e, s, c) \
+            if (ompWorthy(n))
+    for (k = 0; k < n; k += EXP_BLOCK)
+    {
+        len = n - k < EXP_BLOCK ? n - k : EXP_BLOCK;
+
+        for (i = 0; i < len; i++)
+        {
+            re = crealf(v[k + i]);
+            im = cimagf(v[k + i]);
+            pot[i] = g * (re * re + im * im);
+        }
+
+        if (V != NULL)
+        {
+            for (i = 0; i < len; i++) pot[i] = pot[i] + V[k + i];
+        }
+
+        for (i = 0; i < len; i++) e[i] = zi * pot[i];
+        vmsSinCos(len, e, s, c, carrExpMode());
+
+        if (zr != 0)
+        {
+            for (i = 0; i < len; i++) pot[i] = zr * pot[i];
+            vmsExp(len, pot, e, carrExpMode());
+            for (i = 0; i < len; i++)
+            {
+                c[i] = e[i] * c[i];
+                s[i] = e[i] * s[i];
+            }
+        }
+
+        for (i = 0; i < len; i++)
+        {
+            re = crealf(v[k + i]);
+            im = cimagf(v[k + i]);
+            v[k + i] = (re * c[i] - im * s[i]) + I * (re * s[i] + im * c[i]);
+        }
+    }
+}
@@ -0,0 +1,300 @@
+#include "array_split.h"
+
+
+
+/*          ***********************************************
+
+                          LAYOUT CONVERSION
+
+            ***********************************************          */
+
+
+
+void carr2split(int n, Carray from, SCarray to)
+{
+    int i;
+
+    #pragma omp parallel for private(i) if (ompWorthy(n))
+    for (i = 0; i < n; i++)
+    {
+        to->re[i] = creal(from[i]);
+        to->im[i] = cimag(from[i]);
+    }
+}
+
+
+
+void split2carr(int n, SCarray from, Carray to)
+{
+    int i;
+
+    #pragma omp parallel for private(i) if (ompWorthy(n))
+    for (i = 0; i < n; i++) to[i] = from->re[i] + I * from->im[i];
+}
+
+
+
+void scarrCopy(int n, SCarray from, SCarray to)
+{
+    rarrCopy(n, from->re, to->re);
+    rarrCopy(n, from->im, to->im);
+}
+
+
+
+/*          ***********************************************
+
+                     BASIC ELEMENT-WISE OPERATIONS
+
+            ***********************************************          */
+
+
+
+void scarrMultiply(int n, SCarray v1, SCarray v2, SCarray v)
+{
+    int i;
+
+    double
+        re,
+        im;
+
+    #pragma omp parallel for private(i, re, im) if (ompWorthy(n))
+    for (i = 0; i < n; i++)
+    {
+        re = v1->re[i] * v2->re[i] - v1->im[i] * v2->im[i];
+        im = v1->re[i] * v2->im[i] + v1->im[i] * v2->re[i];
+        v->re[i] = re;
+        v->im[i] = im;
+    }
+}
+
+
+
+void rscarrMultiply(int n, Rarray v1, SCarray v2, SCarray v)
+{
+    int i;
+
+    #pragma omp parallel for private(i) if (ompWorthy(n))
+    for (i = 0; i < n; i++)
+    {
+        v->re[i] = v1[i] * v2->re[i];
+        v->im[i] = v1[i] * v2->im[i];
+    }
+}
+
+
+
+void scarrScalarMultiply(int n, SCarray v, double complex z, SCarray ans)
+{
+    int i;
+
+    double
+        re,
+        zr = creal(z),
+        zi = cimag(z);
+
+    #pragma omp parallel for private(i, re) if (ompWorthy(n))
+    for (i = 0; i < n; i++)
+    {
+        re = v->re[i] * zr - v->im[i] * zi;
+        ans->im[i] = v->re[i] * zi + v->im[i] * zr;
+        ans->re[i] = re;
+    }
+}
+
+
+
+void scarrUpdate(int n, SCarray v1, double complex z, SCarray v2, SCarray v)
+{
+    int i;
+
+    double
+        re,
+        im,
+        zr = creal(z),
+        zi = cimag(z);
+
+    #pragma omp parallel for private(i, re, im) if (ompWorthy(n))
+    for (i = 0; i < n; i++)
+    {
+        re = v1->re[i] + zr * v2->re[i] - zi * v2->im[i];
+        im = v1->im[i] + zr * v2->im[i] + zi * v2->re[i];
+        v->re[i] = re;
+        v->im[i] = im;
+    }
+}
+
+
+
+void scarrAbs2(int n, SCarray v, Rarray vabs)
+{
+    int i;
+
+    #pragma omp parallel for private(i) if (ompWorthy(n))
+    for (i = 0; i < n; i++)
+    {
+        vabs[i] = v->re[i] * v->re[i] + v->im[i] * v->im[i];
+    }
+}
+
+
+
+/*          ***********************************************
+
+                               FUNCTIONALS
+
+            ***********************************************          */
+
+
+
+double complex scarrDot(int n, SCarray v1, SCarray v2)
+{
+    int i;
+
+    double
+        re = 0,
+        im = 0;
+
+    #pragma omp parallel for private(i) reduction(+:re, im) if (ompWorthy(n))
+    for (i = 0; i < n; i++)
+    {
+        re = re + v1->re[i] * v2->re[i] + v1->im[i] * v2->im[i];
+        im = im + v1->re[i] * v2->im[i] - v1->im[i] * v2->re[i];
+    }
+
+    return re + I * im;
+}
+
+
+
+double scarrMod2(int n, SCarray v)
+{
+    int i;
+
+    double
+        mod = 0;
+
+    #pragma omp parallel for private(i) reduction(+:mod) if (ompWorthy(n))
+    for (i = 0; i < n; i++)
+    {
+        mod = mod + v->re[i] * v->re[i] + v->im[i] * v->im[i];
+    }
+
+    return mod;
+}
+
+
+
+/*          ***********************************************
+
+                         SPLIT-STEP KERNELS
+
+            ***********************************************          */
+
+
+
+static void expMultiplyBlock(int len, double zr, double zi, Rarray pot,
+            Rarray re, Rarray im)
+{
+
+/** Multiply (re + i im) by exp((zr + i zi) pot) for a block of at most
+  * EXP_BLOCK elements using the vector math library as  in  rcarrExp **/
+
+    int
+        i;
+
+    double
+        a,
+        arg[EXP_BLOCK],
+        e[EXP_BLOCK],
+        s[EXP_BLOCK],
+        c[EXP_BLOCK];
+
+    if (zi == 0)
+    {
+        for (i = 0; i < len; i++) arg[i] = zr * pot[i];
+        vmdExp(len, arg, e, carrExpMode());
+        for (i = 0; i < len; i++)
+        {
+            re[i] = e[i] * re[i];
+            im[i] = e[i] * im[i];
+        }
+        return;
+    }
+
+    for (i = 0; i < len; i++) arg[i] = zi * pot[i];
+    vmdSinCos(len, arg, s, c, carrExpMode());
+
+    if (zr != 0)
+    {
+        for (i = 0; i < len; i++) arg[i] = zr * pot[i];
+        vmdExp(len, arg, e, carrExpMode());
+        for (i = 0; i < len; i++)
+        {
+            c[i] = e[i] * c[i];
+            s[i] = e[i] * s[i];
+        }
+    }
+
+    for (i = 0; i < len; i++)
+    {
+        a = re[i] * c[i] - im[i] * s[i];
+        im[i] = re[i] * s[i] + im[i] * c[i];
+        re[i] = a;
+    }
+}
+
+
+
+void rscarrExpMultiply(int n, double complex z, Rarray pot, SCarray v)
+{
+    int
+        k,
+        len;
+
+    #pragma omp parallel for private(k, len) if (ompWorthy(n))
+    for (k = 0; k < n; k += EXP_BLOCK)
+    {
+        len = n - k < EXP_BLOCK ? n - k : EXP_BLOCK;
+        expMultiplyBlock(len, creal(z), cimag(z), pot + k,
+                v->re + k, v->im + k);
+    }
+}
+
+
+
+void scarrPotentialStep(int n, double complex z, Rarray V, double g,
+     SCarray v)
+{
+
+/** Fused split-step kernel to evolve the potential part (linear + nonlinear)
+  * The density and the full potential of a block are computed and used while
+  * still in cache, without the auxiliar arrays of size n in the interleaved
+  * version (carrAbs2 + rarrUpdate + rcarrExp + carrMultiply) **/
+
+    int
+        i,
+        k,
+        len;
+
+    double
+        pot[EXP_BLOCK];
+
+    Rarray
+        re,
+        im;
+
+    #pragma omp parallel for private(i, k, len, pot, re, im) \
+            if (ompWorthy(n))
+    for (k = 0; k < n; k += EXP_BLOCK)
+    {
+        len = n - k < EXP_BLOCK ? n - k : EXP_BLOCK;
+        re = v->re + k;
+        im = v->im + k;
+        for (i = 0; i < len; i++)
+        {
+            pot[i] = V[k + i] + g * (re[i] * re[i] + im[i] * im[i]);
+        }
+        expMultiplyBlock(len, creal(z), cimag(z), pot, re, im);
+    }
+}
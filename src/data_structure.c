@@ -52,3 +52,179 @@ void ReleaseEqDataPkg (EqDataPkg gp)
     free(gp->V);
     free(gp);
 }
+
+
+
+
+
+EqDataPkgMD PackEqDataMD(int dim, int Mpos[], double xi[], double xf[],
+            double a2, double inter, char Vname[], double p[])
+{
+
+/** Return pointer to the data structure of the equation in dim = 2 or 3
+  * dimensions, with the potential evaluated over the whole grid     **/
+
+    int
+        d;
+
+    Rarray
+        x[3];
+
+    EqDataPkgMD gp;
+
+    if (dim != 2 && dim != 3)
+    {
+        printf("\n\n\nERROR : number of dimensions must be 2 or 3\n\n");
+        exit(EXIT_FAILURE);
+    }
+
+    gp = (EqDataPkgMD) malloc(sizeof(struct _EquationDataPkgMD));
+
+    if (gp == NULL)
+    {
+        printf("\n\n\nMEMORY ERROR : malloc fail for EqData structure\n\n");
+        exit(EXIT_FAILURE);
+    }
+
+    gp->dim = dim;
+    gp->Mtot = 1;
+
+    for (d = 0; d < 3; d++)
+    {
+        if (d < dim)
+        {
+            gp->Mpos[d] = Mpos[d];
+            gp->xi[d] = xi[d];
+            gp->xf[d] = xf[d];
+            gp->dx[d] = (xf[d] - xi[d]) / (Mpos[d] - 1);
+            x[d] = rarrDef(Mpos[d]);
+            rarrFillInc(Mpos[d], xi[d], gp->dx[d], x[d]);
+        }
+        else
+        {
+            gp->Mpos[d] = 1;
+            gp->xi[d] = 0;
+            gp->xf[d] = 0;
+            gp->dx[d] = 1;
+        }
+        gp->Mtot = gp->Mtot * gp->Mpos[d];
+    }
+
+    gp->inter = inter;
+    gp->a2 = a2;
+
+    gp->p[0] = p[0];
+    gp->p[1] = p[1];
+    gp->p[2] = p[2];
+    strcpy(gp->Vname,Vname);
+
+    gp->V = rarrDef(gp->Mtot);
+
+    GetPotentialMD(dim, gp->Mpos, Vname, x, gp->V, p);
+
+    for (d = 0; d < dim; d++) free(x[d]);
+
+    return gp;
+}
+
+
+
+
+
+void ReleaseEqDataPkgMD (EqDataPkgMD gp)
+{
+    free(gp->V);
+    free(gp);
+}
+
+
+
+
+
+EqDataPkgMC PackEqDataMC(int ncomp, int Mpos, double xi, double xf,
+            double a2, doublec a1, double g[], char Vname[], double p[])
+{
+
+/** Return pointer to the data structure of ncomp coupled equations.  g
+  * has the ncomp x ncomp interaction strengths in row major order  and
+  * must be symmetric **/
+
+    int
+        c,
+        d;
+
+    Rarray
+        x;
+
+    EqDataPkgMC gp;
+
+    if (ncomp < 1 || ncomp > MAX_COMP)
+    {
+        printf("\n\n\nERROR : number of components must be from 1 to %d\n\n",
+               MAX_COMP);
+        exit(EXIT_FAILURE);
+    }
+
+    for (c = 0; c < ncomp; c++)
+    {
+        for (d = 0; d < c; d++)
+        {
+            if (g[c * ncomp + d] != g[d * ncomp + c])
+            {
+                printf("\n\n\nERROR : interaction matrix is not symmetric\n\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+
+    gp = (EqDataPkgMC) malloc(sizeof(struct _EquationDataPkgMC));
+
+    if (gp == NULL)
+    {
+        printf("\n\n\nMEMORY ERROR : malloc fail for EqData structure\n\n");
+        exit(EXIT_FAILURE);
+    }
+
+    gp->ncomp = ncomp;
+    gp->Mpos = Mpos;
+    gp->xi = xi;
+    gp->xf = xf;
+    gp->dx = (xf - xi) / (Mpos - 1);
+    gp->a2 = a2;
+    gp->a1 = a1;
+
+    for (c = 0; c < MAX_COMP; c++)
+    {
+        for (d = 0; d < MAX_COMP; d++)
+        {
+            if (c < ncomp && d < ncomp) gp->g[c][d] = g[c * ncomp + d];
+            else                        gp->g[c][d] = 0;
+        }
+    }
+
+    gp->p[0] = p[0];
+    gp->p[1] = p[1];
+    gp->p[2] = p[2];
+    strcpy(gp->Vname,Vname);
+
+    x = rarrDef(Mpos);
+    rarrFillInc(Mpos, xi, gp->dx, x);
+
+    gp->V = rarrDef(Mpos);
+
+    GetPotential(Mpos, Vname, x, gp->V, p[0], p[1], p[2]);
+
+    free(x);
+
+    return gp;
+}
+
+
+
+
+
+void ReleaseEqDataPkgMC (EqDataPkgMC gp)
+{
+    free(gp->V);
+    free(gp);
+}
@@ -45,13 +45,143 @@
 
 
 
+// number of time-steps between two samples of the energy (see convCadence)
+static int conv_cadence = CONV_CADENCE;
 
 
 
+/*          ***********************************************
 
+                         CONVERGENCE MONITOR
 
+            ***********************************************          */
 
-int ISSFFT(EqDataPkg EQ, int N, double dT, Carray S, Carray E)
+
+
+void convCadenceSet(int n)
+{
+
+/** Set the number of time-steps between two checks of convergence. Since
+  * the window has fixed number of samples it also set the minimum number
+  * of steps required to stop the evolution **/
+
+    if (n < 1) n = 1;
+    conv_cadence = n;
+}
+
+
+
+int convCadence() { return conv_cadence; }
+
+
+
+void convReset(struct ConvMonitor * mon)
+{
+    mon->count = 0;
+    mon->next = 0;
+}
+
+
+
+int convUpdate(struct ConvMonitor * mon, double E)
+{
+
+/** Record a new sample of the energy in the ring buffer and test whether
+  * the energy reached a plateau along the window. The slope of the least
+  * squares line is computed with the samples ordered from the oldest  to
+  * the newest, taking the abscissas centered at zero **/
+
+    int
+        k,
+        n;
+
+    double
+        x,
+        e,
+        min,
+        max,
+        mean,
+        slope,
+        sxx;
+
+    mon->E[mon->next] = E;
+    mon->next = (mon->next + 1) % CONV_WINDOW;
+    mon->count = mon->count + 1;
+
+    // The window must be full to decide
+    if (mon->count < CONV_WINDOW) return 0;
+
+    mean = 0;
+    min = E;
+    max = E;
+    for (k = 0; k < CONV_WINDOW; k++)
+    {
+        e = mon->E[k];
+        mean = mean + e;
+        if (e < min) min = e;
+        if (e > max) max = e;
+    }
+    mean = mean / CONV_WINDOW;
+
+    if (max - min > CONV_TOL * fabs(mean)) return 0;
+
+    slope = 0;
+    sxx = 0;
+    for (k = 0; k < CONV_WINDOW; k++)
+    {
+        // mon->next is the position of the oldest sample
+        n = (mon->next + k) % CONV_WINDOW;
+        x = k - 0.5 * (CONV_WINDOW - 1);
+        slope = slope + x * (mon->E[n] - mean);
+        sxx = sxx + x * x;
+    }
+    slope = slope / sxx;
+
+    return fabs(slope) * (CONV_WINDOW - 1) <= CONV_TOL * fabs(mean);
+}
+
+
+
+void convReport(int converged, double E, double vir)
+{
+
+/** Print the reason to stop the evolution and the accuracy of the virial
+  * theorem relative to the energy **/
+
+    sepline();
+
+    if (!converged)
+    {
+        printf("\nProcess ended without achieving");
+        printf(" stability and/or accuracy\n\n");
+        return;
+    }
+
+    printf("\nProcess ended before because \n");
+    printf("\n\t1. Energy stop decreasing  \n");
+
+    if ( fabs(vir / E) < 1E-3 )
+    {
+        printf("\n\t2. Achieved virial accuracy\n");
+    }
+    else
+    {
+        printf("\n\t2. Not so good virial value  ");
+        printf("achieved. Try smaller time-step\n");
+    }
+
+    printf("\n");
+}
+
+
+
+
+
+
+
+
+
+int ISSFFT(EqDataPkg EQ, int N, double dT, Carray S, double * E)
 {
 
 /** Evolve the wave-function given an initial condition in S
@@ -65,9 +195,10 @@ int ISSFFT(EqDataPkg EQ, int N, double dT, Carray S, Carray E)
 
     int
         i,
-        j,
         M,
-        m;
+        m,
+        start,
+        len;
 
     m = EQ->Mpos - 1;
     M = EQ->Mpos;
@@ -95,11 +226,18 @@ int ISSFFT(EqDataPkg EQ, int N, double dT, Carray S, Carray E)
     double complex
         a1,
         vir,
-        old_vir,
         dt = - I  * dT; // pure imaginary time-step
 
 
 
+    struct GPObservables
+        obs;
+
+    struct ConvMonitor
+        mon;
+
+
+
     Rarray
         abs2 = rarrDef(M), // abs square of wave function
         out  = rarrDef(M); // hold linear and nonlinear potential
@@ -126,16 +264,18 @@ int ISSFFT(EqDataPkg EQ, int N, double dT, Carray S, Carray E)
      * ------------------------------------------------------------------- */
     carrAbs2(M, S, abs2);
     norm = sqrt(Rsimps(M, abs2, dx));
-    E[0] = Energy(M, dx, a2, a1, inter, V, S);
-    vir = Virial(M, a2, a1, inter, V, dx, S);
-    R2 = MeanQuadraticR(M, S, dx);
-    old_vir = vir;
+    Observables(M, dx, a2, a1, inter, V, S,
+                OBS_ENERGY | OBS_VIRIAL | OBS_R2, &obs);
+    *E = creal(obs.energy);
+    vir = obs.virial;
+    R2 = obs.r2;
+    convReset(&mon);
     /* ------------------------------------------------------------------- */
     
     printf("\n\n\t Nstep         Energy/particle         Virial");
     printf("               sqrt<R^2>");
     sepline();
-    printf("\n\t%6d       %15.7E", 0, creal(E[0]));
+    printf("\n\t%6d       %15.7E", 0, *E);
     printf("         %15.7E       %7.4lf", creal(vir), R2);
 
 
@@ -170,101 +310,78 @@ int ISSFFT(EqDataPkg EQ, int N, double dT, Carray S, Carray E)
     for (i = 0; i < N; i++)
     {
 
-        // Apply exponential of trap potential and nonlinear part
-        carrAbs2(M, S, abs2);
-        rarrUpdate(M, V, inter, abs2, out);
-        rcarrExp(M, Idt / 2, out, stepexp);
-        carrMultiply(m, stepexp, S, forward_fft);
+        // Apply exponential of trap potential and nonlinear part. Each
+        // thread work in its own chunk of the grid in a single parallel
+        // region, thus the calls inside it run serially
+        #pragma omp parallel private(start, len) if (ompWorthy(m))
+        {
+            ompChunk(m, &start, &len);
+            carrAbs2(len, S + start, abs2 + start);
+            rarrUpdate(len, V + start, inter, abs2 + start, out + start);
+            rcarrExp(len, Idt / 2, out + start, stepexp + start);
+            carrMultiply(len, stepexp + start, S + start,
+                         forward_fft + start);
+        }
 
 
 
-        // go to momentum space
+        // go to momentum space (MKL use its own threads in the FFT)
         s = DftiComputeForward(desc, forward_fft);
         // apply exponential of derivatives
         carrMultiply(m, exp_der, forward_fft, back_fft);
         // go back to position space
         s = DftiComputeBackward(desc, back_fft);
-        carrCopy(m, back_fft, S);
-        S[m] = S[0];
 
 
 
         // Apply exponential of trap potential and nonlinear part AGAIN
-        carrAbs2(M, S, abs2);
-        rarrUpdate(M, V, inter, abs2, out);
-        rcarrExp(M, Idt / 2, out, stepexp);
-        for (j = 0; j < M; j++) S[j] = S[j] * stepexp[j];
-
-
-
-        carrAbs2(M, S, abs2);
+        // taking the solution from back_fft directly,  and compute the
+        // new density to renormalize in the same parallel region
+        #pragma omp parallel private(start, len) if (ompWorthy(m))
+        {
+            ompChunk(m, &start, &len);
+            carrAbs2(len, back_fft + start, abs2 + start);
+            rarrUpdate(len, V + start, inter, abs2 + start, out + start);
+            rcarrExp(len, Idt / 2, out + start, stepexp + start);
+            carrMultiply(len, stepexp + start, back_fft + start, S + start);
+            carrAbs2(len, S + start, abs2 + start);
+        }
+        S[m] = S[0];
+        abs2[m] = abs2[0];
 
         // Renormalization
         NormStep = norm / sqrt(Rsimps(M, abs2, dx));
-        for (j = 0; j < M; j++) S[j] = NormStep * S[j];
-
-        // Energy
-        E[i + 1] = Energy(M, dx, a2, a1, inter, V, S);
-        vir = Virial(M, a2, a1, inter, V, dx, S);
-        R2 = MeanQuadraticR(M, S, dx);
-
+        carrScalarMultiply(M, S, NormStep, S);
 
-        if ( (i+1) % 50 == 0)
+        // The observables are not needed to evolve the wave function, thus
+        // they are computed only to show the progress and at  the  cadence
+        // of the convergence monitor
+        if ( (i + 1) % 50 == 0 )
         {
-            printf("\n\t%6d       %15.7E", i + 1, creal(E[i + 1]));
+            Observables(M, dx, a2, a1, inter, V, S,
+                        OBS_ENERGY | OBS_VIRIAL | OBS_R2, &obs);
+            *E = creal(obs.energy);
+            vir = obs.virial;
+            R2 = obs.r2;
+            printf("\n\t%6d       %15.7E", i + 1, *E);
             printf("         %15.7E       %7.4lf", creal(vir), R2);
         }
 
-
-
-        if ( fabs( creal(vir - old_vir) / creal(old_vir) ) < 5E-11 )
+        if ( (i + 1) % convCadence() == 0 )
         {
-
-            // Enter here if Virial value has stabilized
-
-            j = i - 199;
-
-            if (j > 0 && fabs(creal(E[i+1] - E[j]) / creal(E[j])) < 1E-11 )
+            if ( (i + 1) % 50 != 0 )
             {
-
-                s = DftiFreeDescriptor(&desc);
-
-                free(exp_der);
-                free(stepexp);
-                free(forward_fft);
-                free(back_fft);
-                free(abs2);
-                free(out);
-
-                sepline();
-                    
-                printf("\nProcess ended before because \n");
-                printf("\n\t1. Energy stop decreasing  \n");
-                printf("\n\t2. Virial stop decreasing  \n");
-
-                if ( fabs( creal(vir) / creal(E[i+1]) ) < 1E-3 )
-                {
-                    printf("\n\t3. Achieved virial accuracy\n");
-                    printf("\n");
-                    return i + 1;
-                }
-
-                else
-                {
-                    printf("\n\t3. Not so good virial value  ");
-                    printf("achieved. Try smaller time-step\n");
-                    printf("\n");
-                    return i + 1;
-                }
+                Observables(M, dx, a2, a1, inter, V, S, OBS_ENERGY, &obs);
+                *E = creal(obs.energy);
             }
+            if ( convUpdate(&mon, *E) ) break;
         }
-
-        old_vir = vir;
     }
 
-    sepline();
-    printf("\nProcess ended without achieving");
-    printf(" stability and/or accuracy\n\n");
+    // Energy and virial of the final state
+    Observables(M, dx, a2, a1, inter, V, S, OBS_ENERGY | OBS_VIRIAL, &obs);
+    *E = creal(obs.energy);
+    convReport((int) i < N, *E, creal(obs.virial));
 
     s = DftiFreeDescriptor(&desc);
 
@@ -275,7 +392,7 @@ int ISSFFT(EqDataPkg EQ, int N, double dT, Carray S, Carray E)
     free(abs2);
     free(out);
 
-    return N + 1;
+    return i + 1;
 }
 
 
@@ -287,13 +404,16 @@ int ISSFFT(EqDataPkg EQ, int N, double dT, Carray S, Carray E)
 
 
 
-int ISSCNSM(EqDataPkg EQ, int N, double dT, int cyclic, Carray S, Carray E)
+int ISSCNSM(EqDataPkg EQ, int N, double dT, int cyclic, Carray S, double * E)
 {
 
     unsigned int
         M,
-        i,
-        j;
+        i;
+
+    int
+        start,
+        len;
 
     M = EQ->Mpos;
 
@@ -312,7 +432,6 @@ int ISSCNSM(EqDataPkg EQ, int N, double dT, int cyclic, Carray S, Carray E)
     double complex
         a1,
         vir,
-        old_vir,
         dt = - I  * dT; // pure imaginary time-step
 
 
@@ -329,6 +448,14 @@ int ISSCNSM(EqDataPkg EQ, int N, double dT, int cyclic, Carray S, Carray E)
         rhs   = carrDef(M - 1);
 
 
+    struct GPObservables
+        obs;
+
+    struct ConvMonitor
+        mon;
+
+
+
     Rarray
         abs2 = rarrDef(M);
 
@@ -337,6 +464,10 @@ int ISSCNSM(EqDataPkg EQ, int N, double dT, int cyclic, Carray S, Carray E)
         cnmat;
 
 
+    RTriFactMat
+        rfact;
+
+
 
     a2 = EQ->a2;
     a1 = EQ->a1;
@@ -350,16 +481,18 @@ int ISSCNSM(EqDataPkg EQ, int N, double dT, int cyclic, Carray S, Carray E)
      * ----------------------------------------------------- */
     carrAbs2(M, S, abs2);
     norm = sqrt(Rsimps(M, abs2, dx));
-    E[0] = Energy(M, dx, a2, a1, inter, V, S);
-    vir = Virial(M, a2, a1, inter, V, dx, S);
-    R2 = MeanQuadraticR(M, S, dx);
-    old_vir = vir;
+    Observables(M, dx, a2, a1, inter, V, S,
+                OBS_ENERGY | OBS_VIRIAL | OBS_R2, &obs);
+    *E = creal(obs.energy);
+    vir = obs.virial;
+    R2 = obs.r2;
+    convReset(&mon);
     /* ----------------------------------------------------- */
 
     printf("\n\n\t Nstep         Energy/particle         Virial");
     printf("               sqrt<R^2>");
     sepline();
-    printf("\n\t%6d       %15.7E", 0, creal(E[0]));
+    printf("\n\t%6d       %15.7E", 0, *E);
     printf("         %15.7E       %7.4lf", creal(vir), R2);
 
 
@@ -367,107 +500,94 @@ int ISSCNSM(EqDataPkg EQ, int N, double dT, int cyclic, Carray S, Carray E)
     // Configure the linear system from Crank-Nicolson scheme
     cnmat = CNmat(M, dx, dt, a2, a1, inter, V, cyclic, upper, lower, mid);
 
+    // Without first order derivative the matrices are pure imaginary. In
+    // this case factorize once the real matrix R = LHS / i and multiply
+    // the RHS matrix by - i, to solve in real arithmetic at each step
+    rfact = triCyclicImagFactor(M - 1, upper, lower, mid);
+    if (rfact != NULL)
+    {
+        carrScalarMultiply((M - 1) * cnmat->m, cnmat->vec, - I, cnmat->vec);
+    }
+
 
 
     for (i = 0; i < N; i++)
     {
 
-        // Apply exponential with nonlinear part
-        carrAbs2(M, S, abs2);
-        rcarrExp(M, inter * Idt / 2, abs2, stepexp);
-        carrMultiply(M, stepexp, S, linpart);
+        // Apply exponential with nonlinear part. Each thread work in its
+        // own chunk of the grid in a single parallel region
+        #pragma omp parallel private(start, len) if (ompWorthy(M))
+        {
+            ompChunk(M, &start, &len);
+            carrAbs2(len, S + start, abs2 + start);
+            rcarrExp(len, inter * Idt / 2, abs2 + start, stepexp + start);
+            carrMultiply(len, stepexp + start, S + start, linpart + start);
+        }
 
 
 
         // Solve linear part
         CCSvec(M - 1, cnmat->vec, cnmat->col, cnmat->m, linpart, rhs);
-        triCyclicSM(M - 1, upper, lower, mid, rhs, linpart);
+        if (rfact != NULL)
+        {
+            triCyclicFactSolve(rfact, rhs, linpart);
+        }
+        else
+        {
+            triCyclicSM(M - 1, upper, lower, mid, rhs, linpart);
+        }
         if (cyclic) { linpart[M-1] = linpart[0]; } // Cyclic system
         else        { linpart[M-1] = 0;          } // zero boundary
 
 
 
-        // Apply exponential with nonlinear part AGAIN
-        carrAbs2(M, linpart, abs2);
-        rcarrExp(M, inter * Idt / 2, abs2, stepexp);
-        carrMultiply(M, stepexp, linpart, S);
-
-
-
-        carrAbs2(M, S, abs2);
+        // Apply exponential with nonlinear part AGAIN and take the new
+        // density to renormalize in the same parallel region
+        #pragma omp parallel private(start, len) if (ompWorthy(M))
+        {
+            ompChunk(M, &start, &len);
+            carrAbs2(len, linpart + start, abs2 + start);
+            rcarrExp(len, inter * Idt / 2, abs2 + start, stepexp + start);
+            carrMultiply(len, stepexp + start, linpart + start, S + start);
+            carrAbs2(len, S + start, abs2 + start);
+        }
 
 
 
         // Renormalize
         NormStep = norm / sqrt(Rsimps(M, abs2, dx));
-        for (j = 0; j < M; j++) S[j] = NormStep * S[j];
+        carrScalarMultiply(M, S, NormStep, S);
         
-        // Energy
-        E[i + 1] = Energy(M, dx, a2, a1, inter, V, S);
-        vir = Virial(M, a2, a1, inter, V, dx, S);
-        R2 = MeanQuadraticR(M, S, dx);
-
-
-        if ( (i+1) % 50 == 0 )
+        // The observables are not needed to evolve the wave function, thus
+        // they are computed only to show the progress and at  the  cadence
+        // of the convergence monitor
+        if ( (i + 1) % 50 == 0 )
         {
-            printf("\n\t%6d       %15.7E", i + 1, creal(E[i + 1]));
+            Observables(M, dx, a2, a1, inter, V, S,
+                        OBS_ENERGY | OBS_VIRIAL | OBS_R2, &obs);
+            *E = creal(obs.energy);
+            vir = obs.virial;
+            R2 = obs.r2;
+            printf("\n\t%6d       %15.7E", i + 1, *E);
             printf("         %15.7E       %7.4lf", creal(vir), R2);
         }
 
-
-
-        if ( fabs( creal(vir - old_vir) / creal(old_vir) ) < 5E-11 )
+        if ( (i + 1) % convCadence() == 0 )
         {
-
-            // Enter here if Virial value has stabilized
-
-            j = i - 199;
-
-            if (j > 0 && fabs(creal(E[i+1] - E[j]) / creal(E[j])) < 1E-11 )
+            if ( (i + 1) % 50 != 0 )
             {
-
-                // Enter here if energy has stabilized. If that
-                // is the case free memory and finish execution
-
-                free(stepexp);
-                free(linpart);
-                free(abs2);
-                free(upper);
-                free(lower);
-                free(mid);
-                free(rhs);
-                CCSFree(cnmat);
-
-                sepline();
-                
-                printf("\nProcess ended before because \n");
-                printf("\n\t1. Energy stop decreasing  \n");
-                printf("\n\t2. Virial stop decreasing  \n");
-
-                if ( fabs( creal(vir) / creal(E[i+1]) ) < 1E-3 )
-                {
-                    printf("\n\t3. Achieved virial accuracy\n");
-                    printf("\n");
-                    return i + 1;
-                }
-
-                else
-                {
-                    printf("\n\t3. Not so good virial value  ");
-                    printf("achieved. Try smaller time-step\n");
-                    printf("\n");
-                    return i + 1;
-                }
+                Observables(M, dx, a2, a1, inter, V, S, OBS_ENERGY, &obs);
+                *E = creal(obs.energy);
             }
+            if ( convUpdate(&mon, *E) ) break;
         }
 
-        old_vir = vir;
-
     }
     
-    sepline();
-    printf("\nProcess ended without achieving");
-    printf(" stability and/or accuracy\n\n");
+    // Energy and virial of the final state
+    Observables(M, dx, a2, a1, inter, V, S, OBS_ENERGY | OBS_VIRIAL, &obs);
+    *E = creal(obs.energy);
+    convReport((int) i < N, *E, creal(obs.virial));
 
     free(stepexp);
     free(linpart);
@@ -477,8 +597,9 @@ int ISSCNSM(EqDataPkg EQ, int N, double dT, int cyclic, Carray S, Carray E)
     free(mid);
     free(rhs);
     CCSFree(cnmat);
+    if (rfact != NULL) RTriFactFree(rfact);
 
-    return N + 1;
+    return i + 1;
 }
 
 
@@ -490,13 +611,16 @@ int ISSCNSM(EqDataPkg EQ, int N, double dT, int cyclic, Carray S, Carray E)
 
 
 
-int ISSCNLU(EqDataPkg EQ, int N, double dT, int cyclic, Carray S, Carray E)
+int ISSCNLU(EqDataPkg EQ, int N, double dT, int cyclic, Carray S, double * E)
 {
 
     unsigned int
         M,
-        i,
-        j;
+        i;
+
+    int
+        start,
+        len;
 
     M = EQ->Mpos;
 
@@ -513,7 +637,6 @@ int ISSCNLU(EqDataPkg EQ, int N, double dT, int cyclic, Carray S, Carray E)
     double complex
         a1,
         vir,
-        old_vir,
         dt = - I  * dT;
 
     Carray
@@ -529,6 +652,14 @@ int ISSCNLU(EqDataPkg EQ, int N, double dT, int cyclic, Carray S, Carray E)
         rhs   = carrDef(M - 1);
 
 
+    struct GPObservables
+        obs;
+
+    struct ConvMonitor
+        mon;
+
+
+
     Rarray
         abs2 = rarrDef(M);
 
@@ -537,6 +668,10 @@ int ISSCNLU(EqDataPkg EQ, int N, double dT, int cyclic, Carray S, Carray E)
         cnmat;
 
 
+    RTriFactMat
+        rfact;
+
+
 
     a2 = EQ->a2;
     a1 = EQ->a1;
@@ -550,16 +685,18 @@ int ISSCNLU(EqDataPkg EQ, int N, double dT, int cyclic, Carray S, Carray E)
      * ----------------------------------------------------- */
     carrAbs2(M, S, abs2);
     norm = sqrt(Rsimps(M, abs2, dx));
-    E[0] = Energy(M, dx, a2, a1, inter, V, S);
-    vir = Virial(M, a2, a1, inter, V, dx, S);
-    R2 = MeanQuadraticR(M, S, dx);
-    old_vir = vir;
+    Observables(M, dx, a2, a1, inter, V, S,
+                OBS_ENERGY | OBS_VIRIAL | OBS_R2, &obs);
+    *E = creal(obs.energy);
+    vir = obs.virial;
+    R2 = obs.r2;
+    convReset(&mon);
     /* ----------------------------------------------------- */
 
     printf("\n\n\t Nstep         Energy/particle         Virial");
     printf("               sqrt<R^2>");
     sepline();
-    printf("\n\t%6d       %15.7E", 0, creal(E[0]));
+    printf("\n\t%6d       %15.7E", 0, *E);
     printf("         %15.7E       %7.4lf", creal(vir), R2);
 
 
@@ -567,102 +704,92 @@ int ISSCNLU(EqDataPkg EQ, int N, double dT, int cyclic, Carray S, Carray E)
     // Configure the linear system from Crank-Nicolson scheme
     cnmat = CNmat(M, dx, dt, a2, a1, inter, V, cyclic, upper, lower, mid);
 
+    // Without first order derivative the matrices are pure imaginary. In
+    // this case factorize once the real matrix R = LHS / i and multiply
+    // the RHS matrix by - i, to solve in real arithmetic at each step
+    rfact = triCyclicImagFactor(M - 1, upper, lower, mid);
+    if (rfact != NULL)
+    {
+        carrScalarMultiply((M - 1) * cnmat->m, cnmat->vec, - I, cnmat->vec);
+    }
+
 
 
     for (i = 0; i < N; i++)
     {
 
-        // Apply exponential with nonlinear part
-        carrAbs2(M, S, abs2);
-        rcarrExp(M, inter * Idt / 2, abs2, stepexp);
-        carrMultiply(M, stepexp, S, linpart);
+        // Apply exponential with nonlinear part. Each thread work in its
+        // own chunk of the grid in a single parallel region
+        #pragma omp parallel private(start, len) if (ompWorthy(M))
+        {
+            ompChunk(M, &start, &len);
+            carrAbs2(len, S + start, abs2 + start);
+            rcarrExp(len, inter * Idt / 2, abs2 + start, stepexp + start);
+            carrMultiply(len, stepexp + start, S + start, linpart + start);
+        }
 
 
 
         // Solve linear part
         CCSvec(M - 1, cnmat->vec, cnmat->col, cnmat->m, linpart, rhs);
-        triCyclicLU(M - 1, upper, lower, mid, rhs, linpart);
+        if (rfact != NULL)
+        {
+            triCyclicFactSolve(rfact, rhs, linpart);
+        }
+        else
+        {
+            triCyclicLU(M - 1, upper, lower, mid, rhs, linpart);
+        }
         if (cyclic) { linpart[M-1] = linpart[0]; } // Cyclic system
         else        { linpart[M-1] = 0;          } // zero boundary
 
 
 
-        // Apply exponential with nonlinear part AGAIN
-        carrAbs2(M, linpart, abs2);
-        rcarrExp(M, inter * Idt / 2, abs2, stepexp);
-        carrMultiply(M, stepexp, linpart, S);
-
-
-
-        carrAbs2(M, S, abs2);
+        // Apply exponential with nonlinear part AGAIN and take the new
+        // density to renormalize in the same parallel region
+        #pragma omp parallel private(start, len) if (ompWorthy(M))
+        {
+            ompChunk(M, &start, &len);
+            carrAbs2(len, linpart + start, abs2 + start);
+            rcarrExp(len, inter * Idt / 2, abs2 + start, stepexp + start);
+            carrMultiply(len, stepexp + start, linpart + start, S + start);
+            carrAbs2(len, S + start, abs2 + start);
+        }
 
         // Renormalize
         NormStep = norm / sqrt(Rsimps(M, abs2, dx));
-        for (j = 0; j < M; j++) S[j] = NormStep * S[j];
+        carrScalarMultiply(M, S, NormStep, S);
         
-        // Energy
-        E[i + 1] = Energy(M, dx, a2, a1, inter, V, S);
-        vir = Virial(M, a2, a1, inter, V, dx, S);
-        R2 = MeanQuadraticR(M, S, dx);
-
-
-        if ( (i+1) % 50 == 0 )
+        // The observables are not needed to evolve the wave function, thus
+        // they are computed only to show the progress and at  the  cadence
+        // of the convergence monitor
+        if ( (i + 1) % 50 == 0 )
         {
-            printf("\n\t%6d       %15.7E", i + 1, creal(E[i + 1]));
+            Observables(M, dx, a2, a1, inter, V, S,
+                        OBS_ENERGY | OBS_VIRIAL | OBS_R2, &obs);
+            *E = creal(obs.energy);
+            vir = obs.virial;
+            R2 = obs.r2;
+            printf("\n\t%6d       %15.7E", i + 1, *E);
             printf("         %15.7E       %7.4lf", creal(vir), R2);
         }
 
-
-
-        if ( fabs( creal(vir - old_vir) / creal(old_vir) ) < 5E-11 )
+        if ( (i + 1) % convCadence() == 0 )
         {
-
-            // Enter here if Virial value has stabilized
-
-            j = i - 199;
-
-            if (j > 0 && fabs(creal(E[i+1] - E[j]) / creal(E[j])) < 1E-11 )
+            if ( (i + 1) % 50 != 0 )
             {
-
-                free(stepexp);
-                free(linpart);
-                free(abs2);
-                free(upper);
-                free(lower);
-                free(mid);
-                free(rhs);
-                CCSFree(cnmat);
-                
-                sepline();
-
-                printf("\nProcess ended before because \n");
-                printf("\n\t1. Energy stop decreasing  \n");
-                printf("\n\t2. Virial stop decreasing  \n");
-
-                if ( fabs( creal(vir) / creal(E[i+1]) ) < 1E-3 )
-                {
-                    printf("\n\t3. Achieved virial accuracy\n");
-                    printf("\n");
-                    return i + 1;
-                }
-
-                else
-                {
-                    printf("\n\t3. Not so good virial value  ");
-                    printf("achieved. Try smaller time-step\n");
-                    printf("\n");
-                    return i + 1;
-                }
+                Observables(M, dx, a2, a1, inter, V, S, OBS_ENERGY, &obs);
+                *E = creal(obs.energy);
             }
+            if ( convUpdate(&mon, *E) ) break;
         }
 
-        old_vir = vir;
-
     }
 
-    sepline();
-    printf("\nProcess ended without achieving");
-    printf(" stability and/or accuracy\n\n");
+    // Energy and virial of the final state
+    Observables(M, dx, a2, a1, inter, V, S, OBS_ENERGY | OBS_VIRIAL, &obs);
+    *E = creal(obs.energy);
+    convReport((int) i < N, *E, creal(obs.virial));
 
     free(stepexp);
     free(linpart);
@@ -672,8 +799,9 @@ int ISSCNLU(EqDataPkg EQ, int N, double dT, int cyclic, Carray S, Carray E)
     free(mid);
     free(rhs);
     CCSFree(cnmat);
+    if (rfact != NULL) RTriFactFree(rfact);
 
-    return N + 1;
+    return i + 1;
 }
 
 
@@ -745,7 +873,7 @@ void NonLinearVIDDT(int M, double t, Carray Psi, Carray FullPot, Carray Dpsi)
 
 
 
-int ISSCNRK4(EqDataPkg EQ, int N, double dT, int cyclic, Carray S, Carray E)
+int ISSCNRK4(EqDataPkg EQ, int N, double dT, int cyclic, Carray S, double * E)
 {
 
 /** Evolve Gross-Pitaevskii using 4-th order Runge-Kutta
@@ -774,10 +902,17 @@ int ISSCNRK4(EqDataPkg EQ, int N, double dT, int cyclic, Carray S, Carray E)
     double complex
         a1,
         vir,
-        old_vir,
         dt,
         interv[1];
 
+    struct GPObservables
+        obs;
+
+    struct ConvMonitor
+        mon;
+
+
+
     Rarray
         abs2 = rarrDef(M); // abs square of wave function
 
@@ -795,6 +930,10 @@ int ISSCNRK4(EqDataPkg EQ, int N, double dT, int cyclic, Carray S, Carray E)
         cnmat;
 
 
+    RTriFactMat
+        rfact;
+
+
 
     a2 = EQ->a2;
     a1 = EQ->a1;
@@ -813,16 +952,18 @@ int ISSCNRK4(EqDataPkg EQ, int N, double dT, int cyclic, Carray S, Carray E)
      * ----------------------------------------------------- */
     carrAbs2(M, S, abs2);
     norm = sqrt(Rsimps(M, abs2, dx));
-    E[0] = Energy(M, dx, a2, a1, inter, V, S);
-    R2 = MeanQuadraticR(M, S, dx);
-    vir = Virial(M, a2, a1, inter, V, dx, S);
-    old_vir = vir;
+    Observables(M, dx, a2, a1, inter, V, S,
+                OBS_ENERGY | OBS_VIRIAL | OBS_R2, &obs);
+    *E = creal(obs.energy);
+    vir = obs.virial;
+    R2 = obs.r2;
+    convReset(&mon);
     /* ----------------------------------------------------- */
     
     printf("\n\n\t Nstep         Energy/particle         Virial");
     printf("               sqrt<R^2>");
     sepline();
-    printf("\n\t%6d       %15.7E", 0, creal(E[0]));
+    printf("\n\t%6d       %15.7E", 0, *E);
     printf("         %15.7E       %7.4lf", creal(vir), R2);
 
 
@@ -830,6 +971,15 @@ int ISSCNRK4(EqDataPkg EQ, int N, double dT, int cyclic, Carray S, Carray E)
     // Configure the linear system from Crank-Nicolson scheme
     cnmat = CNmat(M, dx, dt, a2, a1, inter, V, cyclic, upper, lower, mid);
 
+    // Without first order derivative the matrices are pure imaginary. In
+    // this case factorize once the real matrix R = LHS / i and multiply
+    // the RHS matrix by - i, to solve in real arithmetic at each step
+    rfact = triCyclicImagFactor(M - 1, upper, lower, mid);
+    if (rfact != NULL)
+    {
+        carrScalarMultiply((M - 1) * cnmat->m, cnmat->vec, - I, cnmat->vec);
+    }
+
 
 
     for (i = 0; i < N; i++)
@@ -842,7 +992,14 @@ int ISSCNRK4(EqDataPkg EQ, int N, double dT, int cyclic, Carray S, Carray E)
 
         // Solve linear part (nabla ^ 2 part)
         CCSvec(M - 1, cnmat->vec, cnmat->col, cnmat->m, linpart, rhs);
-        triCyclicSM(M - 1, upper, lower, mid, rhs, linpart);
+        if (rfact != NULL)
+        {
+            triCyclicFactSolve(rfact, rhs, linpart);
+        }
+        else
+        {
+            triCyclicSM(M - 1, upper, lower, mid, rhs, linpart);
+        }
         if (cyclic) { linpart[M-1] = linpart[0]; } // Cyclic system
         else        { linpart[M-1] = 0;          } // zero boundary
 
@@ -861,68 +1018,36 @@ int ISSCNRK4(EqDataPkg EQ, int N, double dT, int cyclic, Carray S, Carray E)
         NormStep = norm / sqrt(Rsimps(M, abs2, dx));
         for (j = 0; j < M; j++) S[j] = NormStep * S[j];
 
-        // Energy
-        E[i + 1] = Energy(M, dx, a2, a1, inter, V, S);
-        vir = Virial(M, a2, a1, inter, V, dx, S);
-        R2 = MeanQuadraticR(M, S, dx);
-
-        if ( (i+1) % 50 == 0 )
+        // The observables are not needed to evolve the wave function, thus
+        // they are computed only to show the progress and at  the  cadence
+        // of the convergence monitor
+        if ( (i + 1) % 50 == 0 )
         {
-            printf("\n\t%6d       %15.7E", i + 1, creal(E[i + 1]));
+            Observables(M, dx, a2, a1, inter, V, S,
+                        OBS_ENERGY | OBS_VIRIAL | OBS_R2, &obs);
+            *E = creal(obs.energy);
+            vir = obs.virial;
+            R2 = obs.r2;
+            printf("\n\t%6d       %15.7E", i + 1, *E);
             printf("         %15.7E       %7.4lf", creal(vir), R2);
         }
 
-
-
-        if ( fabs( creal(vir - old_vir) / creal(old_vir) ) < 5E-11 )
+        if ( (i + 1) % convCadence() == 0 )
         {
-
-            // Enter here if Virial value has stabilized
-
-            j = i - 199;
-
-            if (j > 0 && fabs(creal(E[i+1] - E[j]) / creal(E[j])) < 1E-11 )
+            if ( (i + 1) % 50 != 0 )
             {
-
-                free(linpart);
-                free(upper);
-                free(lower);
-                free(abs2);
-                free(mid);
-                free(rhs);
-                CCSFree(cnmat);
-
-                sepline();
-
-                printf("\nProcess ended before because \n");
-                printf("\n\t1. Energy stop decreasing  \n");
-                printf("\n\t2. Virial stop decreasing  \n");
-
-                if ( fabs( creal(vir) / creal(E[i+1]) ) < 1E-3 )
-                {
-                    printf("\n\t3. Achieved virial accuracy\n");
-                    printf("\n");
-                    return i + 1;
-                }
-
-                else
-                {
-                    printf("\n\t3. Not so good virial value  ");
-                    printf("achieved. Try smaller time-step\n");
-                    printf("\n");
-                    return i + 1;
-                }
+                Observables(M, dx, a2, a1, inter, V, S, OBS_ENERGY, &obs);
+                *E = creal(obs.energy);
             }
-
+            if ( convUpdate(&mon, *E) ) break;
         }
 
-        old_vir = vir;
-
     }
     
-    sepline();
-    printf("\nProcess ended without achieving");
-    printf(" stability and/or accuracy\n\n");
+    // Energy and virial of the final state
+    Observables(M, dx, a2, a1, inter, V, S, OBS_ENERGY | OBS_VIRIAL, &obs);
+    *E = creal(obs.energy);
+    convReport((int) i < N, *E, creal(obs.virial));
 
     free(linpart);
     free(upper);
@@ -931,8 +1056,9 @@ int ISSCNRK4(EqDataPkg EQ, int N, double dT, int cyclic, Carray S, Carray E)
     free(mid);
     free(rhs);
     CCSFree(cnmat);
+    if (rfact != NULL) RTriFactFree(rfact);
 
-    return N + 1;
+    return i + 1;
 }
 
 
@@ -944,7 +1070,7 @@ int ISSCNRK4(EqDataPkg EQ, int N, double dT, int cyclic, Carray S, Carray E)
 
 
 
-int ISSFFTRK4(EqDataPkg EQ, int N, double dT, Carray S, Carray E)
+int ISSFFTRK4(EqDataPkg EQ, int N, double dT, Carray S, double * E)
 {
 
 /** Evolve the wave-function given an initial condition in S
@@ -987,11 +1113,18 @@ int ISSFFTRK4(EqDataPkg EQ, int N, double dT, Carray S, Carray E)
     double complex
         a1,
         vir,
-        old_vir,
         dt = - I * dT;
 
 
 
+    struct GPObservables
+        obs;
+
+    struct ConvMonitor
+        mon;
+
+
+
     Rarray
         abs2 = rarrDef(M); // abs square of wave function
 
@@ -1024,16 +1157,18 @@ int ISSFFTRK4(EqDataPkg EQ, int N, double dT, Carray S, Carray E)
      * ------------------------------------------------------------------- */
     carrAbs2(M, S, abs2);
     norm = sqrt(Rsimps(M, abs2, dx));
-    E[0] = Energy(M, dx, a2, a1, inter, V, S);
-    vir = Virial(M, a2, a1, inter, V, dx, S);
-    R2 = MeanQuadraticR(M, S, dx);
-    old_vir = vir;
+    Observables(M, dx, a2, a1, inter, V, S,
+                OBS_ENERGY | OBS_VIRIAL | OBS_R2, &obs);
+    *E = creal(obs.energy);
+    vir = obs.virial;
+    R2 = obs.r2;
+    convReset(&mon);
     /* ------------------------------------------------------------------- */
     
     printf("\n\n\t Nstep         Energy/particle         Virial");
     printf("               sqrt<R^2>");
     sepline();
-    printf("\n\t%6d       %15.7E", 0, creal(E[0]));
+    printf("\n\t%6d       %15.7E", 0, *E);
     printf("         %15.7E       %7.4lf", creal(vir), R2);
 
 
@@ -1095,70 +1230,36 @@ int ISSFFTRK4(EqDataPkg EQ, int N, double dT, Carray S, Carray E)
         NormStep = norm / sqrt(Rsimps(M, abs2, dx));
         for (j = 0; j < M; j++) S[j] = NormStep * S[j];
 
-        // Energy
-        E[i + 1] = Energy(M, dx, a2, a1, inter, V, S);
-        vir = Virial(M, a2, a1, inter, V, dx, S);
-        R2 = MeanQuadraticR(M, S, dx);
-
-        if ( (i+1) % 50 == 0 )
+        // The observables are not needed to evolve the wave function, thus
+        // they are computed only to show the progress and at  the  cadence
+        // of the convergence monitor
+        if ( (i + 1) % 50 == 0 )
         {
-            printf("\n\t%6d       %15.7E", i + 1, creal(E[i + 1]));
+            Observables(M, dx, a2, a1, inter, V, S,
+                        OBS_ENERGY | OBS_VIRIAL | OBS_R2, &obs);
+            *E = creal(obs.energy);
+            vir = obs.virial;
+            R2 = obs.r2;
+            printf("\n\t%6d       %15.7E", i + 1, *E);
             printf("         %15.7E       %7.4lf", creal(vir), R2);
         }
 
-
-
-        if ( fabs( creal(vir - old_vir) / creal(old_vir) ) < 5E-11 )
+        if ( (i + 1) % convCadence() == 0 )
         {
-
-            // Enter here if Virial value has stabilized
-
-            j = i - 199;
-
-            if (j > 0 && fabs(creal(E[i+1] - E[j]) / creal(E[j])) < 1E-11 )
+            if ( (i + 1) % 50 != 0 )
             {
-
-                s = DftiFreeDescriptor(&desc);
-
-                free(exp_der);
-                free(forward_fft);
-                free(back_fft);
-                free(abs2);
-                free(argRK4);
-                free(FullPot);
-                
-                sepline();
-
-                printf("\nProcess ended before because \n");
-                printf("\n\t1. Energy stop decreasing  \n");
-                printf("\n\t2. Virial stop decreasing  \n");
-
-                if ( fabs( creal(vir) / creal(E[i+1]) ) < 1E-3 )
-                {
-                    printf("\n\t3. Achieved virial accuracy\n");
-                    printf("\n");
-                    return i + 1;
-                }
-
-                else
-                {
-                    printf("\n\t3. Not so good virial value  ");
-                    printf("achieved. Try smaller time-step\n");
-                    printf("\n");
-                    return i + 1;
-                }
-
+                Observables(M, dx, a2, a1, inter, V, S, OBS_ENERGY, &obs);
+                *E = creal(obs.energy);
             }
-
+            if ( convUpdate(&mon, *E) ) break;
         }
 
-        old_vir = vir;
-
     }
     
-    sepline();
-    printf("\nProcess ended without achieving");
-    printf(" stability and/or accuracy\n\n");
+    // Energy and virial of the final state
+    Observables(M, dx, a2, a1, inter, V, S, OBS_ENERGY | OBS_VIRIAL, &obs);
+    *E = creal(obs.energy);
+    convReport((int) i < N, *E, creal(obs.virial));
 
     s = DftiFreeDescriptor(&desc);
 
@@ -1169,5 +1270,159 @@ int ISSFFTRK4(EqDataPkg EQ, int N, double dT, Carray S, Carray E)
     free(argRK4);
     free(FullPot);
 
-    return N + 1;
+    return i + 1;
+}
+
+
+
+
+
+
+
+
+
+
+
+/*          ***********************************************
+
+                   NESTED GRIDS (COARSE TO FINE) DRIVER
+
+            ***********************************************          */
+
+
+
+static int ISSmethod(EqDataPkg EQ, int N, double dT, int cyclic, Carray S,
+           double * E, int method)
+{
+
+/** Call the integrator identified by 'method' (see ISSnested) **/
+
+    switch (method)
+    {
+        case 1:
+            return ISSCNRK4(EQ, N, dT, cyclic, S, E);
+        case 2:
+            return ISSFFTRK4(EQ, N, dT, S, E);
+        case 3:
+            return ISSCNSM(EQ, N, dT, cyclic, S, E);
+        case 4:
+            return ISSCNLU(EQ, N, dT, cyclic, S, E);
+        case 5:
+            return ISSFFT(EQ, N, dT, S, E);
+    }
+
+    printf("\n\n\tERROR : Invalid imaginary time method %d\n\n", method);
+    exit(EXIT_FAILURE);
+}
+
+
+
+int ISSnested(EqDataPkg EQ, int N, double dT, int cyclic, Carray S, double * E,
+    int method, int levels)
+{
+
+/** Find the ground state starting in a coarse grid, that is a subset of
+  * the grid of EQ, where the wave function converge much faster.   The
+  * solution is prolonged to the next finer grid, with half the spacing,
+  * until reach the grid of EQ, where only a few time-steps are required
+  * to remove the interpolation error, since the low-frequency components
+  * have already converged. The number of levels actually used is limited
+  * by the grid size, that must remain even and above NESTED_MIN_M.
+  *
+  * Return the number of time-steps done in the finest grid (grid of EQ)
+  * ---------------------------------------------------------------------
+**/
+
+    int
+        i,
+        l,
+        L,
+        m,
+        step,
+        Nsteps,
+        periodic;
+
+    double
+        norm;
+
+    struct GPObservables
+        obs;
+
+    Carray
+        coarse,
+        fine;
+
+    EqDataPkg
+        EQcoarse;
+
+
+
+    // Number of levels below the grid of EQ
+    m = EQ->Mpos - 1;
+    L = 0;
+    while (L < levels && m % 2 == 0 && m / 2 >= NESTED_MIN_M)
+    {
+        m = m / 2;
+        L = L + 1;
+    }
+
+    if (L == 0) return ISSmethod(EQ, N, dT, cyclic, S, E, method);
+
+    // FFT methods are always periodic
+    periodic = cyclic || method == 2 || method == 5;
+
+    // The integrators keep the norm of the initial condition which is
+    // changed by the interpolation, thus it is restored in each level
+    Observables(EQ->Mpos, EQ->dx, EQ->a2, EQ->a1, EQ->inter, EQ->V, S,
+                OBS_NORM, &obs);
+    norm = sqrt(obs.norm);
+
+
+
+    // Initial condition at the coarsest grid by injection
+    step = (EQ->Mpos - 1) / m;
+    coarse = carrDef(m + 1);
+    for (i = 0; i < m + 1; i++) coarse[i] = S[i * step];
+
+
+
+    for (l = L; l > 0; l--)
+    {
+        EQcoarse = PackEqData(m + 1, EQ->xi, EQ->xf, EQ->a2, EQ->inter,
+                   EQ->a1, EQ->Vname, EQ->p);
+
+        Observables(m + 1, EQcoarse->dx, EQ->a2, EQ->a1, EQ->inter,
+                    EQcoarse->V, coarse, OBS_NORM, &obs);
+        carrScalarMultiply(m + 1, coarse, norm / sqrt(obs.norm), coarse);
+
+        printf("\n\nNested grid level %d of %d with %d points", L - l + 1,
+               L + 1, m + 1);
+
+        Nsteps = ISSmethod(EQcoarse, N, dT, cyclic, coarse, E, method);
+
+        printf("\nLevel %d done after %d time-steps\n", L - l + 1, Nsteps);
+
+        ReleaseEqDataPkg(EQcoarse);
+
+        // Prolong to the next grid, that is S at the last level
+        if (l > 1) fine = carrDef(2 * m + 1);
+        else       fine = S;
+
+        carrProlong(m + 1, coarse, periodic, fine);
+
+        free(coarse);
+        coarse = fine;
+        m = 2 * m;
+    }
+
+
+
+    Observables(EQ->Mpos, EQ->dx, EQ->a2, EQ->a1, EQ->inter, EQ->V, S,
+                OBS_NORM, &obs);
+    carrScalarMultiply(EQ->Mpos, S, norm / sqrt(obs.norm), S);
+
+    printf("\n\nNested grid level %d of %d with %d points", L + 1, L + 1,
+           EQ->Mpos);
+
+    return ISSmethod(EQ, N, dT, cyclic, S, E, method);
 }
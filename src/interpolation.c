@@ -1,75 +1,594 @@
 #include "interpolation.h"
 
+
+
+/*          ***********************************************
+
+                     LOCATION OF POINTS IN THE GRID
+
+            ***********************************************          */
+
+
+
+static int uniformGrid(int n, double xs[])
+{
+
+/** Return 1 if the grid points are equally spaced up to roundoff **/
+
+    int
+        i;
+
+    double
+        h;
+
+    h = (xs[n-1] - xs[0]) / (n - 1);
+
+    for (i = 1; i < n; i++)
+    {
+        if (fabs(xs[i] - xs[0] - i * h) > 1E-10 * fabs(h) * n) return 0;
+    }
+
+    return 1;
+}
+
+
+
+static int locate(int n, double xs[], int uniform, double x)
+{
+
+/** Index i of the interval xs[i] <= x <= xs[i+1] with 0 <= i <= n - 2.
+  * Direct in uniform grids and by bisection otherwise **/
+
+    int
+        i,
+        lo,
+        hi;
+
+    if (uniform)
+    {
+        i = (int) ((x - xs[0]) / (xs[1] - xs[0]));
+    }
+    else
+    {
+        lo = 0;
+        hi = n - 1;
+        while (hi - lo > 1)
+        {
+            i = (lo + hi) / 2;
+            if (x < xs[i]) hi = i;
+            else           lo = i;
+        }
+        i = lo;
+    }
+
+    if (i < 0)     i = 0;
+    if (i > n - 2) i = n - 2;
+
+    return i;
+}
+
+
+
+static void checkDomain(int n, double xs[], int nx, double x[])
+{
+
+    int
+        j;
+
+    for (j = 0; j < nx; j++)
+    {
+        if (x[j] < xs[0] || x[j] > xs[n-1])
+        {
+            printf("\n\n\t\tERROR : Invalid point to interpolate detected ! ");
+            printf("x = %.2lf out of data domain [%.2lf, %.2lf]",
+                   x[j], xs[0], xs[n-1]);
+            printf("\n\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+
+
+/*          ***********************************************
+
+                   BARYCENTRIC LAGRANGE INTERPOLATION
+
+            ***********************************************          */
+
+
+
+static Rarray baryWeights(int n, int chunk, double xs[], int uniform)
+{
+
+/** Barycentric weights of the stencils of 'chunk' consecutive points. In
+  * uniform grids they are the same (up to a factor that cancel out)  for
+  * all stencils, and then only 'chunk' weights are returned. Otherwise
+  * the weights of the stencil starting at point s are w[s * chunk + k] **/
+
+    int
+        s,
+        k,
+        l,
+        nst;
+
+    double
+        prod;
+
+    Rarray
+        w;
+
+    if (uniform)
+    {
+        // w[k] = (-1)^k binomial(chunk - 1, k)
+        w = rarrDef(chunk);
+        w[0] = 1;
+        for (k = 1; k < chunk; k++)
+        {
+            w[k] = - w[k-1] * (chunk - k) / k;
+        }
+        return w;
+    }
+
+    nst = n - chunk + 1;
+    w = rarrDef(nst * chunk);
+
+    #pragma omp parallel for private(s, k, l, prod) if (ompWorthy(nst))
+    for (s = 0; s < nst; s++)
+    {
+        for (k = 0; k < chunk; k++)
+        {
+            prod = 1;
+            for (l = 0; l < chunk; l++)
+            {
+                if (l != k) prod = prod * (xs[s + k] - xs[s + l]);
+            }
+            w[s * chunk + k] = 1.0 / prod;
+        }
+    }
+
+    return w;
+}
+
+
+
+static void baryInterp(int n, int chunk, double xs[], int dim, double ys[],
+            int nx, double x[], double y[])
+{
+
+/** Interpolation of 'dim' interleaved real functions (dim = 2 for complex
+  * numbers) with the barycentric formula, that cost O(chunk) per point.
+  * The stencil is centered in the interval of each point and shifted to
+  * stay inside the grid near the boundaries **/
+
+    int
+        i,
+        j,
+        k,
+        d,
+        s,
+        uniform;
+
+    double
+        t,
+        dx,
+        den,
+        num[2];
+
+    Rarray
+        w,
+        ws;
+
+    if (chunk > n) chunk = n;
+    if (chunk < 2) chunk = 2;
+
+    checkDomain(n, xs, nx, x);
+
+    uniform = uniformGrid(n, xs);
+    w = baryWeights(n, chunk, xs, uniform);
+
+    #pragma omp parallel for private(i, j, k, d, s, t, dx, den, num, ws) \
+            if (ompWorthy(nx))
+    for (j = 0; j < nx; j++)
+    {
+        i = locate(n, xs, uniform, x[j]);
+
+        s = i + 1 - chunk / 2;
+        if (s < 0)         s = 0;
+        if (s > n - chunk) s = n - chunk;
+
+        if (uniform) ws = w;
+        else         ws = w + s * chunk;
+
+        den = 0;
+        for (d = 0; d < dim; d++) num[d] = 0;
+
+        for (k = 0; k < chunk; k++)
+        {
+            dx = x[j] - xs[s + k];
+            if (dx == 0) break;
+            t = ws[k] / dx;
+            den = den + t;
+            for (d = 0; d < dim; d++) num[d] = num[d] + t * ys[(s+k)*dim + d];
+        }
+
+        if (k < chunk)
+        {
+            // grid point hit exactly
+            for (d = 0; d < dim; d++) y[j * dim + d] = ys[(s + k) * dim + d];
+        }
+        else
+        {
+            for (d = 0; d < dim; d++) y[j * dim + d] = num[d] / den;
+        }
+    }
+
+    free(w);
+}
+
+
+
 void lagrange(int n, int chunk, double xs[], double ys[], int nx,
      double x[], double y [])
 {
 
 /** Given a set of data points (xs[i],ys[i]) with i = 0 .. n - 1, compute the
   * interpolation funcion using chunks of fixed size evaluated at points x[j]
-  * with j = 0 .. nx - 1, constrained to x[0] > xs[0] and x[nx-1] < xs[n-1].
+  * with j = 0 .. nx - 1, constrained to xs[0] <= x[j] <= xs[n-1].
   *
   * Output Parameter : y[j] = f_pol(x[j])
   * -------------------------------------------------------------------------
 **/
 
+    baryInterp(n, chunk, xs, 1, ys, nx, x, y);
+}
+
+
+
+void carrLagrange(int n, int chunk, double xs[], Carray ys, int nx,
+     double x[], Carray y)
+{
+
+/** Same as lagrange for complex data as a wave function **/
+
+    baryInterp(n, chunk, xs, 2, (double *) ys, nx, x, (double *) y);
+}
+
+
+
+/*          ***********************************************
+
+                        CUBIC SPLINE INTERPOLATION
+
+            ***********************************************          */
+
+
+
+static void splineInterp(int n, double xs[], int dim, double ys[], int nx,
+            double x[], double y[])
+{
+
+/** Natural cubic spline of 'dim' interleaved real functions. The second
+  * derivatives at grid points are the solution of a tridiagonal system,
+  * factorized once and solved for all the functions together **/
+
     int
         i,
         j,
-        k,
-        l;
+        d,
+        m,
+        uniform;
 
     double
-        prod,
-        sum;
+        a,
+        b,
+        h;
 
+    Rarray
+        upper,
+        lower,
+        mid,
+        rhs,
+        ypp;
 
+    RTriFactMat
+        F;
 
-    if (x[nx-1] > xs[n-1])
+    if (n < 2)
     {
-        printf("\n\n\t\tERROR : Invalid point to interpolate detected ! ");
-        printf("x = %.2lf exceeded data domain limit %.2lf",x[nx-1],xs[n-1]);
-        printf("\n\n");
+        printf("\n\n\t\tERROR : At least 2 points are needed in spline\n\n");
         exit(EXIT_FAILURE);
     }
 
+    checkDomain(n, xs, nx, x);
 
+    uniform = uniformGrid(n, xs);
 
-    i = 0;
+    // Second derivatives, zero at the boundaries (natural spline)
+    ypp = rarrDef(n * dim);
+    rarrFill(n * dim, 0, ypp);
 
-    for (j = 0; j < nx; j ++)
+    m = n - 2; // interior points
+    if (m > 0)
     {
+        upper = rarrDef(m);
+        lower = rarrDef(m);
+        mid = rarrDef(m);
+        rhs = rarrDef(m * dim);
 
-        while (x[j] > xs[i]) i = i + 1;
-
-        if (i > n - chunk / 2)
+        for (i = 1; i < n - 1; i++)
         {
-            printf("\n\nWARNING : Initial chunk resized to do not get");
-            printf(" segmentation fault in Interpolation.\n\n");
-            chunk = (n - i) * 2;
+            mid[i-1] = 2 * (xs[i+1] - xs[i-1]);
+            if (i < n - 2) upper[i-1] = xs[i+1] - xs[i];
+            if (i > 1)     lower[i-2] = xs[i] - xs[i-1];
+            for (d = 0; d < dim; d++)
+            {
+                rhs[(i-1)*dim + d] = 6 * (
+                    (ys[(i+1)*dim + d] - ys[i*dim + d]) / (xs[i+1] - xs[i])
+                  - (ys[i*dim + d] - ys[(i-1)*dim + d]) / (xs[i] - xs[i-1]));
+            }
         }
 
-        sum = 0; // sum terms in LaGrange expansion
+        F = rtrifactDef(m);
+        realtriFactor(m, upper, lower, mid, F);
+        realtriFactSolve(F, dim, rhs, ypp + dim);
+        RTriFactFree(F);
 
-// After end while loop we have xs[i] > x[j] then for even 'chunk' the
-// priority is to go backwards using the middle  point  as xs[i]. Then
-// from lagrange formula it is done a displacement,  the initial point
-// x1 becomes x[i - (1 + chunk)/2]
+        free(upper);
+        free(lower);
+        free(mid);
+        free(rhs);
+    }
 
-        for (k = i - (1+chunk)/2; k < i + chunk/2; k++)
+    #pragma omp parallel for private(i, j, d, a, b, h) if (ompWorthy(nx))
+    for (j = 0; j < nx; j++)
+    {
+        i = locate(n, xs, uniform, x[j]);
+        h = xs[i+1] - xs[i];
+        a = (xs[i+1] - x[j]) / h;
+        b = 1 - a;
+        for (d = 0; d < dim; d++)
         {
+            y[j*dim + d] = a * ys[i*dim + d] + b * ys[(i+1)*dim + d]
+                + ((a * a * a - a) * ypp[i*dim + d]
+                +  (b * b * b - b) * ypp[(i+1)*dim + d]) * h * h / 6;
+        }
+    }
 
-            prod = 1;
+    free(ypp);
+}
 
-            for (l = i - (1+chunk)/2; l < i + chunk/2; l++)
-            {
-                if (l == k) continue;
-                prod = prod * (x[j] - xs[l]) / (xs[k] - xs[l]);
-            }
 
-            sum = sum + prod * ys[k];
+
+void spline(int n, double xs[], double ys[], int nx, double x[], double y[])
+{
+
+/** Natural cubic spline through (xs[i],ys[i]) with i = 0 .. n - 1 evaluated
+  * at points x[j] with j = 0 .. nx - 1, constrained as in lagrange.
+  *
+  * Output Parameter : y[j] = f_spline(x[j])
+  * -------------------------------------------------------------------------
+**/
+
+    splineInterp(n, xs, 1, ys, nx, x, y);
+}
+
+
+
+void carrSpline(int n, double xs[], Carray ys, int nx, double x[], Carray y)
+{
+
+/** Same as spline for complex data as a wave function **/
+
+    splineInterp(n, xs, 2, (double *) ys, nx, x, (double *) y);
+}
+
+
+
+void carrProlong(int n, Carray coarse, int cyclic, Carray fine)
+{
+
+/** Prolong a function given in n grid points to the nested grid of 2n - 1
+  * points with half the spacing. The coarse grid points are copied and at
+  * each midpoint the 4th order Lagrange polynomial with two neighbours  in
+  * each side is used. For periodic functions (cyclic > 0), for which the
+  * last point repeat the first, the stencil wrap around the boundary, and
+  * otherwise it is shifted to stay inside the grid near the boundaries.
+  *
+  * Output Parameter : fine[2k] = coarse[k] with k = 0 .. n - 1
+  * -------------------------------------------------------------------------
+**/
+
+    int
+        k,
+        km,
+        kp;
+
+    if (n < 4)
+    {
+        printf("\n\n\t\tERROR : At least 4 points are needed to prolong ");
+        printf("but %d were given\n\n", n);
+        exit(EXIT_FAILURE);
+    }
+
+    #pragma omp parallel for private(k, km, kp) if (ompWorthy(n))
+    for (k = 0; k < n - 1; k++)
+    {
+        fine[2 * k] = coarse[k];
+
+        km = k - 1;
+        kp = k + 2;
+
+        if (cyclic)
+        {
+            // coarse[n-1] = coarse[0] hence the period is n - 1
+            if (km < 0)      km = n - 2;
+            if (kp > n - 1)  kp = 1;
+        }
+        else if (km < 0)
+        {
+            fine[1] = (5 * coarse[0] + 15 * coarse[1] - 5 * coarse[2]
+                    + coarse[3]) / 16;
+            continue;
+        }
+        else if (kp > n - 1)
+        {
+            fine[2 * k + 1] = (coarse[n-4] - 5 * coarse[n-3]
+                    + 15 * coarse[n-2] + 5 * coarse[n-1]) / 16;
+            continue;
         }
 
-        y[j] = sum;
+        fine[2 * k + 1] = (9 * (coarse[k] + coarse[k + 1])
+                - coarse[km] - coarse[kp]) / 16;
+    }
+
+    fine[2 * (n - 1)] = coarse[n - 1];
+}
+
+
+
+
+/*          ***********************************************
+
+                       SPECTRAL GRID RESAMPLING
+
+            ***********************************************          */
+
+
+
+void carrResample(int n, Carray from, int m, Carray to)
+{
+
+/** Resample a periodic function given in n grid points, where the last
+  * repeat the first, to m grid points of the same box. The  Fourier
+  * modes of the n - 1 distinct points are zero padded (m > n) or
+  * truncated (m < n) to m - 1 modes, with the Nyquist mode of an even
+  * size split/folded between the positive and negative frequencies. At
+  * the end the norm (trapezium rule) is restored to its initial value
+  *
+  * Output Parameter : to (size m)
+  * -------------------------------------------------------------------------
+**/
+
+    int
+        k,
+        N,
+        K,
+        nk;
+
+    MKL_LONG
+        s;
+
+    double
+        norm_from,
+        norm_to;
+
+    Carray
+        X,
+        Y;
+
+    DFTI_DESCRIPTOR_HANDLE
+        desc;
+
+    N = n - 1;  // number of modes given
+    K = m - 1;  // number of modes required
+
+    X = carrDef(N);
+    Y = carrDef(K);
+
+    carrCopy(N, from, X);
+    carrFill(K, 0, Y);
+
+    s = DftiCreateDescriptor(&desc, DFTI_DOUBLE, DFTI_COMPLEX, 1, N);
+    s = DftiCommitDescriptor(desc);
+    s = DftiComputeForward(desc, X);
+    s = DftiFreeDescriptor(&desc);
+
+    // number of modes with |k| < min(N, K) / 2 in each side
+    if (N < K) nk = (N - 1) / 2;
+    else       nk = (K - 1) / 2;
+
+    Y[0] = X[0];
+    for (k = 1; k <= nk; k++)
+    {
+        Y[k] = X[k];
+        Y[K - k] = X[N - k];
+    }
+
+    if (N < K && N % 2 == 0)
+    {
+        // Nyquist mode of the coarse grid is split
+        Y[N / 2] = 0.5 * X[N / 2];
+        Y[K - N / 2] = 0.5 * X[N / 2];
+    }
+
+    if (K < N && K % 2 == 0)
+    {
+        // both frequencies are the Nyquist mode of the new grid
+        Y[K / 2] = X[K / 2] + X[N - K / 2];
+    }
 
+    if (K == N && N % 2 == 0) Y[N / 2] = X[N / 2];
+
+    s = DftiCreateDescriptor(&desc, DFTI_DOUBLE, DFTI_COMPLEX, 1, K);
+    s = DftiSetValue(desc, DFTI_BACKWARD_SCALE, 1.0 / N);
+    s = DftiCommitDescriptor(desc);
+    s = DftiComputeBackward(desc, Y);
+    s = DftiFreeDescriptor(&desc);
+
+    // The spacing is proportional to 1 / (number of modes)
+    norm_from = carrMod2(N, from) / N;
+    norm_to = carrMod2(K, Y) / K;
+
+    if (norm_to > 0)
+    {
+        carrScalarMultiply(K, Y, sqrt(norm_from / norm_to), to);
     }
+    else
+    {
+        carrCopy(K, Y, to);
+    }
+    to[K] = to[0];
+
+    free(X);
+    free(Y);
+}
+
+
+
+void carrResampleSine(int n, Carray from, int m, Carray to)
+{
+
+/** Resample a function that vanishes at the hard walls of the box, first
+  * and last grid points, from n to m grid points.  The sine series is the
+  * Fourier series of the odd extension to twice the box, thus the  odd
+  * extension is resampled with carrResample, which keep the symmetry **/
+
+    int
+        j;
+
+    Carray
+        ext_from,
+        ext_to;
+
+    ext_from = carrDef(2 * n - 1);
+    ext_to = carrDef(2 * m - 1);
+
+    ext_from[0] = 0;
+    ext_from[n - 1] = 0;
+    for (j = 1; j < n - 1; j++)
+    {
+        ext_from[j] = from[j];
+        ext_from[2 * (n - 1) - j] = - from[j];
+    }
+    ext_from[2 * (n - 1)] = 0;
+
+    carrResample(2 * n - 1, ext_from, 2 * m - 1, ext_to);
+
+    carrCopy(m, ext_to, to);
+    to[0] = 0;
+    to[m - 1] = 0;
+
+    free(ext_from);
+    free(ext_to);
 }
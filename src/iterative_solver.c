@@ -2,60 +2,514 @@
 
 
 
+/*          ***********************************************
 
+                 FUSED KERNELS OF CONJUGATE-GRADIENT
 
-int CCG(int n, CCSmat A, Carray b, Carray x, double eps, int maxiter,
-        Carray upper, Carray lower, Carray mid)
+            ***********************************************          */
+
+
+
+/* Each kernel below does in a single sweep over the arrays what would
+ * require two or more calls to array_operations. Besides the matrix-
+ * vector multiplication and the preconditioner a CG iteration takes
+ * three sweeps: update of solution/residue, the product <r, z>  after
+ * the preconditioner (a callback, thus not fused) and the update  of
+ * direction. The pipelined version merges its products in one sweep */
+
+
+
+static double complex ccsvecDot(int n, CCSmat A, Carray d, Carray Ad)
 {
 
+/** Ad = A . d and return the scalar product <d, Ad> **/
+
+    int
+        i,
+        l,
+        m;
+
+    double
+        re = 0,
+        im = 0;
+
     double complex
-        a,
-        beta;
+        z;
+
+    m = A->m;
+
+    #pragma omp parallel for private(i, l, z) reduction(+:re, im) \
+            if (ompWorthy(n * m))
+    for (i = 0; i < n; i++)
+    {
+        z = A->vec[i] * d[A->col[i]];
+        for (l = 1; l < m; l++) z = z + A->vec[i + l*n] * d[A->col[i + l*n]];
+        Ad[i] = z;
+        re = re + creal(d[i]) * creal(z) + cimag(d[i]) * cimag(z);
+        im = im + creal(d[i]) * cimag(z) - cimag(d[i]) * creal(z);
+    }
+
+    return re + I * im;
+}
+
+
+
+static double ccgUpdate(int n, double complex a, Carray d, Carray Ad,
+       Carray x, Carray r)
+{
+
+/** x = x + a d  ,  r = r - a Ad  and return the residue squared norm **/
+
+    int
+        i;
+
+    double
+        mod = 0;
+
+    #pragma omp parallel for private(i) reduction(+:mod) if (ompWorthy(n))
+    for (i = 0; i < n; i++)
+    {
+        x[i] = x[i] + a * d[i];
+        r[i] = r[i] - a * Ad[i];
+        mod = mod + creal(r[i]) * creal(r[i]) + cimag(r[i]) * cimag(r[i]);
+    }
+
+    return mod;
+}
+
+
+
+static double rccsvecDot(int n, Rarray d, Rarray Ad, void * data)
+{
+
+/** Ad = A . d and return the scalar product <d, Ad>. Operator form of a
+  * RCCSmat (see RLinearOp) used by RCGsolve and RCGpipe **/
+
+    int
+        i,
+        l,
+        m;
+
+    double
+        x,
+        dot = 0;
+
+    RCCSmat
+        A = (RCCSmat) data;
+
+    m = A->m;
+
+    #pragma omp parallel for private(i, l, x) reduction(+:dot) \
+            if (ompWorthy(n * m))
+    for (i = 0; i < n; i++)
+    {
+        x = A->vec[i] * d[A->col[i]];
+        for (l = 1; l < m; l++) x = x + A->vec[i + l*n] * d[A->col[i + l*n]];
+        Ad[i] = x;
+        dot = dot + d[i] * x;
+    }
+
+    return dot;
+}
+
+
+
+static double rcgUpdate(int n, double a, Rarray d, Rarray Ad, Rarray x,
+       Rarray r)
+{
+
+/** x = x + a d  ,  r = r - a Ad  and return the residue squared norm **/
+
+    int
+        i;
+
+    double
+        mod = 0;
+
+    #pragma omp parallel for private(i) reduction(+:mod) if (ompWorthy(n))
+    for (i = 0; i < n; i++)
+    {
+        x[i] = x[i] + a * d[i];
+        r[i] = r[i] - a * Ad[i];
+        mod = mod + r[i] * r[i];
+    }
+
+    return mod;
+}
+
+
+
+/*          ***********************************************
+
+                  TRIDIAGONAL PRECONDITIONER (COMPLEX)
+
+            ***********************************************          */
+
+
+
+static void cprecFactor(CCGwork W, Carray upper, Carray lower, Carray mid)
+{
+
+/** Store the factors of the tridiagonal preconditioner in the workspace
+  * to avoid the divisions and allocations of triDiag in each iteration.
+  * If mid[0] = 0 the factors are not used (see cprecSolve) **/
+
+    int
+        i;
+
+    if (cabs(mid[0]) == 0) return;
+
+    W->uinv[0] = 1.0 / mid[0];
+    for (i = 1; i < W->n; i++)
+    {
+        W->l[i-1] = lower[i-1] * W->uinv[i-1];
+        W->uinv[i] = 1.0 / (mid[i] - W->l[i-1] * upper[i-1]);
+    }
+}
+
+
+
+static void cprecSolve(CCGwork W, Carray upper, Carray lower, Carray mid,
+       Carray r, Carray z)
+{
+
+/** Apply the preconditioner z = M^-1 r with the factors of cprecFactor **/
+
+    int
+        i,
+        n;
+
+    n = W->n;
+
+    if (cabs(mid[0]) == 0)
+    {
+        triDiag(n, upper, lower, mid, r, z);
+        return;
+    }
+
+    z[0] = r[0];
+    for (i = 1; i < n; i++) z[i] = r[i] - W->l[i-1] * z[i-1];
+
+    z[n-1] = z[n-1] * W->uinv[n-1];
+    for (i = n - 2; i >= 0; i--)
+    {
+        z[i] = (z[i] - upper[i] * z[i+1]) * W->uinv[i];
+    }
+}
+
+
+
+/*          ***********************************************
+
+                     PRECONDITIONERS (REAL SYSTEMS)
+
+            ***********************************************          */
+
+
+
+/* Functions of type RPrecond (see iterative_solver.h) that apply z = P r
+ * with a factorization computed beforehand, and the routines to set up
+ * the ones that are not in tridiagonal_solver                        */
+
+
+
+void precTri(int n, Rarray r, Rarray z, void * data)
+{
+    realtriFactSolve((RTriFactMat) data, 1, r, z);
+}
+
+
+
+// Diagonals of the tridiagonal preconditioner when it is not factorized
+struct RTriDiagonals
+{
+    Rarray upper;
+    Rarray lower;
+    Rarray mid;
+};
+
+
+
+static void precTriReduced(int n, Rarray r, Rarray z, void * data)
+{
+
+/** Preconditioner applied by realtri, that handles mid[0] = 0 with the
+  * system reduction, as cprecSolve does in the complex case **/
+
+    struct RTriDiagonals
+        * T = (struct RTriDiagonals *) data;
+
+    realtri(n, T->upper, T->lower, T->mid, r, z);
+}
+
+
+
+void precBlockTri(int n, Rarray r, Rarray z, void * data)
+{
+    rblocktriSolve((RBlockTriFactMat) data, r, z);
+}
+
+
+
+void rilu0Factor(int n, RCCSmat A, RILUmat F)
+{
+
+/** Incomplete LU factorization with the sparsity pattern of A. The rows
+  * are first copied with the columns in increasing order,  then  the
+  * elimination (IKJ variant) updates only the positions present in A.
+  * The columns in a same row of A must be distinct **/
+
+    int
+        i,
+        k,
+        l,
+        p,
+        q,
+        t,
+        m,
+        c,
+        * col;
+
+    double
+        x;
+
+    Rarray
+        vec;
+
+    m = A->m;
+    col = F->col;
+    vec = F->vec;
+
+    for (i = 0; i < n; i++)
+    {
+        // insertion sort of the row by column index
+        for (l = 0; l < m; l++)
+        {
+            c = A->col[i + l*n];
+            x = A->vec[i + l*n];
+            for (p = i*m + l; p > i*m && col[p-1] > c; p--)
+            {
+                col[p] = col[p-1];
+                vec[p] = vec[p-1];
+            }
+            col[p] = c;
+            vec[p] = x;
+        }
+
+        F->diag[i] = -1;
+        for (p = i*m; p < (i+1)*m; p++) if (col[p] == i) F->diag[i] = p;
+
+        if (F->diag[i] < 0)
+        {
+            printf("\n\n\tERROR : no diagonal element in row %d ", i);
+            printf("for ILU(0) factorization\n\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    for (i = 0; i < n; i++)
+    {
+        for (p = i*m; p < F->diag[i]; p++)
+        {
+            k = col[p];
+            vec[p] = vec[p] / vec[F->diag[k]];
+            for (q = p + 1; q < (i+1)*m; q++)
+            {
+                // search column of q in row k (after the diagonal)
+                for (t = F->diag[k] + 1; t < (k+1)*m; t++)
+                {
+                    if (col[t] >= col[q]) break;
+                }
+                if (t < (k+1)*m && col[t] == col[q])
+                {
+                    vec[q] = vec[q] - vec[p] * vec[t];
+                }
+            }
+        }
+
+        if (vec[F->diag[i]] == 0)
+        {
+            printf("\n\n\tERROR : zero pivot in row %d ", i);
+            printf("of ILU(0) factorization\n\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+
+
+void precILU0(int n, Rarray r, Rarray z, void * data)
+{
+
+/** Forward substitution with L (unit diagonal) and backward with U **/
+
+    int
+        i,
+        p,
+        m;
+
+    double
+        y;
+
+    RILUmat
+        F = (RILUmat) data;
+
+    m = F->m;
+
+    for (i = 0; i < n; i++)
+    {
+        y = r[i];
+        for (p = i*m; p < F->diag[i]; p++) y = y - F->vec[p] * z[F->col[p]];
+        z[i] = y;
+    }
+
+    for (i = n - 1; i >= 0; i--)
+    {
+        y = z[i];
+        for (p = F->diag[i] + 1; p < (i+1)*m; p++)
+        {
+            y = y - F->vec[p] * z[F->col[p]];
+        }
+        z[i] = y / F->vec[F->diag[i]];
+    }
+}
+
+
+
+void rspecprecSetup(RSpecPrecMat P, double offd, double diag, double ddx)
+{
+
+/** Symbol of the periodic stencil on a complex field f = re + i im
+  *
+  *     offd (f[j-1] + f[j+1]) + diag f[j] + i ddx (f[j+1] - f[j-1])
+  *
+  * that in the Fourier mode k with angle t = 2 pi k / n is given by
+  * diag + 2 offd cos(t) - 2 ddx sin(t). Modes with (nearly) zero symbol
+  * are dropped. The FFT normalization 1 / n is included in sinv **/
+
+    int
+        k,
+        n;
+
+    double
+        t,
+        symb,
+        tiny;
+
+    n = P->n;
+    tiny = 1E-12 * (fabs(diag) + 2 * fabs(offd) + 2 * fabs(ddx));
+
+    for (k = 0; k < n; k++)
+    {
+        t = 2 * PI * k / n;
+        symb = diag + 2 * offd * cos(t) - 2 * ddx * sin(t);
+        if (fabs(symb) > tiny) P->sinv[k] = 1.0 / (n * symb);
+        else                   P->sinv[k] = 0;
+    }
+}
+
+
+
+void precSpectral(int n, Rarray r, Rarray z, void * data)
+{
+
+/** Apply the inverse symbol of rspecprecSetup to r = (re, im) given in
+  * real form (n = 2 P->n) with one forward and one backward FFT **/
+
+    int
+        j,
+        m;
+
+    MKL_LONG
+        s;
+
+    RSpecPrecMat
+        P = (RSpecPrecMat) data;
+
+    m = P->n;
+
+    for (j = 0; j < m; j++) P->work[j] = r[j] + I * r[j + m];
+
+    s = DftiComputeForward(P->desc, P->work);
+    for (j = 0; j < m; j++) P->work[j] = P->sinv[j] * P->work[j];
+    s = DftiComputeBackward(P->desc, P->work);
+
+    for (j = 0; j < m; j++)
+    {
+        z[j] = creal(P->work[j]);
+        z[j + m] = cimag(P->work[j]);
+    }
+}
+
+
+
+/*          ***********************************************
+
+                        CONJUGATE-GRADIENT
+
+            ***********************************************          */
+
+
+
+int CCGsolve(CCGwork W, CCSmat A, Carray b, Carray x, double eps,
+    int maxiter, Carray upper, Carray lower, Carray mid)
+{
+
+/** Preconditioned Conjugate-Gradient with the vectors from workspace W.
+  * Each iteration does one matrix-vector multiplication, fused with the
+  * scalar product of the direction, one sweep to update the solution and
+  * residue, the preconditioner solve and one sweep to update direction.
+  * No vector is copied and no memory is allocated in the iterations. **/
 
     int
-        l; // Interation counter - return for convergence statistics
+        n,
+        l; // Iteration counter - return for convergence statistics
+
+    double
+        res2;
+
+    double complex
+        a,
+        rz,
+        rz_new;
 
     Carray
         r,
         d,
-        aux,
-        prev_x,
-        prev_r,
-        M_r;
-
+        Ad,
+        z;
 
+    n = W->n;
+    r = W->r;
+    d = W->d;
+    Ad = W->Ad;
+    z = W->z;
 
     l = 0;
 
-    r = carrDef(n);      // residue
-    d = carrDef(n);      // Direction
-    aux = carrDef(n);    // to store some algebra
-    prev_x = carrDef(n);
-    prev_r = carrDef(n); // to compute scalars need 2 residues
-    M_r = carrDef(n);    // Pre-conditioner applied to residue
-
-    CCSvec(n, A->vec, A->col, A->m, x, aux);
-    carrSub(n, b, aux, r);
-    triDiag(n, upper, lower, mid, r, d);
-    carrCopy(n, d, M_r);
-    
-    while (carrMod(n, r) > eps)
-    {
-        CCSvec(n, A->vec, A->col, A->m, d, aux); // matrix-vector mult
-        a = carrDot(n, r, M_r) / carrDot(n, d, aux);
-        // Update residue
-        carrCopy(n, r, prev_r);
-        carrUpdate(n, prev_r, (-1) * a, aux, r);
-        // Update solution
-        carrCopy(n, x, prev_x);
-        carrUpdate(n, prev_x, a, d, x);
-        carrCopy(n, M_r, aux);                  // aux get M-1 . r
-        triDiag(n, upper, lower, mid, r, M_r);  // Store for the next loop
-        beta = carrDot(n, r, M_r) / carrDot(n, prev_r, aux);
-        carrScalarMultiply(n, d, beta, aux);
-        carrAdd(n, M_r, aux, d); // Update direction
-
-        l = l + 1;               // Update iteration counter
+    cprecFactor(W, upper, lower, mid);
+
+    CCSvec(n, A->vec, A->col, A->m, x, Ad);
+    carrSub(n, b, Ad, r);
+    cprecSolve(W, upper, lower, mid, r, z);
+    carrCopy(n, z, d);
+
+    rz = carrDot(n, r, z);
+    res2 = carrMod2(n, r);
+
+    while (sqrt(res2) > eps)
+    {
+        a = rz / ccsvecDot(n, A, d, Ad);
+        res2 = ccgUpdate(n, a, d, Ad, x, r);
+
+        cprecSolve(W, upper, lower, mid, r, z);
+        rz_new = carrDot(n, r, z);
+
+        // new direction d = z + beta d
+        carrUpdate(n, z, rz_new / rz, d, d);
+        rz = rz_new;
+
+        l = l + 1; // Update iteration counter
 
         if (l == maxiter)
         {
@@ -66,14 +520,6 @@ int CCG(int n, CCSmat A, Carray b, Carray x, double eps, int maxiter,
         }
     }
 
-    // Free function local memory
-    free(r);
-    free(d);
-    free(aux);
-    free(prev_x);
-    free(prev_r);
-    free(M_r);
-
     return l;
 }
 
@@ -81,53 +527,225 @@ int CCG(int n, CCSmat A, Carray b, Carray x, double eps, int maxiter,
 
 
 
-int RCG(int n, RCCSmat A, Rarray b, Rarray x, double eps, int maxiter,
-        Rarray upper, Rarray lower, Rarray mid)
+int RCGprec(RCGwork W, RLinearOp A, void * data, RPrecond P,
+    void * pdata, Rarray b, Rarray x, double eps, int maxiter)
 {
-    
+
+/** Real version of CCGsolve where the matrix is given by the operator A
+  * and the preconditioner by P, applied with the extra arguments  data
+  * and pdata respectively. P must be ready to use (already factorized)
+  * and is applied once per iteration **/
+
+    int
+        n,
+        l; // Iteration counter - return for convergence statistics
+
     double
         a,
-        beta;
-
-    int l = 0; // Interation counter - return for convergence statistics
+        res2,
+        rz,
+        rz_new;
 
     Rarray
         r,
         d,
-        aux,
-        prev_x,
-        prev_r,
-        M_r;
-
-    r = rarrDef(n);      // residue
-    d = rarrDef(n);      // Direction
-    aux = rarrDef(n);    // to store some algebra
-    prev_x = rarrDef(n);
-    prev_r = rarrDef(n); // to compute scalars need 2 residues
-    M_r = rarrDef(n);    // Pre-conditioner applied to residue
-
-    RCCSvec(n, A->vec, A->col, A->m, x, aux);
-    rarrSub(n, b, aux, r);
-    realtri(n, upper, lower, mid, r, d);
-    rarrCopy(n, d, M_r);
-    
-    while (sqrt(rarrDot(n, r, r)) > eps)
-    {
-        RCCSvec(n, A->vec, A->col, A->m, d, aux); // matrix-vector mult
-        a = rarrDot(n, r, M_r) / rarrDot(n, d, aux);
-        // Update residue
-        rarrCopy(n, r, prev_r);
-        rarrUpdate(n, prev_r, (-1) * a, aux, r);
-        // Update solution
-        rarrCopy(n, x, prev_x);
-        rarrUpdate(n, prev_x, a, d, x);
-        rarrCopy(n, M_r, aux);                  // aux get M-1 . r
-        realtri(n, upper, lower, mid, r, M_r); // Store for the next loop
-        beta = rarrDot(n, r, M_r) / rarrDot(n, prev_r, aux);
-        rarrScalarMultiply(n, d, beta, aux);
-        rarrAdd(n, M_r, aux, d); // Update direction
-
-        l = l + 1;               // Update iteration counter
+        Ad,
+        z;
+
+    n = W->n;
+    r = W->r;
+    d = W->d;
+    Ad = W->Ad;
+    z = W->z;
+
+    l = 0;
+
+    A(n, x, Ad, data);
+    rarrSub(n, b, Ad, r);
+    P(n, r, z, pdata);
+    rarrCopy(n, z, d);
+
+    rz = rarrDot(n, r, z);
+    res2 = rarrDot(n, r, r);
+
+    while (sqrt(res2) > eps)
+    {
+        a = rz / A(n, d, Ad, data);
+        res2 = rcgUpdate(n, a, d, Ad, x, r);
+
+        P(n, r, z, pdata);
+        rz_new = rarrDot(n, r, z);
+
+        // new direction d = z + beta d
+        rarrUpdate(n, z, rz_new / rz, d, d);
+        rz = rz_new;
+
+        l = l + 1; // Update iteration counter
+
+        if (l == maxiter)
+        {
+            printf("\n\n\tWARNING : exit before achieve desired residual ");
+            printf("value in Conjugate Gradient method due to max number ");
+            printf("of iterations given =  %d\n\n", maxiter);
+            break;
+        }
+    }
+
+    return l;
+}
+
+
+
+
+
+static void rpipeUpdate(RCGwork W, Rarray x, double a, double beta,
+       double * dots)
+{
+
+/** Single sweep of pipelined CG. Update the recurrences of directions
+  *
+  *     Aq = Am + beta Aq        q = m + beta q
+  *     Ad = w + beta Ad         d = z + beta d
+  *
+  * then the solution and residues
+  *
+  *     x = x + a d    r = r - a Ad    z = z - a q    w = w - a Aq
+  *
+  * and compute the scalar products for the next iteration in the same
+  * loop dots = [ <r, z>  <w, z>  <r, r> ] **/
+
+    int
+        i;
+
+    double
+        rz = 0,
+        wz = 0,
+        rr = 0;
+
+    Rarray
+        r = W->r,
+        d = W->d,
+        Ad = W->Ad,
+        z = W->z,
+        w = W->w,
+        m = W->m,
+        Am = W->Am,
+        q = W->q,
+        Aq = W->Aq;
+
+    #pragma omp parallel for private(i) reduction(+:rz, wz, rr) \
+            if (ompWorthy(W->n))
+    for (i = 0; i < W->n; i++)
+    {
+        Aq[i] = Am[i] + beta * Aq[i];
+        q[i] = m[i] + beta * q[i];
+        Ad[i] = w[i] + beta * Ad[i];
+        d[i] = z[i] + beta * d[i];
+
+        x[i] = x[i] + a * d[i];
+        r[i] = r[i] - a * Ad[i];
+        z[i] = z[i] - a * q[i];
+        w[i] = w[i] - a * Aq[i];
+
+        rz = rz + r[i] * z[i];
+        wz = wz + w[i] * z[i];
+        rr = rr + r[i] * r[i];
+    }
+
+    dots[0] = rz;
+    dots[1] = wz;
+    dots[2] = rr;
+}
+
+
+
+
+
+int RCGpipePrec(RCGwork W, RLinearOp A, void * data, RPrecond P,
+    void * pdata, Rarray b, Rarray x, double eps, int maxiter)
+{
+
+/** Pipelined preconditioned CG of Ghysels and Vanroose, "Hiding global
+  * synchronization latency in the preconditioned Conjugate Gradient
+  * algorithm", Parallel Computing 40 (2014) 224-238.
+  *
+  * The recurrences for A d, M^-1 A d and A M^-1 A d avoid the scalar
+  * products that depend on the matrix-vector multiplication  in  the
+  * same iteration.  All reductions of an iteration are done  in  the
+  * single sweep that update the vectors (see rpipeUpdate), while the
+  * preconditioner and matrix-vector multiplication do not wait for any
+  * reduction.  It costs an extra vector update per iteration compared
+  * to RCGsolve but has a single synchronization point,  what  pays off
+  * for large systems with many threads.  The matrix and preconditioner
+  * are given as in RCGprec (the returned scalar product is unused) **/
+
+    int
+        n,
+        l; // Iteration counter - return for convergence statistics
+
+    double
+        a,
+        a_old,
+        beta,
+        rz,
+        rz_old,
+        wz,
+        dots[3];
+
+    n = W->n;
+
+    if (W->w == NULL)
+    {
+        W->w = rarrDef(n);
+        W->m = rarrDef(n);
+        W->Am = rarrDef(n);
+        W->q = rarrDef(n);
+        W->Aq = rarrDef(n);
+    }
+
+    l = 0;
+    a = 1;
+
+    // the direction recurrences start with zeros
+    rarrFill(n, 0, W->d);
+    rarrFill(n, 0, W->Ad);
+    rarrFill(n, 0, W->q);
+    rarrFill(n, 0, W->Aq);
+
+    A(n, x, W->Ad, data);
+    rarrSub(n, b, W->Ad, W->r);
+    rarrFill(n, 0, W->Ad);
+    P(n, W->r, W->z, pdata);
+    A(n, W->z, W->w, data);
+
+    rz = rarrDot(n, W->r, W->z);
+    wz = rarrDot(n, W->w, W->z);
+    dots[2] = rarrDot(n, W->r, W->r);
+
+    while (sqrt(dots[2]) > eps)
+    {
+        P(n, W->w, W->m, pdata);
+        A(n, W->m, W->Am, data);
+
+        if (l > 0)
+        {
+            beta = rz / rz_old;
+            a = rz / (wz - beta * rz / a_old);
+        }
+        else
+        {
+            beta = 0;
+            a = rz / wz;
+        }
+
+        rz_old = rz;
+        a_old = a;
+
+        rpipeUpdate(W, x, a, beta, dots);
+        rz = dots[0];
+        wz = dots[1];
+
+        l = l + 1; // Update iteration counter
 
         if (l == maxiter)
         {
@@ -138,13 +756,115 @@ int RCG(int n, RCCSmat A, Rarray b, Rarray x, double eps, int maxiter,
         }
     }
 
-    // Free function local memory
-    free(r);
-    free(d);
-    free(aux);
-    free(prev_x);
-    free(prev_r);
-    free(M_r);
+    return l;
+}
+
+
+
+
+
+int RCGop(RCGwork W, RLinearOp A, void * data, Rarray b, Rarray x,
+    double eps, int maxiter, Rarray upper, Rarray lower, Rarray mid)
+{
+
+/** RCGprec with the tridiagonal preconditioner, factorized once per call
+  * (see realtriFactor). If mid[0] = 0 there is no factorization and the
+  * system is solved by realtri in each iteration **/
+
+    struct RTriDiagonals
+        T = {upper, lower, mid};
+
+    if (mid[0] == 0)
+    {
+        return RCGprec(W, A, data, precTriReduced, &T, b, x, eps, maxiter);
+    }
+
+    realtriFactor(W->n, upper, lower, mid, W->P);
+    return RCGprec(W, A, data, precTri, W->P, b, x, eps, maxiter);
+}
+
+
+
+
+
+int RCGpipeOp(RCGwork W, RLinearOp A, void * data, Rarray b, Rarray x,
+    double eps, int maxiter, Rarray upper, Rarray lower, Rarray mid)
+{
+    struct RTriDiagonals
+        T = {upper, lower, mid};
+
+    if (mid[0] == 0)
+    {
+        return RCGpipePrec(W, A, data, precTriReduced, &T, b, x, eps,
+                           maxiter);
+    }
+
+    realtriFactor(W->n, upper, lower, mid, W->P);
+    return RCGpipePrec(W, A, data, precTri, W->P, b, x, eps, maxiter);
+}
+
+
+
+
+
+int RCGsolve(RCGwork W, RCCSmat A, Rarray b, Rarray x, double eps,
+    int maxiter, Rarray upper, Rarray lower, Rarray mid)
+{
+    return RCGop(W, rccsvecDot, A, b, x, eps, maxiter, upper, lower, mid);
+}
+
+
+
+
+
+int RCGpipe(RCGwork W, RCCSmat A, Rarray b, Rarray x, double eps,
+    int maxiter, Rarray upper, Rarray lower, Rarray mid)
+{
+    return RCGpipeOp(W, rccsvecDot, A, b, x, eps, maxiter, upper, lower, mid);
+}
+
+
+
+
+
+int CCG(int n, CCSmat A, Carray b, Carray x, double eps, int maxiter,
+        Carray upper, Carray lower, Carray mid)
+{
+
+/** Single solve with a temporary workspace (see CCGsolve) **/
+
+    int
+        l;
+
+    CCGwork
+        W;
+
+    W = ccgworkDef(n);
+    l = CCGsolve(W, A, b, x, eps, maxiter, upper, lower, mid);
+    CCGworkFree(W);
+
+    return l;
+}
+
+
+
+
+
+int RCG(int n, RCCSmat A, Rarray b, Rarray x, double eps, int maxiter,
+        Rarray upper, Rarray lower, Rarray mid)
+{
+
+/** Single solve with a temporary workspace (see RCGsolve) **/
+
+    int
+        l;
+
+    RCGwork
+        W;
+
+    W = rcgworkDef(n);
+    l = RCGsolve(W, A, b, x, eps, maxiter, upper, lower, mid);
+    RCGworkFree(W);
 
     return l;
 }
@@ -44,6 +44,27 @@ void barrier(int M, Rarray x, Rarray V, double height, double T)
 
 
 
+static void barrierAt(int i1, int i2, Rarray x, Rarray V, double height,
+            double T, double center)
+{
+
+/** Add to V[i1 .. i2-1] the barrier of 'barrier' centered at 'center' **/
+
+    int
+        i;
+
+    for (i = i1; i < i2; i++)
+    {
+        if ( fabs(x[i] - center) < T / 2 )
+        {
+            V[i] = V[i] + height * cos((x[i] - center) * PI / T)
+                                 * cos((x[i] - center) * PI / T);
+        }
+    }
+}
+
+
+
 void GetPotential(int M, char name [], Rarray x, Rarray V,
      double p1, double p2, double p3)
 {
@@ -65,6 +86,20 @@ void GetPotential(int M, char name [], Rarray x, Rarray V,
         return;
     }
 
+    if (strcmp(name, "movingbarrier") == 0)
+    {
+        // Initial position of the barrier center in p3
+        rarrFill(M, 0, V);
+        barrierAt(0, M, x, V, p1, p2, p3);
+        return;
+    }
+
+    if (strcmp(name, "rampharmonic") == 0)
+    {
+        harmonic(M, x, V, p1);
+        return;
+    }
+
     if (strcmp(name, "zero") == 0)
     {
         rarrFill(M, 0, V);
@@ -74,3 +109,218 @@ void GetPotential(int M, char name [], Rarray x, Rarray V,
     printf("\n\n\n\nERROR: Potential '%s' not implemented\n\n", name);
     exit(EXIT_FAILURE);
 }
+
+
+
+
+void GetPotentialMD(int dim, int M[], char name[], Rarray x[], Rarray V,
+     double p[])
+{
+
+/** Fill V over the grid of M[0] x M[1] (x M[2]) points. For dim = 2
+  * the values of z are taken as zero **/
+
+    int
+        i,
+        j,
+        k,
+        Mz,
+        ring;
+
+    double
+        r,
+        z,
+        wz;
+
+    if (strcmp(name, "zero") == 0)
+    {
+        rarrFill(M[0] * M[1] * (dim == 3 ? M[2] : 1), 0, V);
+        return;
+    }
+
+    if (strcmp(name, "harmonic") != 0 && strcmp(name, "ring") != 0)
+    {
+        printf("\n\n\n\nERROR: Potential '%s' not implemented", name);
+        printf(" in %d dimensions\n\n", dim);
+        exit(EXIT_FAILURE);
+    }
+
+    ring = (strcmp(name, "ring") == 0);
+
+    Mz = 1;
+    if (dim == 3) Mz = M[2];
+
+    for (k = 0; k < Mz; k++)
+    {
+        wz = 0;
+        if (dim == 3) { z = x[2][k]; wz = p[2] * p[2] * z * z; }
+        for (j = 0; j < M[1]; j++)
+        {
+            for (i = 0; i < M[0]; i++)
+            {
+                if (ring)
+                {
+                    r = sqrt(x[0][i] * x[0][i] + x[1][j] * x[1][j]);
+                    r = p[0] * p[0] * (r - p[1]) * (r - p[1]);
+                }
+                else
+                {
+                    r = p[0] * p[0] * x[0][i] * x[0][i]
+                      + p[1] * p[1] * x[1][j] * x[1][j];
+                }
+                V[(k * M[1] + j) * M[0] + i] = 0.5 * (r + wz);
+            }
+        }
+    }
+}
+
+
+
+
+double rampValue(struct TimeRamp * r, double t)
+{
+    if (r->func != NULL) return r->func(t, r->data);
+    if (t <= r->t1) return r->v1;
+    if (t >= r->t2) return r->v2;
+    return r->v1 + (r->v2 - r->v1) * (t - r->t1) / (r->t2 - r->t1);
+}
+
+
+
+TimePotPkg TimePotentialDef(char name[], double p[], double t1, double t2,
+           double final)
+{
+
+/** Potential 'name' with parameters p at t = 0  whose ramped parameter
+  * reach 'final' at t2. Other names give static potentials **/
+
+    TimePotPkg P = (TimePotPkg) malloc(sizeof(struct TimePotential));
+
+    if (P == NULL)
+    {
+        printf("\n\n\nMEMORY ERROR : malloc fail for TimePotential\n\n");
+        exit(EXIT_FAILURE);
+    }
+
+    strcpy(P->name, name);
+    P->p[0] = p[0];
+    P->p[1] = p[1];
+    P->p[2] = p[2];
+
+    P->ramp.t1 = t1;
+    P->ramp.t2 = t2;
+    P->ramp.func = NULL;
+    P->ramp.data = NULL;
+    P->func = NULL;
+    P->data = NULL;
+
+    if (strcmp(name, "movingbarrier") == 0)     P->ramp.v1 = p[2];
+    else if (strcmp(name, "rampharmonic") == 0) P->ramp.v1 = p[0];
+    else
+    {
+        // static potential
+        P->ramp.v1 = 0;
+        final = 0;
+    }
+
+    P->ramp.v2 = final;
+    P->now = P->ramp.v1;
+
+    return P;
+}
+
+
+
+TimePotPkg TimePotentialUser(TimePotFunc f, void * data)
+{
+
+/** Protocol of the user, f is called in every update with data **/
+
+    double
+        p[3] = {0, 0, 0};
+
+    TimePotPkg P = TimePotentialDef("user", p, 0, 0, 0);
+
+    P->func = f;
+    P->data = data;
+
+    return P;
+}
+
+
+
+void TimePotentialInit(int M, Rarray x, TimePotPkg P, Rarray V)
+{
+
+/** Potential at t = 0 in all points, from the user callback or  from
+  * the static potential with the initial value of the parameter **/
+
+    int
+        first;
+
+    if (P->func != NULL)
+    {
+        P->func(M, x, 0, V, &first, P->data);
+        return;
+    }
+
+    P->now = P->ramp.v1;
+    GetPotential(M, P->name, x, V, P->p[0], P->p[1], P->p[2]);
+    TimePotentialUpdate(M, x, 0, P, V, &first);
+}
+
+
+
+int TimePotentialUpdate(int M, Rarray x, double t, TimePotPkg P, Rarray V,
+    int * first)
+{
+
+/** Set V at time t from the values it has for the current parameter in
+  * P->now.  The moving barrier only changes the region swept  by  the
+  * barrier, whose points are recomputed. In the uniform grid  x  the
+  * region is located directly.
+  *
+  * Return the number of points changed, starting at *first **/
+
+    int
+        i1,
+        i2;
+
+    double
+        val,
+        lo,
+        hi,
+        dx;
+
+    if (P->func != NULL) return P->func(M, x, t, V, first, P->data);
+
+    val = rampValue(&P->ramp, t);
+
+    *first = 0;
+    if (val == P->now) return 0;
+
+    if (strcmp(P->name, "rampharmonic") == 0)
+    {
+        harmonic(M, x, V, val);
+        P->now = val;
+        return M;
+    }
+
+    // Moving barrier: points covered by old or new barrier positions
+    dx = x[1] - x[0];
+    lo = (val < P->now ? val : P->now) - P->p[1] / 2;
+    hi = (val > P->now ? val : P->now) + P->p[1] / 2;
+    i1 = (int) floor((lo - x[0]) / dx);
+    i2 = (int) ceil((hi - x[0]) / dx) + 1;
+    if (i1 < 0) i1 = 0;
+    if (i2 > M) i2 = M;
+
+    P->now = val;
+    if (i2 <= i1) return 0; // barrier outside the domain
+
+    rarrFill(i2 - i1, 0, V + i1);
+    barrierAt(i1, i2, x, V, P->p[0], P->p[1], val);
+
+    *first = i1;
+    return i2 - i1;
+}
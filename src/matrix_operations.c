@@ -74,6 +74,19 @@ void setValueCCS(int n, int i, int j, int col, double complex z, CCSmat M)
 
 
 
+void setValueRCCS(int n, int i, int j, int col, double x, RCCSmat M)
+{
+
+/** Same as setValueCCS for real matrix **/
+
+    M->vec[i + n * j] = x;
+    M->col[i + n * j] = col;
+}
+
+
+
+
+
 CCSmat tri2CCS(int n, Carray upper, Carray lower, Carray mid)
 {
 
@@ -319,7 +332,7 @@ void CCSvec(int n, Carray vals, int * cols, int m, Carray vec, Carray ans)
 
     double complex re;
 
-    #pragma omp parallel for private(l, i, re)
+    #pragma omp parallel for private(l, i, re) if (ompWorthy(n * m))
     for (i = 0; i < n; i++)
     {
         re = vals[i] * vec[cols[i]];
@@ -340,7 +353,7 @@ void RCCSvec(int n, Rarray vals, int * cols, int m, Rarray vec, Rarray ans)
 
     double re;
 
-    #pragma omp parallel for private(l, i, re)
+    #pragma omp parallel for private(l, i, re) if (ompWorthy(n * m))
     for (i = 0; i < n; i++)
     {
         re = vals[i] * vec[cols[i]];
@@ -359,40 +372,30 @@ void RCCSvec(int n, Rarray vals, int * cols, int m, Rarray vec, Rarray ans)
 
 
 
-int HermitianInv(int M, Cmatrix A, Cmatrix A_inv)
+int HermitianFactor(int M, Cmatrix A, HermFactMat F)
 {
 
-/** Use Lapack routine to solve systems of equations with the
-  * right-hand-side being identity matrix  to get the inverse **/
+/** Use Lapack routine to factorize an hermitian matrix  keeping  the
+  * factors to apply the inverse later, without forming it explicitly.
+  * Cholesky is used if F was allocated for positive definite matrix,
+  * otherwise the Bunch-Kaufman decomposition with pivoting is used **/
 
     int i, // counter
-        j, // counter
-        l; // lapack success parameter
-
-    int
-        * ipiv;
+        j; // counter
 
     CMKLarray
-        ArrayForm, // To call zhesv routine use row major layout of Matrix
-        Id;        // Identity matrix in row major layout
-
-
-
-    ipiv = (int *) malloc(M * sizeof(int));
-
-    ArrayForm = CMKLdef(M * M);
-
-    Id = CMKLdef(M * M);
+        ArrayForm; // Lapack routines use row major layout of Matrix
 
+    // F->LU has room only for the size F was allocated
+    if (M != F->n) return -1;
 
+    ArrayForm = F->LU;
 
     for (i = 0; i < M; i++)
     {
         // Setup (L)ower triangular part as a Row-Major-Array to use lapack
         ArrayForm[i * M + i].real = creal(A[i][i]);
         ArrayForm[i * M + i].imag = 0;
-        Id[i * M + i].real = 1;
-        Id[i * M + i].imag = 0;
 
         for (j = 0; j < i; j++)
         {
@@ -401,29 +404,141 @@ int HermitianInv(int M, Cmatrix A, Cmatrix A_inv)
 
             ArrayForm[j * M + i].real = 0; // symbolic values
             ArrayForm[j * M + i].imag = 0; // for upper triangular part
+        }
+    }
+
+    if (F->posdef)
+    {
+        return LAPACKE_zpotrf(LAPACK_ROW_MAJOR, 'L', M, ArrayForm, M);
+    }
+
+    return LAPACKE_zhetrf(LAPACK_ROW_MAJOR, 'L', M, ArrayForm, M, F->ipiv);
+}
+
+
+
+
+
+int HermitianSolve(HermFactMat F, Carray b, Carray x)
+{
+
+/** Solve the system for a single right-hand-side b using factors in F
+  * The double complex has the same memory layout of MKL complex  type
+  * thus the solution is computed in-place in x with no extra memory **/
+
+    int
+        M;
+
+    M = F->n;
+
+    carrCopy(M, b, x);
+
+    if (F->posdef)
+    {
+        return LAPACKE_zpotrs(LAPACK_ROW_MAJOR, 'L', M, 1, F->LU, M,
+               (MKL_Complex16 *) x, 1);
+    }
+
+    return LAPACKE_zhetrs(LAPACK_ROW_MAJOR, 'L', M, 1, F->LU, M, F->ipiv,
+           (MKL_Complex16 *) x, 1);
+}
+
+
+
 
-            Id[i * M + j].real = 0;
-            Id[i * M + j].imag = 0;
 
-            Id[j * M + i].real = 0;
-            Id[j * M + i].imag = 0;
+int HermitianSolveMulti(HermFactMat F, int nrhs, Cmatrix B, Cmatrix X)
+{
+
+/** Solve the system for  nrhs  right-hand-sides given by the columns of
+  * B using the factors in F. All right-hand-sides are passed at once to
+  * lapack, that is more efficient than calling HermitianSolve for each **/
+
+    int i, // counter
+        j, // counter
+        l, // lapack success parameter
+        M;
+
+    CMKLarray
+        ArrayForm; // right-hand-sides in row major layout
+
+    M = F->n;
+
+    ArrayForm = CMKLdef(M * nrhs);
+
+    for (i = 0; i < M; i++)
+    {
+        for (j = 0; j < nrhs; j++)
+        {
+            ArrayForm[i * nrhs + j].real = creal(B[i][j]);
+            ArrayForm[i * nrhs + j].imag = cimag(B[i][j]);
         }
     }
 
-    l = LAPACKE_zhesv(LAPACK_ROW_MAJOR, 'L', M, M, ArrayForm, M, ipiv, Id, M);
+    if (F->posdef)
+    {
+        l = LAPACKE_zpotrs(LAPACK_ROW_MAJOR, 'L', M, nrhs, F->LU, M,
+            ArrayForm, nrhs);
+    }
+    else
+    {
+        l = LAPACKE_zhetrs(LAPACK_ROW_MAJOR, 'L', M, nrhs, F->LU, M,
+            F->ipiv, ArrayForm, nrhs);
+    }
 
     for (i = 0; i < M; i++)
     {
         // Transcript the result back to matrix form
-        for (j = 0; j < M; j++)
+        for (j = 0; j < nrhs; j++)
         {
-            A_inv[i][j] = Id[i * M + j].real + I * Id[i * M + j].imag;
+            X[i][j] = ArrayForm[i * nrhs + j].real
+                    + I * ArrayForm[i * nrhs + j].imag;
         }
     }
 
-    free(ipiv);
-    free(Id);
     free(ArrayForm);
 
     return l;
 }
+
+
+
+
+
+int HermitianInv(int M, Cmatrix A, Cmatrix A_inv)
+{
+
+/** Use the factorization to solve systems of equations with the
+  * right-hand-side being identity matrix  to get  the  inverse **/
+
+    int i, // counter
+        j, // counter
+        l; // lapack success parameter
+
+    HermFactMat
+        F;
+
+    Cmatrix
+        Id;
+
+
+
+    F = hermfactDef(M, 0);
+
+    Id = cmatDef(M, M);
+
+    for (i = 0; i < M; i++)
+    {
+        for (j = 0; j < M; j++) Id[i][j] = 0;
+        Id[i][i] = 1;
+    }
+
+    l = HermitianFactor(M, A, F);
+
+    if (l == 0) l = HermitianSolveMulti(F, M, Id, A_inv);
+
+    cmatFree(M, Id);
+    HermFactFree(F);
+
+    return l;
+}
@@ -0,0 +1,536 @@
+#include "multicomp_integrator.h"
+
+
+
+/*          ***********************************************
+
+                           OBSERVABLES HELPERS
+
+            ***********************************************          */
+
+
+
+static double cmod2(double complex z)
+{
+    return creal(z) * creal(z) + cimag(z) * cimag(z);
+}
+
+
+
+void ObservablesMC(EqDataPkgMC EQ, Carray S, struct GPObservables * obs,
+     Rarray norms)
+{
+
+/** The linear part of each component is given by Observables without
+  * interaction and the densities overlap integrals by Simpson's rule,
+  * the same rule of Observables **/
+
+    int
+        i,
+        c,
+        d,
+        M;
+
+    double
+        w;
+
+    double complex
+        lin;
+
+    Rarray
+        dens;
+
+    struct GPObservables
+        one;
+
+    M = EQ->Mpos;
+
+    dens = rarrDef(M);
+
+    lin = 0;
+    obs->kinetic = 0;
+    obs->trap = 0;
+    obs->inter = 0;
+    obs->norm = 0;
+    obs->r2 = 0;
+
+    for (c = 0; c < EQ->ncomp; c++)
+    {
+        Observables(M, EQ->dx, EQ->a2, EQ->a1, 0, EQ->V, S + c * M,
+                    OBS_ENERGY | OBS_KINETIC | OBS_TRAP | OBS_NORM, &one);
+        lin = lin + one.energy * one.norm;
+        obs->kinetic = obs->kinetic + one.kinetic;
+        obs->trap = obs->trap + one.trap;
+        obs->norm = obs->norm + one.norm;
+        if (norms != NULL) norms[c] = one.norm;
+
+        // pairs (c, d) and (d, c) count once with d < c
+        for (d = 0; d <= c; d++)
+        {
+            if (EQ->g[c][d] == 0) continue;
+            for (i = 0; i < M; i++)
+            {
+                dens[i] = cmod2(S[c * M + i]) * cmod2(S[d * M + i]);
+            }
+            w = EQ->g[c][d];
+            if (d == c) w = w / 2;
+            obs->inter = obs->inter + w * Rsimps(M, dens, EQ->dx);
+        }
+    }
+
+    obs->virial = 2 * obs->trap - 2 * obs->kinetic - obs->inter;
+    obs->energy = (lin + obs->inter) / obs->norm;
+    obs->chem = (lin + 2 * obs->inter) / obs->norm;
+
+    free(dens);
+}
+
+
+
+static void printObservablesMC(EqDataPkgMC EQ, double t, Carray S)
+{
+
+/** Line of screen output with energy and the norm of each component **/
+
+    int
+        c;
+
+    double
+        norms[MAX_COMP];
+
+    struct GPObservables
+        obs;
+
+    ObservablesMC(EQ, S, &obs, norms);
+    printf(" \n  %.4lf          ", t);
+    printf("%15.7E     ", creal(obs.energy));
+    for (c = 0; c < EQ->ncomp; c++) printf("%15.7E", norms[c]);
+}
+
+
+
+static void printHeaderMC(EqDataPkgMC EQ)
+{
+    int
+        c;
+
+    printf("\n\n\n");
+    printf("     time            Energy          ");
+    for (c = 0; c < EQ->ncomp; c++) printf("      Norm %d    ", c + 1);
+    sepline();
+}
+
+
+
+/*          ***********************************************
+
+                         SPLIT-STEP KERNELS
+
+            ***********************************************          */
+
+
+
+static void potentialStepMC(EqDataPkgMC EQ, double complex z, Rarray V,
+            Carray S, Rarray abs2, Rarray pot, Carray expo, Carray out)
+{
+
+/** out_c = exp(z (V + sum_d g_cd |S_d|^2)) S_c for all components,  in
+  * place if out = S, and V may be NULL for the nonlinear part only.
+  * Each thread work in its chunk of the grid, taking first the density
+  * of all components and then the exponential of each one,  with  no
+  * other synchronization. abs2 has ncomp * Mpos and pot and expo Mpos
+  * numbers **/
+
+    int
+        c,
+        d,
+        M,
+        start,
+        len;
+
+    M = EQ->Mpos;
+
+    #pragma omp parallel private(c, d, start, len) if (ompWorthy(M))
+    {
+        ompChunk(M, &start, &len);
+
+        for (d = 0; d < EQ->ncomp; d++)
+        {
+            carrAbs2(len, S + d * M + start, abs2 + d * M + start);
+        }
+
+        for (c = 0; c < EQ->ncomp; c++)
+        {
+            if (V != NULL) rarrCopy(len, V + start, pot + start);
+            else           rarrFill(len, 0, pot + start);
+            for (d = 0; d < EQ->ncomp; d++)
+            {
+                if (EQ->g[c][d] == 0) continue;
+                rarrUpdate(len, pot + start, EQ->g[c][d],
+                           abs2 + d * M + start, pot + start);
+            }
+            rcarrExp(len, z, pot + start, expo + start);
+            carrMultiply(len, expo + start, S + c * M + start,
+                         out + c * M + start);
+        }
+    }
+}
+
+
+
+static void boundaryMC(EqDataPkgMC EQ, int cyclic, Carray S)
+{
+    int
+        c,
+        M;
+
+    M = EQ->Mpos;
+
+    for (c = 0; c < EQ->ncomp; c++)
+    {
+        if (cyclic) S[c * M + M - 1] = S[c * M];
+        else        S[c * M + M - 1] = 0;
+    }
+}
+
+
+
+/*          ***********************************************
+
+                          REAL TIME INTEGRATORS
+
+            ***********************************************          */
+
+
+
+void SSFFTmc(EqDataPkgMC EQ, int N, double dt, Carray S, char fname[], int n)
+{
+
+/** Same steps of SSFFT, for all components at once.  The  transforms
+  * are done in place over the m = Mpos - 1 interior points of each one,
+  * with the boundary points left between them untouched **/
+
+    int
+        i,
+        c,
+        k,
+        M,
+        m,
+        K;
+
+    MKL_LONG
+        s;
+
+    double
+        freq;
+
+    double complex
+        Idt = 0.0 - dt * I;
+
+    DFTI_DESCRIPTOR_HANDLE
+        desc;
+
+    Rarray
+        abs2,
+        pot;
+
+    Carray
+        expo,
+        exp_der,
+        work;
+
+    FILE
+        * out_data;
+
+
+
+    M = EQ->Mpos;
+    m = M - 1;
+    K = EQ->ncomp;
+
+    abs2 = rarrDef(K * M);
+    pot = rarrDef(M);
+    expo = carrDef(M);
+    exp_der = carrDef(K * M);
+    work = carrDef(K * M);
+
+    out_data = fopen(fname, "w");
+
+    if (out_data == NULL)
+    {
+        printf("\n\nERROR: impossible to open file %s\n", fname);
+        exit(EXIT_FAILURE);
+    }
+
+    carr_inline(out_data, K * M, S);
+
+
+
+    // setup descriptor of K transforms at distance M
+    s = DftiCreateDescriptor(&desc, DFTI_DOUBLE, DFTI_COMPLEX, 1, m);
+    s = DftiSetValue(desc, DFTI_NUMBER_OF_TRANSFORMS, K);
+    s = DftiSetValue(desc, DFTI_INPUT_DISTANCE, M);
+    s = DftiSetValue(desc, DFTI_OUTPUT_DISTANCE, M);
+    s = DftiSetValue(desc, DFTI_FORWARD_SCALE, 1.0 / sqrt(m));
+    s = DftiSetValue(desc, DFTI_BACKWARD_SCALE, 1.0 / sqrt(m));
+    s = DftiCommitDescriptor(desc);
+
+    if (s != 0)
+    {
+        printf("\n\n\tERROR : fail to setup batched FFT : %s\n\n",
+               DftiErrorMessage(s));
+        exit(EXIT_FAILURE);
+    }
+
+
+
+    // exponential of derivatives repeated for each component, with the
+    // boundary points multiplied by 1
+    for (i = 0; i < m; i++)
+    {
+        if (i <= (m - 1) / 2) { freq = (2 * PI * i) / (m * EQ->dx);       }
+        else                  { freq = (2 * PI * (i - m)) / (m * EQ->dx); }
+        exp_der[i] = cexp(Idt * EQ->a1 * freq * I - Idt * EQ->a2 * freq *
+                     freq);
+    }
+    exp_der[m] = 1;
+    for (c = 1; c < K; c++) carrCopy(M, exp_der, exp_der + c * M);
+
+
+
+    printHeaderMC(EQ);
+
+    k = 1;
+    for (i = 0; i < N; i++)
+    {
+        if ( i % 50 == 0 ) printObservablesMC(EQ, i * dt, S);
+
+        potentialStepMC(EQ, Idt / 2, EQ->V, S, abs2, pot, expo, work);
+
+        s = DftiComputeForward(desc, work);
+        carrMultiply(K * M, exp_der, work, work);
+        s = DftiComputeBackward(desc, work);
+
+        potentialStepMC(EQ, Idt / 2, EQ->V, work, abs2, pot, expo, S);
+        boundaryMC(EQ, 1, S);
+
+        if (k == n) { carr_inline(out_data, K * M, S); k = 1; }
+        else        { k = k + 1;                              }
+    }
+
+    printObservablesMC(EQ, N * dt, S);
+    sepline();
+
+    fclose(out_data);
+
+    s = DftiFreeDescriptor(&desc);
+
+    free(abs2);
+    free(pot);
+    free(expo);
+    free(exp_der);
+    free(work);
+}
+
+
+
+void SSCNmc(EqDataPkgMC EQ, int N, double dt, int cyclic, Carray S,
+     char fname[], int n)
+{
+
+/** Same steps of SSCNSM for all components. The product by the RHS
+  * matrix is done while the components are interleaved in rhs,  the
+  * layout of triDiagMulti,  and the Sherman-Morrison correction  of
+  * the cyclic system while they are copied back **/
+
+    int
+        i,
+        j,
+        c,
+        k,
+        M,
+        m,
+        K,
+        start,
+        len;
+
+    double
+        a2,
+        dx;
+
+    double complex
+        a1,
+        bu,
+        bl,
+        factor,
+        denom,
+        corr,
+        left,
+        Idt;
+
+    Rarray
+        V,
+        abs2,
+        pot;
+
+    Carray
+        expo,
+        linpart,
+        upper,
+        lower,
+        mid,
+        bmid,
+        u,
+        w,
+        rhs,
+        x;
+
+    FILE
+        * out_data;
+
+
+
+    M = EQ->Mpos;
+    m = M - 1;
+    K = EQ->ncomp;
+
+    a2 = EQ->a2;
+    a1 = EQ->a1;
+    dx = EQ->dx;
+    V = EQ->V;
+    Idt = 0.0 - dt * I;
+
+    abs2 = rarrDef(K * M);
+    pot = rarrDef(M);
+    expo = carrDef(M);
+    linpart = carrDef(K * M);
+
+    upper = carrDef(m);
+    lower = carrDef(m);
+    mid = carrDef(m);
+    bmid = carrDef(m);
+    u = carrDef(m);
+    w = carrDef(m);
+    rhs = carrDef(K * m);
+    x = carrDef(K * m);
+
+    out_data = fopen(fname, "w");
+
+    if (out_data == NULL)
+    {
+        printf("\n\nERROR: impossible to open file %s\n", fname);
+        exit(EXIT_FAILURE);
+    }
+
+    carr_inline(out_data, K * M, S);
+
+
+
+    // RHS matrix of Crank-Nicolson, constant off-diagonals
+    carrFill(m, - a2 * dt / dx / dx + I, upper);
+    rcarrUpdate(m, upper, dt / 2, V, bmid);
+    bu = a2 * dt / dx / dx / 2 + a1 * dt / dx / 4;
+    bl = a2 * dt / dx / dx / 2 - a1 * dt / dx / 4;
+
+    // Matrix of the linear system with the corners as in SSCNSM
+    carrFill(m, a2 * dt / dx /dx + I, upper);
+    rcarrUpdate(m, upper, -dt / 2, V, mid);
+    carrFill(m, - a2 * dt / dx / dx / 2 - a1 * dt / dx / 4, upper);
+    carrFill(m, - a2 * dt / dx / dx / 2 + a1 * dt / dx / 4, lower);
+    if (cyclic)
+    {
+        upper[m-1] = - a2 * dt / dx / dx / 2 + a1 * dt / dx / 4;
+        lower[m-1] = - a2 * dt / dx / dx / 2 - a1 * dt / dx / 4;
+    }
+
+
+
+    // Sherman-Morrison with the same choice of triCyclicSM. The solution
+    // w of the correction vector does not change along the evolution
+    factor = 0;
+    denom = 1;
+    if (cyclic)
+    {
+        if (cabs(mid[0]) == 0) { factor = upper[0]; mid[0] = -factor; }
+        else                   { factor = mid[0];   mid[0] = 0;       }
+        mid[m-1] = mid[m-1] - upper[m-1] * lower[m-1] / factor;
+
+        carrFill(m, 0, u);
+        u[0] = factor;
+        u[m-1] = lower[m-1];
+        triDiag(m, upper, lower, mid, u, w);
+        denom = 1.0 + w[0] + upper[m-1] * w[m-1] / factor;
+    }
+
+
+
+    printHeaderMC(EQ);
+
+    k = 1;
+    for (i = 0; i < N; i++)
+    {
+        if ( i % 50 == 0 ) printObservablesMC(EQ, i * dt, S);
+
+        // V is in the Crank-Nicolson matrices
+        potentialStepMC(EQ, Idt / 2, NULL, S, abs2, pot, expo, linpart);
+
+        // RHS of all components interleaved. The point m is the boundary
+        // that is S[0] in cyclic case and zero otherwise
+        #pragma omp parallel for private(j, c, left) if (ompWorthy(K * m))
+        for (j = 0; j < m; j++)
+        {
+            for (c = 0; c < K; c++)
+            {
+                if (j > 0)       left = linpart[c * M + j - 1];
+                else if (cyclic) left = linpart[c * M + m - 1];
+                else             left = 0;
+                rhs[j * K + c] = bl * left + bmid[j] * linpart[c * M + j] +
+                                 bu * linpart[c * M + j + 1];
+            }
+        }
+
+        triDiagMulti(m, K, upper, lower, mid, rhs, x);
+
+        for (c = 0; c < K; c++)
+        {
+            corr = 0;
+            if (cyclic)
+            {
+                corr = (x[c] + upper[m-1] * x[(m - 1) * K + c] / factor) /
+                       denom;
+            }
+            #pragma omp parallel private(j, start, len) if (ompWorthy(m))
+            {
+                ompChunk(m, &start, &len);
+                for (j = start; j < start + len; j++)
+                {
+                    linpart[c * M + j] = x[j * K + c] - corr * w[j];
+                }
+            }
+        }
+        boundaryMC(EQ, cyclic, linpart);
+
+        potentialStepMC(EQ, Idt / 2, NULL, linpart, abs2, pot, expo, S);
+
+        if (k == n) { carr_inline(out_data, K * M, S); k = 1; }
+        else        { k = k + 1;                              }
+    }
+
+    printObservablesMC(EQ, N * dt, S);
+    sepline();
+
+    fclose(out_data);
+
+    free(abs2);
+    free(pot);
+    free(expo);
+    free(linpart);
+    free(upper);
+    free(lower);
+    free(mid);
+    free(bmid);
+    free(u);
+    free(w);
+    free(rhs);
+    free(x);
+}
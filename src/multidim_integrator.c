@@ -0,0 +1,933 @@
+#include "multidim_integrator.h"
+
+
+
+/*          ***********************************************
+
+                      GRID AND OBSERVABLES HELPERS
+
+            ***********************************************          */
+
+
+
+static int interiorSize(EqDataPkgMD EQ, int d)
+{
+
+/** Number of interior points along axis d. The z axis of a 2D grid has
+  * a single point that is not a boundary **/
+
+    if (d >= EQ->dim) return 1;
+    return EQ->Mpos[d] - 1;
+}
+
+
+
+static void boundaryMD(EqDataPkgMD EQ, int periodic, Carray S)
+{
+
+/** Set the last point of each axis equal to the first one if periodic
+  * or to zero otherwise **/
+
+    int
+        i,
+        j,
+        k,
+        Mx,
+        My,
+        Mz,
+        p;
+
+    Mx = EQ->Mpos[0];
+    My = EQ->Mpos[1];
+    Mz = EQ->Mpos[2];
+
+    for (k = 0; k < Mz; k++)
+    {
+        for (j = 0; j < My; j++)
+        {
+            p = (k * My + j) * Mx;
+            if (periodic) S[p + Mx - 1] = S[p];
+            else          S[p + Mx - 1] = 0;
+        }
+
+        p = k * My * Mx;
+        for (i = 0; i < Mx; i++)
+        {
+            if (periodic) S[p + (My - 1) * Mx + i] = S[p + i];
+            else          S[p + (My - 1) * Mx + i] = 0;
+        }
+    }
+
+    if (EQ->dim < 3) return;
+
+    p = (Mz - 1) * My * Mx;
+    for (i = 0; i < My * Mx; i++)
+    {
+        if (periodic) S[p + i] = S[i];
+        else          S[p + i] = 0;
+    }
+}
+
+
+
+static double cmod2(double complex z)
+{
+    return creal(z) * creal(z) + cimag(z) * cimag(z);
+}
+
+
+
+static double normMD(EqDataPkgMD EQ, Carray S)
+{
+
+/** Integral of |S|^2 with the rectangle rule over the interior points **/
+
+    int
+        i,
+        l,
+        p,
+        mx,
+        my,
+        mz;
+
+    double
+        norm;
+
+    mx = interiorSize(EQ, 0);
+    my = interiorSize(EQ, 1);
+    mz = interiorSize(EQ, 2);
+
+    norm = 0;
+
+    #pragma omp parallel for private(i, l, p) reduction(+:norm) \
+            if (ompWorthy(mx * my * mz))
+    for (l = 0; l < my * mz; l++)
+    {
+        p = ((l / my) * EQ->Mpos[1] + l % my) * EQ->Mpos[0];
+        for (i = 0; i < mx; i++)
+        {
+            norm = norm + cmod2(S[p + i]);
+        }
+    }
+
+    return norm * EQ->dx[0] * EQ->dx[1] * EQ->dx[2];
+}
+
+
+
+void ObservablesMD(EqDataPkgMD EQ, Carray S, struct GPObservables * obs)
+{
+
+/** Single sweep over the interior points, as in Observables,  with  the
+  * gradient taken by forward differences, that use the boundary points
+  * at the end of each axis. The energy and chemical potential are given
+  * per particle (normalized by the norm) **/
+
+    int
+        i,
+        l,
+        p,
+        mx,
+        my,
+        mz,
+        sy,
+        sz;
+
+    double
+        a,
+        dv,
+        rx,
+        ry,
+        rz,
+        norm,
+        kin,
+        trap,
+        int4;
+
+    double complex
+        f,
+        dfx,
+        dfy,
+        dfz;
+
+    mx = interiorSize(EQ, 0);
+    my = interiorSize(EQ, 1);
+    mz = interiorSize(EQ, 2);
+
+    sy = EQ->Mpos[0];
+    sz = EQ->Mpos[0] * EQ->Mpos[1];
+
+    rx = 1.0 / (EQ->dx[0] * EQ->dx[0]);
+    ry = 1.0 / (EQ->dx[1] * EQ->dx[1]);
+    rz = 0;
+    if (EQ->dim == 3) rz = 1.0 / (EQ->dx[2] * EQ->dx[2]);
+
+    norm = 0;
+    kin = 0;
+    trap = 0;
+    int4 = 0;
+
+    #pragma omp parallel for private(i, l, p, a, f, dfx, dfy, dfz) \
+            reduction(+:norm, kin, trap, int4) if (ompWorthy(mx * my * mz))
+    for (l = 0; l < my * mz; l++)
+    {
+        p = ((l / my) * EQ->Mpos[1] + l % my) * EQ->Mpos[0];
+        for (i = 0; i < mx; i++, p++)
+        {
+            f = S[p];
+            a = cmod2(f);
+            norm = norm + a;
+            trap = trap + EQ->V[p] * a;
+            int4 = int4 + a * a;
+            dfx = S[p + 1] - f;
+            dfy = S[p + sy] - f;
+            dfz = 0;
+            if (rz != 0) dfz = S[p + sz] - f;
+            kin = kin + rx * cmod2(dfx) + ry * cmod2(dfy) + rz * cmod2(dfz);
+        }
+    }
+
+    dv = EQ->dx[0] * EQ->dx[1] * EQ->dx[2];
+
+    obs->norm = norm * dv;
+    obs->kinetic = - EQ->a2 * kin * dv;
+    obs->trap = trap * dv;
+    obs->inter = EQ->inter * int4 * dv / 2;
+    obs->virial = 2 * obs->trap - 2 * obs->kinetic - EQ->dim * obs->inter;
+    obs->energy = (obs->kinetic + obs->trap + obs->inter) / obs->norm;
+    obs->chem = (obs->kinetic + obs->trap + 2 * obs->inter) / obs->norm;
+    obs->r2 = 0;
+}
+
+
+
+/*          ***********************************************
+
+                         SPLIT-STEP KERNELS
+
+            ***********************************************          */
+
+
+
+static void potentialStepMD(int n, double complex z, Rarray V, double g,
+            Carray S, Rarray abs2, Rarray pot, Carray expo, Carray out)
+{
+
+/** out = exp(z (V + g |S|^2)) S over the whole grid. Each thread work
+  * in its own chunk as in the 1D split-step. abs2, pot and expo are
+  * work arrays of size n **/
+
+    int
+        start,
+        len;
+
+    #pragma omp parallel private(start, len) if (ompWorthy(n))
+    {
+        ompChunk(n, &start, &len);
+        carrAbs2(len, S + start, abs2 + start);
+        rarrUpdate(len, V + start, g, abs2 + start, pot + start);
+        rcarrExp(len, z, pot + start, expo + start);
+        carrMultiply(len, expo + start, S + start, out + start);
+    }
+}
+
+
+
+static double fftFreq(int i, int m, double dx)
+{
+    if (i <= (m - 1) / 2) return (2 * PI * i) / (m * dx);
+    return (2 * PI * (i - m)) / (m * dx);
+}
+
+
+
+static DFTI_DESCRIPTOR_HANDLE fftDescMD(EqDataPkgMD EQ)
+{
+
+/** Descriptor of the transform over the interior points, in place with
+  * the strides of the whole grid.  MKL takes the lengths from the
+  * slowest to the fastest index. strides[0] is the offset **/
+
+    int
+        d,
+        dim;
+
+    double
+        scale;
+
+    MKL_LONG
+        s,
+        len[3],
+        strides[4];
+
+    DFTI_DESCRIPTOR_HANDLE
+        desc;
+
+    dim = EQ->dim;
+    scale = 1;
+
+    for (d = 0; d < dim; d++)
+    {
+        len[d] = EQ->Mpos[dim - 1 - d] - 1;
+        scale = scale * len[d];
+    }
+
+    strides[0] = 0;
+    strides[dim] = 1;
+    for (d = dim - 1; d > 0; d--)
+    {
+        strides[d] = strides[d + 1] * EQ->Mpos[dim - 1 - d];
+    }
+
+    s = DftiCreateDescriptor(&desc, DFTI_DOUBLE, DFTI_COMPLEX, dim, len);
+    s = DftiSetValue(desc, DFTI_INPUT_STRIDES, strides);
+    s = DftiSetValue(desc, DFTI_OUTPUT_STRIDES, strides);
+    s = DftiSetValue(desc, DFTI_FORWARD_SCALE, 1.0 / sqrt(scale));
+    s = DftiSetValue(desc, DFTI_BACKWARD_SCALE, 1.0 / sqrt(scale));
+    s = DftiCommitDescriptor(desc);
+
+    if (s != 0)
+    {
+        printf("\n\n\tERROR : fail to setup multidimensional FFT : %s\n\n",
+               DftiErrorMessage(s));
+        exit(EXIT_FAILURE);
+    }
+
+    return desc;
+}
+
+
+
+static Carray fftExpDerMD(EqDataPkgMD EQ, double complex z)
+{
+
+/** Exponential of the laplacian exp(- z a2 |k|^2) over the whole grid,
+  * equal to 1 in the boundary points not touched by the transform **/
+
+    int
+        i,
+        j,
+        k,
+        p,
+        mx,
+        my,
+        mz;
+
+    double
+        kx,
+        ky,
+        kz;
+
+    Carray
+        exp_der;
+
+    mx = interiorSize(EQ, 0);
+    my = interiorSize(EQ, 1);
+    mz = interiorSize(EQ, 2);
+
+    exp_der = carrDef(EQ->Mtot);
+    carrFill(EQ->Mtot, 1, exp_der);
+
+    for (k = 0; k < mz; k++)
+    {
+        kz = 0;
+        if (EQ->dim == 3) kz = fftFreq(k, mz, EQ->dx[2]);
+        for (j = 0; j < my; j++)
+        {
+            ky = fftFreq(j, my, EQ->dx[1]);
+            p = (k * EQ->Mpos[1] + j) * EQ->Mpos[0];
+            for (i = 0; i < mx; i++)
+            {
+                kx = fftFreq(i, mx, EQ->dx[0]);
+                exp_der[p + i] = cexp(- z * EQ->a2 * (kx*kx + ky*ky + kz*kz));
+            }
+        }
+    }
+
+    return exp_der;
+}
+
+
+
+static void adiSetup(EqDataPkgMD EQ, int d, double complex z, Carray upper,
+            Carray lower, Carray mid, double complex * c)
+{
+
+/** Crank-Nicolson along the axis d,
+  *
+  *     (1 - z/2 a2 D2) S(t + dt) = (1 + z/2 a2 D2) S(t)
+  *
+  * with D2 the second order finite difference. The constant stencil of
+  * the right hand side is c[0] S[i] + c[1] (S[i-1] + S[i+1]) **/
+
+    int
+        m;
+
+    double complex
+        r;
+
+    m = EQ->Mpos[d] - 1;
+    r = z * EQ->a2 / (EQ->dx[d] * EQ->dx[d]);
+
+    carrFill(m, 1 + r, mid);
+    carrFill(m, - r / 2, upper);
+    carrFill(m, - r / 2, lower);
+
+    c[0] = 1 - r;
+    c[1] = r / 2;
+}
+
+
+
+static void adiSweep(EqDataPkgMD EQ, int d, Carray upper, Carray lower,
+            Carray mid, double complex * c, Carray S)
+{
+
+/** Solve in place the Crank-Nicolson system of every line along axis d.
+  * The lines are enumerated by the interior points of the other two axes
+  * a (the fastest) and b, and each thread gathers ADI_BATCH consecutive
+  * lines interleaved in its buffer,  which is cache friendly for  any
+  * axis: along x each line is read contiguously, along y and z the same
+  * row of consecutive lines is contiguous. The point after the last one
+  * of a line is the (zero) boundary and the one before the first is
+  * taken as zero as in the 1D Crank-Nicolson **/
+
+    int
+        i,
+        l,
+        q,
+        b,
+        m,
+        nb,
+        nl,
+        na,
+        a0,
+        b0,
+        st[3],
+        base[ADI_BATCH];
+
+    Carray
+        line,
+        rhs,
+        ans;
+
+    st[0] = 1;
+    st[1] = EQ->Mpos[0];
+    st[2] = EQ->Mpos[0] * EQ->Mpos[1];
+
+    a0 = (d == 0) ? 1 : 0;
+    b0 = (d == 2) ? 1 : 2;
+
+    m = EQ->Mpos[d] - 1;
+    na = interiorSize(EQ, a0);
+    nl = na * interiorSize(EQ, b0);
+
+    #pragma omp parallel private(i, l, q, b, nb, line, rhs, ans, base) \
+            if (ompWorthy(nl * m))
+    {
+        rhs = carrDef(m * ADI_BATCH);
+        ans = carrDef(m * ADI_BATCH);
+
+        #pragma omp for schedule(static)
+        for (b = 0; b < nl; b += ADI_BATCH)
+        {
+            nb = nl - b < ADI_BATCH ? nl - b : ADI_BATCH;
+
+            for (q = 0; q < nb; q++)
+            {
+                l = b + q;
+                base[q] = (l % na) * st[a0] + (l / na) * st[b0];
+            }
+
+            // gather the right hand sides
+            for (i = 0; i < m; i++)
+            {
+                for (q = 0; q < nb; q++)
+                {
+                    line = S + base[q];
+                    rhs[i * nb + q] = c[0] * line[i * st[d]]
+                                    + c[1] * line[(i + 1) * st[d]];
+                    if (i > 0)
+                    {
+                        rhs[i * nb + q] += c[1] * line[(i - 1) * st[d]];
+                    }
+                }
+            }
+
+            triDiagMulti(m, nb, upper, lower, mid, rhs, ans);
+
+            // scatter the solutions back to the grid
+            for (i = 0; i < m; i++)
+            {
+                for (q = 0; q < nb; q++)
+                {
+                    S[base[q] + i * st[d]] = ans[i * nb + q];
+                }
+            }
+        }
+
+        free(rhs);
+        free(ans);
+    }
+}
+
+
+
+/*          ***********************************************
+
+                               REAL TIME
+
+            ***********************************************          */
+
+
+
+static void printObservablesMD(EqDataPkgMD EQ, double t, Carray S)
+{
+    struct GPObservables
+        obs;
+
+    ObservablesMD(EQ, S, &obs);
+    printf(" \n  %.4lf          ", t);
+    printf("%15.7E          ", creal(obs.energy));
+    printf("%15.7E          ", obs.norm);
+}
+
+
+
+void SSFFTmd(EqDataPkgMD EQ, int N, double dt, Carray S, char fname[], int n)
+{
+
+/** Split-step with multidimensional FFT for the derivatives part. The
+  * steps are the same of SSFFT, over the whole grid. **/
+
+    int
+        i,
+        k,
+        Mtot;
+
+    MKL_LONG
+        s;
+
+    double complex
+        Idt = 0.0 - dt * I;
+
+    DFTI_DESCRIPTOR_HANDLE
+        desc;
+
+    Rarray
+        abs2,
+        pot;
+
+    Carray
+        expo,
+        exp_der,
+        forward_fft,
+        back_fft;
+
+    FILE
+        * out_data;
+
+
+
+    Mtot = EQ->Mtot;
+
+    abs2 = rarrDef(Mtot);
+    pot = rarrDef(Mtot);
+    expo = carrDef(Mtot);
+    forward_fft = carrDef(Mtot);
+    back_fft = carrDef(Mtot);
+
+    out_data = fopen(fname, "w");
+
+    if (out_data == NULL)
+    {
+        printf("\n\nERROR: impossible to open file %s\n", fname);
+        exit(EXIT_FAILURE);
+    }
+
+    carr_inline(out_data, Mtot, S);
+
+    desc = fftDescMD(EQ);
+    exp_der = fftExpDerMD(EQ, Idt);
+
+
+
+    printf("\n\n\n");
+    printf("     time            Energy                   Norm");
+    sepline();
+
+    k = 1;
+    for (i = 0; i < N; i++)
+    {
+        if ( i % 50 == 0 ) printObservablesMD(EQ, i * dt, S);
+
+        potentialStepMD(Mtot, Idt / 2, EQ->V, EQ->inter, S, abs2, pot, expo,
+                        forward_fft);
+
+        s = DftiComputeForward(desc, forward_fft);
+        carrMultiply(Mtot, exp_der, forward_fft, back_fft);
+        s = DftiComputeBackward(desc, back_fft);
+
+        potentialStepMD(Mtot, Idt / 2, EQ->V, EQ->inter, back_fft, abs2, pot,
+                        expo, S);
+        boundaryMD(EQ, 1, S);
+
+        if (k == n) { carr_inline(out_data, Mtot, S); k = 1; }
+        else        { k = k + 1;                             }
+    }
+
+    printObservablesMD(EQ, N * dt, S);
+    sepline();
+
+    fclose(out_data);
+
+    s = DftiFreeDescriptor(&desc);
+
+    free(abs2);
+    free(pot);
+    free(expo);
+    free(exp_der);
+    free(forward_fft);
+    free(back_fft);
+}
+
+
+
+void SSADImd(EqDataPkgMD EQ, int N, double dt, Carray S, char fname[], int n)
+{
+
+/** Split-step with Crank-Nicolson along each axis for the derivatives
+  * part. The matrices are constant and set up only once. **/
+
+    int
+        d,
+        i,
+        k,
+        Mtot;
+
+    double complex
+        Idt = 0.0 - dt * I,
+        c[3][2];
+
+    Rarray
+        abs2,
+        pot;
+
+    Carray
+        expo,
+        linpart,
+        upper[3],
+        lower[3],
+        mid[3];
+
+    FILE
+        * out_data;
+
+
+
+    Mtot = EQ->Mtot;
+
+    abs2 = rarrDef(Mtot);
+    pot = rarrDef(Mtot);
+    expo = carrDef(Mtot);
+    linpart = carrDef(Mtot);
+
+    for (d = 0; d < EQ->dim; d++)
+    {
+        upper[d] = carrDef(EQ->Mpos[d]);
+        lower[d] = carrDef(EQ->Mpos[d]);
+        mid[d] = carrDef(EQ->Mpos[d]);
+        adiSetup(EQ, d, Idt, upper[d], lower[d], mid[d], c[d]);
+    }
+
+    out_data = fopen(fname, "w");
+
+    if (out_data == NULL)
+    {
+        printf("\n\nERROR: impossible to open file %s\n", fname);
+        exit(EXIT_FAILURE);
+    }
+
+    carr_inline(out_data, Mtot, S);
+
+
+
+    printf("\n\n\n");
+    printf("     time            Energy                   Norm");
+    sepline();
+
+    k = 1;
+    for (i = 0; i < N; i++)
+    {
+        if ( i % 50 == 0 ) printObservablesMD(EQ, i * dt, S);
+
+        potentialStepMD(Mtot, Idt / 2, EQ->V, EQ->inter, S, abs2, pot, expo,
+                        linpart);
+
+        for (d = 0; d < EQ->dim; d++)
+        {
+            adiSweep(EQ, d, upper[d], lower[d], mid[d], c[d], linpart);
+        }
+
+        potentialStepMD(Mtot, Idt / 2, EQ->V, EQ->inter, linpart, abs2, pot,
+                        expo, S);
+        boundaryMD(EQ, 0, S);
+
+        if (k == n) { carr_inline(out_data, Mtot, S); k = 1; }
+        else        { k = k + 1;                             }
+    }
+
+    printObservablesMD(EQ, N * dt, S);
+    sepline();
+
+    fclose(out_data);
+
+    for (d = 0; d < EQ->dim; d++)
+    {
+        free(upper[d]);
+        free(lower[d]);
+        free(mid[d]);
+    }
+
+    free(abs2);
+    free(pot);
+    free(expo);
+    free(linpart);
+}
+
+
+
+/*          ***********************************************
+
+                             IMAGINARY TIME
+
+            ***********************************************          */
+
+
+
+static int imagStepReport(EqDataPkgMD EQ, int i, Carray S, double * E,
+           struct ConvMonitor * mon)
+{
+
+/** Print the progress every 50 steps and sample the energy at the cadence
+  * of the convergence monitor. Return 1 if converged. **/
+
+    struct GPObservables
+        obs;
+
+    if ( (i + 1) % 50 != 0 && (i + 1) % convCadence() != 0 ) return 0;
+
+    ObservablesMD(EQ, S, &obs);
+    *E = creal(obs.energy);
+
+    if ( (i + 1) % 50 == 0 )
+    {
+        printf("\n\t%6d       %15.7E", i + 1, *E);
+        printf("         %15.7E", obs.virial);
+    }
+
+    if ( (i + 1) % convCadence() == 0 ) return convUpdate(mon, *E);
+
+    return 0;
+}
+
+
+
+static void imagStart(EqDataPkgMD EQ, Carray S, double * E,
+            struct ConvMonitor * mon)
+{
+    struct GPObservables
+        obs;
+
+    ObservablesMD(EQ, S, &obs);
+    *E = creal(obs.energy);
+    convReset(mon);
+
+    printf("\n\n\t Nstep         Energy/particle         Virial");
+    sepline();
+    printf("\n\t%6d       %15.7E", 0, *E);
+    printf("         %15.7E", obs.virial);
+}
+
+
+
+static void imagEnd(EqDataPkgMD EQ, int converged, Carray S, double * E)
+{
+    struct GPObservables
+        obs;
+
+    ObservablesMD(EQ, S, &obs);
+    *E = creal(obs.energy);
+    convReport(converged, *E, obs.virial);
+}
+
+
+
+int ISSFFTmd(EqDataPkgMD EQ, int N, double dT, Carray S, double * E)
+{
+
+/** Imaginary time version of SSFFTmd with the norm restored after each
+  * step. Periodic boundary. **/
+
+    int
+        i,
+        Mtot;
+
+    MKL_LONG
+        s;
+
+    double
+        norm;
+
+    struct ConvMonitor
+        mon;
+
+    DFTI_DESCRIPTOR_HANDLE
+        desc;
+
+    Rarray
+        abs2,
+        pot;
+
+    Carray
+        expo,
+        exp_der,
+        forward_fft,
+        back_fft;
+
+
+
+    Mtot = EQ->Mtot;
+
+    abs2 = rarrDef(Mtot);
+    pot = rarrDef(Mtot);
+    expo = carrDef(Mtot);
+    forward_fft = carrDef(Mtot);
+    back_fft = carrDef(Mtot);
+
+    desc = fftDescMD(EQ);
+    exp_der = fftExpDerMD(EQ, - dT);
+
+    norm = sqrt(normMD(EQ, S));
+    imagStart(EQ, S, E, &mon);
+
+    for (i = 0; i < N; i++)
+    {
+        potentialStepMD(Mtot, - dT / 2, EQ->V, EQ->inter, S, abs2, pot, expo,
+                        forward_fft);
+
+        s = DftiComputeForward(desc, forward_fft);
+        carrMultiply(Mtot, exp_der, forward_fft, back_fft);
+        s = DftiComputeBackward(desc, back_fft);
+
+        potentialStepMD(Mtot, - dT / 2, EQ->V, EQ->inter, back_fft, abs2, pot,
+                        expo, S);
+        boundaryMD(EQ, 1, S);
+
+        carrScalarMultiply(Mtot, S, norm / sqrt(normMD(EQ, S)), S);
+
+        if ( imagStepReport(EQ, i, S, E, &mon) ) break;
+    }
+
+    imagEnd(EQ, i < N, S, E);
+
+    s = DftiFreeDescriptor(&desc);
+
+    free(abs2);
+    free(pot);
+    free(expo);
+    free(exp_der);
+    free(forward_fft);
+    free(back_fft);
+
+    return i + 1;
+}
+
+
+
+int ISSADImd(EqDataPkgMD EQ, int N, double dT, Carray S, double * E)
+{
+
+/** Imaginary time version of SSADImd with the norm restored after each
+  * step. Zero boundary. **/
+
+    int
+        d,
+        i,
+        Mtot;
+
+    double
+        norm;
+
+    double complex
+        c[3][2];
+
+    struct ConvMonitor
+        mon;
+
+    Rarray
+        abs2,
+        pot;
+
+    Carray
+        expo,
+        linpart,
+        upper[3],
+        lower[3],
+        mid[3];
+
+
+
+    Mtot = EQ->Mtot;
+
+    abs2 = rarrDef(Mtot);
+    pot = rarrDef(Mtot);
+    expo = carrDef(Mtot);
+    linpart = carrDef(Mtot);
+
+    for (d = 0; d < EQ->dim; d++)
+    {
+        upper[d] = carrDef(EQ->Mpos[d]);
+        lower[d] = carrDef(EQ->Mpos[d]);
+        mid[d] = carrDef(EQ->Mpos[d]);
+        adiSetup(EQ, d, - dT, upper[d], lower[d], mid[d], c[d]);
+    }
+
+    norm = sqrt(normMD(EQ, S));
+    imagStart(EQ, S, E, &mon);
+
+    for (i = 0; i < N; i++)
+    {
+        potentialStepMD(Mtot, - dT / 2, EQ->V, EQ->inter, S, abs2, pot, expo,
+                        linpart);
+
+        for (d = 0; d < EQ->dim; d++)
+        {
+            adiSweep(EQ, d, upper[d], lower[d], mid[d], c[d], linpart);
+        }
+
+        potentialStepMD(Mtot, - dT / 2, EQ->V, EQ->inter, linpart, abs2, pot,
+                        expo, S);
+        boundaryMD(EQ, 0, S);
+
+        carrScalarMultiply(Mtot, S, norm / sqrt(normMD(EQ, S)), S);
+
+        if ( imagStepReport(EQ, i, S, E, &mon) ) break;
+    }
+
+    imagEnd(EQ, i < N, S, E);
+
+    for (d = 0; d < EQ->dim; d++)
+    {
+        free(upper[d]);
+        free(lower[d]);
+        free(mid[d]);
+    }
+
+    free(abs2);
+    free(pot);
+    free(expo);
+    free(linpart);
+
+    return i + 1;
+}
@@ -4,99 +4,169 @@
 
 
 
-doublec Chem(int M, double dx, double a2, doublec a1, double inter,
-        Rarray V, Carray f)
+static double simpsWeight(int n, int i, double h)
 {
 
-/** Gross-Pitaesvkii functional that yield both energy and chemical
-  * potential depending on what is the coefficient that multiply the
-  * nonlinearity of fourth order in integration.
-  *
-  * For energy : inter = g / 2
-  * For chemical potential : inter = g
+/** Weight of point i in the Simpson's rule of Rsimps with n points. For
+  * even n the last 4 points are integrated by the 3/8 rule **/
+
+    if (n % 2 == 0 && i >= n - 4)
+    {
+        if (i == n - 4) return (n > 4 ? h / 3 : 0) + 3 * h / 8;
+        if (i == n - 1) return 3 * h / 8;
+        return 9 * h / 8;
+    }
+
+    if (i == 0 || i == n - 1) return h / 3;
+    if (i % 2 == 1) return 4 * h / 3;
+    return 2 * h / 3;
+}
+
+
+
+
+
+void Observables(int M, double dx, double a2, doublec a1, double g,
+     Rarray V, Carray f, int flags, struct GPObservables * obs)
+{
+
+/** Single sweep over f accumulating the integrals of
   *
-  * REMIND FOR DIRAC DELTA BARRIER
+  *     |f|^2     |f|^4     V |f|^2     x^2 |f|^2
   *
-  * The potential part V must then be integrated by trapezium/rectangle
-  * rule. Therefore erase V[i] inside the brackets in for loop defining
-  * the integrand. Change the following line that define the energy :
+  *     - a2 |f'|^2     a1 conj(f) f'
   *
-  * E = Csimps(M,Int,dx); for (i = 0; i < M; i++) E = E + dx * V[i] * abs2f[i]
+  * that are needed by the selected observables.  The derivative of
+  * each point is computed from its neighbors as in dxFD,  then  there
+  * is no auxiliar array and f is read only once.
   *
-  * This shall work for a numerical implementation like 1 / dx
+  * Energy and chemical potential are normalized by the norm as in the
+  * former functional (the same with g / 2 and g respectively),  while
+  * the other are plain integrals.
   *
-**/
+  * REMIND FOR DIRAC DELTA BARRIER the potential is also integrated by
+  * Simpson's rule, as in previous versions **/
 
     int
-        i;
+        i,
+        j,
+        P,
+        ip,
+        im,
+        ipp,
+        imm,
+        needV,
+        needDer;
 
     double
-        norm;
+        w,
+        x,
+        x0,
+        r,
+        abs2,
+        norm = 0,
+        kin = 0,
+        trap = 0,
+        int4 = 0,
+        x2 = 0,
+        dre = 0,
+        dim = 0;
 
     double complex
-        E;
-
-    Carray
-        DF  = carrDef(M),
-        Int = carrDef(M);
+        df,
+        z;
 
-    Rarray
-        abs2F  = rarrDef(M),
-        abs2DF = rarrDef(M);
-
-
-
-    dxFD(M,f,dx,DF);
+    if (M < 5)
+    {
+        printf("\n\n\tERROR : less than 5 points to compute observables\n\n");
+        exit(EXIT_FAILURE);
+    }
 
-    carrAbs2(M,DF,abs2DF);
+    needDer = flags & (OBS_ENERGY | OBS_CHEM | OBS_KINETIC | OBS_VIRIAL);
+    needV = flags & (OBS_ENERGY | OBS_CHEM | OBS_TRAP | OBS_VIRIAL);
 
-    carrAbs2(M,f,abs2F);
+    P = M - 1;                 // period, the last point is the first
+    r = 1.0 / (12 * dx);       // ratio for a fourth-order scheme
+    x0 = - dx * (M - 1) * 0.5; // First discretized point of domain
 
+    #pragma omp parallel for private(i, j, ip, im, ipp, imm, w, x, abs2, \
+            df, z) reduction(+:norm, kin, trap, int4, x2, dre, dim) \
+            if (ompWorthy(M))
     for (i = 0; i < M; i++)
     {
-        // Use E to sum potential and derivatives contributions
-        E = (V[i] + inter * abs2F[i]) * abs2F[i];
-        E = E - a2 * abs2DF[i] + a1 * conj(f[i]) * DF[i];
-        Int[i] = E;
+        w = simpsWeight(M, i, dx);
+        abs2 = creal(f[i]) * creal(f[i]) + cimag(f[i]) * cimag(f[i]);
+
+        norm = norm + w * abs2;
+        int4 = int4 + w * abs2 * abs2;
+
+        if (needV) trap = trap + w * V[i] * abs2;
+
+        if (flags & OBS_R2)
+        {
+            x = x0 + i * dx;
+            x2 = x2 + w * x * x * abs2;
+        }
+
+        if (needDer)
+        {
+            j = (i == P) ? 0 : i;
+            ip  = (j + 1 < P) ? j + 1 : j + 1 - P;
+            ipp = (j + 2 < P) ? j + 2 : j + 2 - P;
+            im  = (j - 1 >= 0) ? j - 1 : j - 1 + P;
+            imm = (j - 2 >= 0) ? j - 2 : j - 2 + P;
+
+            df = (f[imm] - f[ipp] + 8 * (f[ip] - f[im])) * r;
+
+            kin = kin - w * a2 * (creal(df) * creal(df) +
+                                  cimag(df) * cimag(df));
+            z = a1 * conj(f[i]) * df;
+            dre = dre + w * creal(z);
+            dim = dim + w * cimag(z);
+        }
     }
 
+    obs->norm = norm;
+    obs->kinetic = kin;
+    obs->trap = trap;
+    obs->inter = g * int4 / 2;
+    obs->virial = 2 * trap - 2 * kin - g * int4 / 2;
+    obs->r2 = sqrt(x2);
+    obs->energy = (trap + g * int4 / 2 + kin + dre + I * dim) / norm;
+    obs->chem = (trap + g * int4 + kin + dre + I * dim) / norm;
+}
 
-    E = Csimps(M,Int,dx);
-    norm = Rsimps(M,abs2F,dx);
-
-    // release memory
-    free(DF); free(abs2F); free(abs2DF); free(Int);
 
-    return E / norm;
 
-}
 
 
+doublec Chem(int M, double dx, double a2, doublec a1, double inter,
+        Rarray V, Carray f)
+{
 
+/** Gross-Pitaesvkii functional that yield the chemical potential **/
 
+    struct GPObservables
+        obs;
 
-doublec KinectE(int M, double a2, doublec a1, double dx, Carray psi)
-{
+    Observables(M, dx, a2, a1, inter, V, f, OBS_CHEM, &obs);
 
-    int k;
+    return obs.chem;
+}
 
-    double complex
-        r;
 
-    Carray
-        ddx   = carrDef(M),
-        toInt = carrDef(M);
 
-    dxFD(M,psi,dx,ddx);
 
-    for (k = 0; k < M; k++) toInt[k] = - a2 * conj(ddx[k]) * ddx[k];
 
-    r = Csimps(M,toInt,dx);
+doublec KinectE(int M, double a2, doublec a1, double dx, Carray psi)
+{
 
-    free(ddx); free(toInt);
+    struct GPObservables
+        obs;
 
-    return r;
+    Observables(M, dx, a2, a1, 0, NULL, psi, OBS_KINETIC, &obs);
 
+    return obs.kinetic;
 }
 
 
@@ -106,25 +176,12 @@ doublec KinectE(int M, double a2, doublec a1, double dx, Carray psi)
 doublec TrapE(int M, Rarray V, double dx, Carray psi)
 {
 
-    int k;
-
-    double complex
-        r;
-
-    Carray
-        toInt = carrDef(M);
-
-    for (k = 0; k < M; k++)
-    {
-        toInt[k] = V[k] * conj(psi[k]) * psi[k];
-    }
-
-    r = Csimps(M,toInt,dx);
+    struct GPObservables
+        obs;
 
-    free(toInt);
-
-    return r;
+    Observables(M, dx, 0, 0, 0, V, psi, OBS_TRAP, &obs);
 
+    return obs.trap;
 }
 
 
@@ -134,24 +191,12 @@ doublec TrapE(int M, Rarray V, double dx, Carray psi)
 double InterE(int M, double g, double dx, Carray psi)
 {
 
-    int k;
-
-    double
-        r;
-
-    Rarray
-        toInt = rarrDef(M);
-
-    carrAbs2(M,psi,toInt);
-
-    for (k = 0; k < M; k++)  toInt[k] = g * toInt[k] * toInt[k];
-
-    r = Rsimps(M,toInt,dx) / 2;
-
-    free(toInt);
+    struct GPObservables
+        obs;
 
-    return r;
+    Observables(M, dx, 0, 0, g, NULL, psi, OBS_INTER, &obs);
 
+    return obs.inter;
 }
 
 
@@ -161,7 +206,13 @@ double InterE(int M, double g, double dx, Carray psi)
 doublec Energy(int M, double dx, double a2, doublec a1, double inter,
         Rarray V, Carray f)
 {
-    return Chem(M, dx, a2, a1, inter / 2, V, f);
+
+    struct GPObservables
+        obs;
+
+    Observables(M, dx, a2, a1, inter, V, f, OBS_ENERGY, &obs);
+
+    return obs.energy;
 }
 
 
@@ -171,16 +222,13 @@ doublec Energy(int M, double dx, double a2, doublec a1, double inter,
 doublec Virial(int M, double a2, doublec a1, double g, Rarray V,
         double dx, Carray psi)
 {
-    double complex
-        kin,
-        pot,
-        ntr;
 
-    kin = KinectE(M,a2,a1,dx,psi);
-    pot = TrapE(M,V,dx,psi);
-    ntr = InterE(M,g,dx,psi);
+    struct GPObservables
+        obs;
 
-    return ( 2 * pot - 2 * kin - ntr );
+    Observables(M, dx, a2, a1, g, V, psi, OBS_VIRIAL, &obs);
+
+    return obs.virial;
 }
 
 
@@ -192,29 +240,10 @@ double MeanQuadraticR(int n, Carray f, double dx)
 
 /** Compute Mean Square value of normalized complex function/distribution **/
 
-    int
-        i;
-
-    double
-        r;
-
-    Rarray
-        ToInt;
-
-    ToInt = rarrDef(n);
-
-    r = - dx * (n - 1) * 0.5; // First discretized point of domain
-
-    for (i = 0; i < n; i ++)
-    {
-        ToInt[i] = (creal(f[i])*creal(f[i]) + cimag(f[i])*cimag(f[i])) * r*r;
-        r = r + dx;
-    }
-
-    r = sqrt(Rsimps(n, ToInt, dx));
-
-    free(ToInt);
+    struct GPObservables
+        obs;
 
-    return r;
+    Observables(n, dx, 0, 0, 0, NULL, f, OBS_R2, &obs);
 
+    return obs.r2;
 }
@@ -62,7 +62,11 @@ void SSFFT(EqDataPkg EQ, int N, double dt, Carray S, char fname[], int n)
         i,
         j,
         M,
-        m;
+        m,
+        start,
+        len,
+        linear,
+        synced;
 
     MKL_LONG
         s;
@@ -81,34 +85,691 @@ void SSFFT(EqDataPkg EQ, int N, double dt, Carray S, char fname[], int n)
     DFTI_DESCRIPTOR_HANDLE
         desc;
 
+    struct GPObservables
+        obs;
+
+
+
     Rarray
         V,
         abs2,
         step_pot;
 
-    Carray
+    Carray
+        exp_der,
+        exp_pot,
+        exp_full,
+        forward_fft,
+        back_fft;
+
+    FILE
+        * out_data = fopen(fname, "w");
+
+
+
+    M = EQ->Mpos;   // grid size including boudaries
+    m = M - 1;      // grid size excluding boudaries
+
+    abs2 = rarrDef(M);      // abs square of wave function
+    step_pot  = rarrDef(M); // time-dependent potential (nonlinear+linear)
+
+    exp_der = carrDef(m);     // Exponential of derivative operators
+    exp_pot = carrDef(M);     // Exponential of potential
+    forward_fft = carrDef(m);
+    back_fft = carrDef(m);
+
+    // Open file to write solution at every n time steps
+
+    out_data = fopen(fname, "w");
+
+    if (out_data == NULL)
+    {
+        printf("\n\nERROR: impossible to open file %s\n", fname);
+        exit(EXIT_FAILURE);
+    }
+
+    // Record initial data as first line
+
+    carr_inline(out_data, M, S);
+
+    // unpack equation parameters from structure
+
+    a2 = EQ->a2;
+    a1 = EQ->a1;
+    dx = EQ->dx;
+    g = EQ->inter;
+    V = EQ->V;
+
+
+
+    // setup descriptor (MKL implementation of FFT)
+    s = DftiCreateDescriptor(&desc, DFTI_DOUBLE, DFTI_COMPLEX, 1, m);
+    s = DftiSetValue(desc, DFTI_FORWARD_SCALE, 1.0 / sqrt(m));
+    s = DftiSetValue(desc, DFTI_BACKWARD_SCALE, 1.0 / sqrt(m));
+    s = DftiCommitDescriptor(desc);
+
+
+
+    // setup Fourier Frequencies and the exponential of derivative operator
+    // The convention for ordering the frequencies is starting from zero go
+    // over positive frequencies and after reached the max. start from  the
+    // max. negative frequency going back to zero.
+    for (i = 0; i < m; i++)
+    {
+        if (i <= (m - 1) / 2) { freq = (2 * PI * i) / (m * dx);       }
+        else                  { freq = (2 * PI * (i - m)) / (m * dx); }
+        // exponential of derivative operators
+        exp_der[i] = cexp(Idt * a1 * freq * I - Idt * a2 * freq * freq);
+    }
+
+
+
+    // Header of screen printing
+    printf("\n\n\n");
+    printf("     time            Energy                   Norm");
+    sepline();
+
+
+
+    // Without interaction the exponentials of the potential do not depend
+    // on S and are computed once. The second half-step of the potential
+    // is merged with the first half-step of the next time-step, with the
+    // full step exponential, unless the solution is required (synced)
+    linear = (g == 0);
+    synced = 1;
+    exp_full = NULL;
+    if (linear)
+    {
+        exp_full = carrDef(m);
+        rcarrExp(m, Idt / 2, V, exp_pot);
+        rcarrExp(m, Idt, V, exp_full);
+    }
+
+
+
+    k = 1;
+    for (i = 0; i < N; i++)
+    {
+
+        if (linear)
+        {
+            // first half-step, unless merged in the previous one
+            if (synced) carrMultiply(m, exp_pot, S, forward_fft);
+        }
+        else
+        {
+            // Apply exponential of potential part (linear and nonlinear)
+            // When copying data to use Fourier transform it is not used
+            // the boundary grid point assumed to be periodic. The element
+            // wise operations are done by each thread in its own chunk of
+            // the grid within a single parallel region,  thus  the  calls
+            // inside it run serially and there is only one fork/join
+            #pragma omp parallel private(start, len) if (ompWorthy(m))
+            {
+                ompChunk(m, &start, &len);
+                carrAbs2(len, S + start, abs2 + start);
+                rarrUpdate(len, V + start, g, abs2 + start, step_pot + start);
+                rcarrExp(len, Idt / 2, step_pot + start, exp_pot + start);
+                carrMultiply(len, exp_pot + start, S + start,
+                             forward_fft + start);
+            }
+            abs2[m] = abs2[0]; // boundary
+        }
+
+
+
+        // Print in screen to quality and progress control
+        if ( i % 50 == 0 )
+        {
+            Observables(M, dx, a2, a1, g, V, S, OBS_ENERGY | OBS_NORM,
+                        &obs);
+            E = obs.energy;
+            printf(" \n  %.4lf          ", i*dt);
+            printf("%15.7E          ", creal(E));
+            printf("%15.7E          ", obs.norm);
+        }
+
+
+
+        // go to momentum space (MKL use its own threads in the FFT)
+        s = DftiComputeForward(desc, forward_fft);
+        // apply exponential of derivatives
+        carrMultiply(m, exp_der, forward_fft, back_fft);
+        // go back to position space
+        s = DftiComputeBackward(desc, back_fft);
+
+
+
+        if (linear)
+        {
+            // The solution is needed to record, print or at the end
+            synced = (k == n || (i + 1) % 50 == 0 || i == N - 1);
+            if (synced) carrMultiply(m, exp_pot, back_fft, S);
+            else        carrMultiply(m, exp_full, back_fft, forward_fft);
+        }
+        else
+        {
+            // Apply again the full potential part, taking the solution from
+            // the back_fft directly without copy to S
+            #pragma omp parallel private(start, len) if (ompWorthy(m))
+            {
+                ompChunk(m, &start, &len);
+                carrAbs2(len, back_fft + start, abs2 + start);
+                rarrUpdate(len, V + start, g, abs2 + start, step_pot + start);
+                rcarrExp(len, Idt / 2, step_pot + start, exp_pot + start);
+                carrMultiply(len, exp_pot + start, back_fft + start, S + start);
+            }
+        }
+        S[m] = S[0]; //boundary
+
+
+
+        // RECORD solution if required
+        if (k == n) { carr_inline(out_data, M, S); k = 1; }
+        else        { k = k + 1; }
+    }
+
+    Observables(M, dx, a2, a1, g, V, S, OBS_ENERGY | OBS_NORM, &obs);
+    E = obs.energy;
+    printf(" \n  %.4lf          ", N*dt);
+    printf("%15.7E          ", creal(E));
+    printf("%15.7E          ", obs.norm);
+
+    sepline();
+
+    fclose(out_data);
+
+    s = DftiFreeDescriptor(&desc);
+
+    free(exp_der);
+    free(exp_pot);
+    if (exp_full != NULL) free(exp_full);
+    free(forward_fft);
+    free(back_fft);
+    free(abs2);
+    free(step_pot);
+}
+
+
+
+
+
+void SSFFTtd(EqDataPkg EQ, TimePotPkg P, struct TimeRamp * G, int N,
+     double dt, Carray S, char fname[], int n)
+{
+
+/** Same as SSFFT with the potential in EQ->V and interaction  changing
+  * in time according to P and G (G = NULL to keep EQ->inter constant),
+  * either named protocols or user callbacks (see linear_potential.h).
+  * EQ->V is updated in place and end up with the potential at t = N dt.
+  *
+  * The exponential of the linear potential exp(-i dt V / 2) is kept in a
+  * table computed once, and only the points whose potential  changed
+  * are updated, thus for static segments only the nonlinear phase  is
+  * evaluated. The first half-step use V(t) and g(t) and  the  second
+  * V(t+dt) and g(t+dt), that are also the first of the next step **/
+
+
+
+    int
+        k,
+        i,
+        M,
+        m,
+        first,
+        len;
+
+    MKL_LONG
+        s;
+
+    double
+        a2,
+        dx,
+        g,
+        freq;
+
+    double complex
+        E,
+        a1,
+        Idt = 0.0 - dt * I;
+
+    DFTI_DESCRIPTOR_HANDLE
+        desc;
+
+    struct GPObservables
+        obs;
+
+
+
+    Rarray
+        x,
+        V;
+
+    Carray
+        exp_der,
+        exp_pot,
+        forward_fft,
+        back_fft;
+
+    FILE
+        * out_data;
+
+
+
+    M = EQ->Mpos;   // grid size including boudaries
+    m = M - 1;      // grid size excluding boudaries
+
+    x = rarrDef(M);
+    exp_der = carrDef(m);     // Exponential of derivative operators
+    exp_pot = carrDef(M);     // Exponential of linear potential
+    forward_fft = carrDef(m);
+    back_fft = carrDef(m);
+
+    // Open file to write solution at every n time steps
+
+    out_data = fopen(fname, "w");
+
+    if (out_data == NULL)
+    {
+        printf("\n\nERROR: impossible to open file %s\n", fname);
+        exit(EXIT_FAILURE);
+    }
+
+    // Record initial data as first line
+
+    carr_inline(out_data, M, S);
+
+    // unpack equation parameters from structure
+
+    a2 = EQ->a2;
+    a1 = EQ->a1;
+    dx = EQ->dx;
+    V = EQ->V;
+
+    rarrFillInc(M, EQ->xi, dx, x);
+
+
+
+    // Potential, interaction and exponential table at t = 0
+    if (G != NULL) g = rampValue(G, 0);
+    else           g = EQ->inter;
+
+    TimePotentialInit(M, x, P, V);
+    rcarrExp(M, Idt / 2, V, exp_pot);
+
+
+
+    // setup descriptor (MKL implementation of FFT)
+    s = DftiCreateDescriptor(&desc, DFTI_DOUBLE, DFTI_COMPLEX, 1, m);
+    s = DftiSetValue(desc, DFTI_FORWARD_SCALE, 1.0 / sqrt(m));
+    s = DftiSetValue(desc, DFTI_BACKWARD_SCALE, 1.0 / sqrt(m));
+    s = DftiCommitDescriptor(desc);
+
+
+
+    // setup Fourier Frequencies and the exponential of derivative operator
+    for (i = 0; i < m; i++)
+    {
+        if (i <= (m - 1) / 2) { freq = (2 * PI * i) / (m * dx);       }
+        else                  { freq = (2 * PI * (i - m)) / (m * dx); }
+        // exponential of derivative operators
+        exp_der[i] = cexp(Idt * a1 * freq * I - Idt * a2 * freq * freq);
+    }
+
+
+
+    // Header of screen printing
+    printf("\n\n\n");
+    printf("     time            Energy                   Norm");
+    sepline();
+
+
+
+    k = 1;
+    for (i = 0; i < N; i++)
+    {
+
+        // Half step of potential part with V(t) and g(t)
+        carrPhaseMultiply(m, - g * dt / 2, exp_pot, S, forward_fft);
+
+
+
+        // Print in screen to quality and progress control
+        if ( i % 50 == 0 )
+        {
+            Observables(M, dx, a2, a1, g, V, S, OBS_ENERGY | OBS_NORM,
+                        &obs);
+            E = obs.energy;
+            printf(" \n  %.4lf          ", i*dt);
+            printf("%15.7E          ", creal(E));
+            printf("%15.7E          ", obs.norm);
+        }
+
+
+
+        // go to momentum space (MKL use its own threads in the FFT)
+        s = DftiComputeForward(desc, forward_fft);
+        // apply exponential of derivatives
+        carrMultiply(m, exp_der, forward_fft, back_fft);
+        // go back to position space
+        s = DftiComputeBackward(desc, back_fft);
+
+
+
+        // Advance the potential and interaction to t + dt updating only
+        // the exponentials of points whose potential changed
+        len = TimePotentialUpdate(M, x, (i + 1) * dt, P, V, &first);
+        if (len > 0) rcarrExp(len, Idt / 2, V + first, exp_pot + first);
+        if (G != NULL) g = rampValue(G, (i + 1) * dt);
+
+
+
+        // Second half step of potential part with V(t+dt) and g(t+dt)
+        carrPhaseMultiply(m, - g * dt / 2, exp_pot, back_fft, S);
+        S[m] = S[0]; //boundary
+
+
+
+        // RECORD solution if required
+        if (k == n) { carr_inline(out_data, M, S); k = 1; }
+        else        { k = k + 1; }
+    }
+
+    Observables(M, dx, a2, a1, g, V, S, OBS_ENERGY | OBS_NORM, &obs);
+    E = obs.energy;
+    printf(" \n  %.4lf          ", N*dt);
+    printf("%15.7E          ", creal(E));
+    printf("%15.7E          ", obs.norm);
+
+    sepline();
+
+    fclose(out_data);
+
+    s = DftiFreeDescriptor(&desc);
+
+    free(x);
+    free(exp_der);
+    free(exp_pot);
+    free(forward_fft);
+    free(back_fft);
+}
+
+
+
+
+
+void SSFFTsplit(EqDataPkg EQ, int N, double dt, Carray S, char fname[],
+     int n)
+{
+
+/** Same method of SSFFT but the wave function is kept with real and
+  * imaginary parts in separated arrays during the propagation. The
+  * potential part is done by a single fused kernel and the FFTs use
+  * the split complex storage of MKL (DFTI_REAL_REAL). The interleaved
+  * array S is updated only to print/record and at the end.       **/
+
+
+
+    int
+        k,
+        i,
+        M,
+        m,
+        linear,
+        synced;
+
+    MKL_LONG
+        s;
+
+    double
+        a2,
+        dx,
+        g,
+        freq;
+
+    double complex
+        E,
+        a1,
+        Idt = 0.0 - dt * I;
+
+    DFTI_DESCRIPTOR_HANDLE
+        desc;
+
+    struct GPObservables
+        obs;
+
+
+
+    Rarray
+        V;
+
+    SCarray
+        exp_der,
+        exp_half,
+        exp_full,
+        Ssplit;
+
+    FILE
+        * out_data;
+
+
+
+    M = EQ->Mpos;   // grid size including boudaries
+    m = M - 1;      // grid size excluding boudaries
+
+    exp_der = scarrDef(m); // Exponential of derivative operators
+    Ssplit = scarrDef(M);  // wave function with split real/imag parts
+
+    out_data = fopen(fname, "w");
+
+    if (out_data == NULL)
+    {
+        printf("\n\nERROR: impossible to open file %s\n", fname);
+        exit(EXIT_FAILURE);
+    }
+
+    // Record initial data as first line
+
+    carr_inline(out_data, M, S);
+
+    // unpack equation parameters from structure
+
+    a2 = EQ->a2;
+    a1 = EQ->a1;
+    dx = EQ->dx;
+    g = EQ->inter;
+    V = EQ->V;
+
+
+
+    // setup descriptor with real and imaginary parts in separate arrays
+    s = DftiCreateDescriptor(&desc, DFTI_DOUBLE, DFTI_COMPLEX, 1, m);
+    s = DftiSetValue(desc, DFTI_COMPLEX_STORAGE, DFTI_REAL_REAL);
+    s = DftiSetValue(desc, DFTI_FORWARD_SCALE, 1.0 / sqrt(m));
+    s = DftiSetValue(desc, DFTI_BACKWARD_SCALE, 1.0 / sqrt(m));
+    s = DftiCommitDescriptor(desc);
+
+
+
+    // setup Fourier Frequencies and the exponential of derivative operator
+    for (i = 0; i < m; i++)
+    {
+        if (i <= (m - 1) / 2) { freq = (2 * PI * i) / (m * dx);       }
+        else                  { freq = (2 * PI * (i - m)) / (m * dx); }
+        // exponential of derivative operators
+        E = cexp(Idt * a1 * freq * I - Idt * a2 * freq * freq);
+        exp_der->re[i] = creal(E);
+        exp_der->im[i] = cimag(E);
+    }
+
+
+
+    // Header of screen printing
+    printf("\n\n\n");
+    printf("     time            Energy                   Norm");
+    sepline();
+
+
+
+    // Without interaction the exponentials of the potential are computed
+    // once, and consecutive half-steps merged as in SSFFT
+    linear = (g == 0);
+    synced = 1;
+    exp_half = NULL;
+    exp_full = NULL;
+    if (linear)
+    {
+        exp_half = scarrDef(m);
+        exp_full = scarrDef(m);
+        rarrFill(m, 1, exp_half->re);
+        rarrFill(m, 0, exp_half->im);
+        scarrCopy(m, exp_half, exp_full);
+        rscarrExpMultiply(m, Idt / 2, V, exp_half);
+        rscarrExpMultiply(m, Idt, V, exp_full);
+    }
+
+
+
+    carr2split(M, S, Ssplit);
+
+    k = 1;
+    for (i = 0; i < N; i++)
+    {
+
+        // Print in screen to quality and progress control
+        if ( i % 50 == 0 )
+        {
+            split2carr(M, Ssplit, S);
+            Observables(M, dx, a2, a1, g, V, S, OBS_ENERGY | OBS_NORM,
+                        &obs);
+            E = obs.energy;
+            printf(" \n  %.4lf          ", i*dt);
+            printf("%15.7E          ", creal(E));
+            printf("%15.7E          ", obs.norm);
+        }
+
+
+
+        // Apply exponential of potential part (linear and nonlinear)
+        if (!linear)     scarrPotentialStep(m, Idt / 2, V, g, Ssplit);
+        else if (synced) scarrMultiply(m, exp_half, Ssplit, Ssplit);
+
+        // go to momentum space
+        s = DftiComputeForward(desc, Ssplit->re, Ssplit->im);
+        // apply exponential of derivatives
+        scarrMultiply(m, exp_der, Ssplit, Ssplit);
+        // go back to position space
+        s = DftiComputeBackward(desc, Ssplit->re, Ssplit->im);
+
+        // Apply again the full potential part, or merged with the next
+        // step if the solution is not required
+        if (linear)
+        {
+            synced = (k == n || (i + 1) % 50 == 0 || i == N - 1);
+            if (synced) scarrMultiply(m, exp_half, Ssplit, Ssplit);
+            else        scarrMultiply(m, exp_full, Ssplit, Ssplit);
+        }
+        else scarrPotentialStep(m, Idt / 2, V, g, Ssplit);
+        Ssplit->re[m] = Ssplit->re[0]; // boundary
+        Ssplit->im[m] = Ssplit->im[0];
+
+
+
+        // RECORD solution if required
+        if (k == n)
+        {
+            split2carr(M, Ssplit, S);
+            carr_inline(out_data, M, S);
+            k = 1;
+        }
+        else { k = k + 1; }
+    }
+
+    split2carr(M, Ssplit, S);
+
+    Observables(M, dx, a2, a1, g, V, S, OBS_ENERGY | OBS_NORM, &obs);
+    E = obs.energy;
+    printf(" \n  %.4lf          ", N*dt);
+    printf("%15.7E          ", creal(E));
+    printf("%15.7E          ", obs.norm);
+
+    sepline();
+
+    fclose(out_data);
+
+    s = DftiFreeDescriptor(&desc);
+
+    SCarrFree(exp_der);
+    SCarrFree(Ssplit);
+    if (linear)
+    {
+        SCarrFree(exp_half);
+        SCarrFree(exp_full);
+    }
+}
+
+
+
+
+
+void SSFFTsingle(EqDataPkg EQ, int N, double dt, Carray S, char fname[],
+     int n)
+{
+
+/** Same method of SSFFT with the wave function propagated in single
+  * precision, for exploratory scans where 1E-5 relative accuracy is
+  * enough.  The FFTs use a single precision descriptor and the potential
+  * part the single precision vector math functions.  S is updated  only
+  * to print/record and at the end, with the observables computed in
+  * double precision from it. **/
+
+
+
+    int
+        k,
+        i,
+        M,
+        m;
+
+    MKL_LONG
+        s;
+
+    double
+        a2,
+        dx,
+        g,
+        freq;
+
+    double complex
+        E,
+        a1,
+        Idt = 0.0 - dt * I;
+
+    DFTI_DESCRIPTOR_HANDLE
+        desc;
+
+    struct GPObservables
+        obs;
+
+
+
+    Rarray
+        V;
+
+    CFarray
         exp_der,
-        exp_pot,
-        forward_fft,
-        back_fft;
+        Sf;
 
     FILE
-        * out_data = fopen(fname, "w");
+        * out_data;
 
 
 
     M = EQ->Mpos;   // grid size including boudaries
     m = M - 1;      // grid size excluding boudaries
 
-    abs2 = rarrDef(M);      // abs square of wave function
-    step_pot  = rarrDef(M); // time-dependent potential (nonlinear+linear)
-
-    exp_der = carrDef(m);     // Exponential of derivative operators
-    exp_pot = carrDef(M);     // Exponential of potential
-    forward_fft = carrDef(m);
-    back_fft = carrDef(m);
-
-    // Open file to write solution at every n time steps
+    exp_der = cfarrDef(m); // Exponential of derivative operators
+    Sf = cfarrDef(M);      // wave function in single precision
 
     out_data = fopen(fname, "w");
 
@@ -132,24 +793,23 @@ void SSFFT(EqDataPkg EQ, int N, double dt, Carray S, char fname[], int n)
 
 
 
-    // setup descriptor (MKL implementation of FFT)
-    s = DftiCreateDescriptor(&desc, DFTI_DOUBLE, DFTI_COMPLEX, 1, m);
-    s = DftiSetValue(desc, DFTI_FORWARD_SCALE, 1.0 / sqrt(m));
-    s = DftiSetValue(desc, DFTI_BACKWARD_SCALE, 1.0 / sqrt(m));
+    // setup single precision descriptor
+    s = DftiCreateDescriptor(&desc, DFTI_SINGLE, DFTI_COMPLEX, 1, m);
+    s = DftiSetValue(desc, DFTI_FORWARD_SCALE, (float) (1.0 / sqrt(m)));
+    s = DftiSetValue(desc, DFTI_BACKWARD_SCALE, (float) (1.0 / sqrt(m)));
     s = DftiCommitDescriptor(desc);
 
 
 
     // setup Fourier Frequencies and the exponential of derivative operator
-    // The convention for ordering the frequencies is starting from zero go
-    // over positive frequencies and after reached the max. start from  the
-    // max. negative frequency going back to zero.
+    // The exponentials are evaluated in double and then rounded
     for (i = 0; i < m; i++)
     {
         if (i <= (m - 1) / 2) { freq = (2 * PI * i) / (m * dx);       }
         else                  { freq = (2 * PI * (i - m)) / (m * dx); }
         // exponential of derivative operators
-        exp_der[i] = cexp(Idt * a1 * freq * I - Idt * a2 * freq * freq);
+        E = cexp(Idt * a1 * freq * I - Idt * a2 * freq * freq);
+        exp_der[i] = (float complex) E;
     }
 
 
@@ -161,62 +821,59 @@ void SSFFT(EqDataPkg EQ, int N, double dt, Carray S, char fname[], int n)
 
 
 
+    carr2cf(M, S, Sf);
+
     k = 1;
     for (i = 0; i < N; i++)
     {
-        carrAbs2(M, S, abs2);
 
         // Print in screen to quality and progress control
-
-        E = Energy(M, dx, a2, a1, g, V, S);
         if ( i % 50 == 0 )
         {
+            cf2carr(M, Sf, S);
+            Observables(M, dx, a2, a1, g, V, S, OBS_ENERGY | OBS_NORM,
+                        &obs);
+            E = obs.energy;
             printf(" \n  %.4lf          ", i*dt);
             printf("%15.7E          ", creal(E));
-            printf("%15.7E          ", Rsimps(M, abs2, dx));
+            printf("%15.7E          ", obs.norm);
         }
 
 
 
         // Apply exponential of potential part (linear and nonlinear)
-        // When copying data to use Fourier transform it is not used
-        // the boundary grid point assumed to be periodic
-        rarrUpdate(M, V, g, abs2, step_pot);
-        rcarrExp(M, Idt / 2, step_pot, exp_pot);
-        carrMultiply(m, exp_pot, S, forward_fft);
-
-
+        cfarrPotentialStep(m, Idt / 2, V, g, Sf);
 
         // go to momentum space
-        s = DftiComputeForward(desc, forward_fft);
+        s = DftiComputeForward(desc, Sf);
         // apply exponential of derivatives
-        carrMultiply(m, exp_der, forward_fft, back_fft);
+        cfarrMultiply(m, exp_der, Sf, Sf);
         // go back to position space
-        s = DftiComputeBackward(desc, back_fft);
-        carrCopy(m, back_fft, S);
-        S[m] = S[0]; //boundary
-
-
+        s = DftiComputeBackward(desc, Sf);
 
         // Apply again the full potential part
-        carrAbs2(M, S, abs2);
-        rarrUpdate(M, V, g, abs2, step_pot);
-        rcarrExp(M, Idt / 2, step_pot, exp_pot);
-        carrMultiply(m, exp_pot, back_fft, S);
-        S[m] = S[0]; //boundary
+        cfarrPotentialStep(m, Idt / 2, V, g, Sf);
+        Sf[m] = Sf[0]; // boundary
 
 
 
         // RECORD solution if required
-        if (k == n) { carr_inline(out_data, M, S); k = 1; }
-        else        { k = k + 1; }
+        if (k == n)
+        {
+            cf2carr(M, Sf, S);
+            carr_inline(out_data, M, S);
+            k = 1;
+        }
+        else { k = k + 1; }
     }
 
-    carrAbs2(M, S, abs2);
-    E = Energy(M, dx, a2, a1, g, V, S);
+    cf2carr(M, Sf, S);
+
+    Observables(M, dx, a2, a1, g, V, S, OBS_ENERGY | OBS_NORM, &obs);
+    E = obs.energy;
     printf(" \n  %.4lf          ", N*dt);
     printf("%15.7E          ", creal(E));
-    printf("%15.7E          ", Rsimps(M, abs2, dx));
+    printf("%15.7E          ", obs.norm);
 
     sepline();
 
@@ -225,11 +882,215 @@ void SSFFT(EqDataPkg EQ, int N, double dt, Carray S, char fname[], int n)
     s = DftiFreeDescriptor(&desc);
 
     free(exp_der);
-    free(exp_pot);
-    free(forward_fft);
-    free(back_fft);
-    free(abs2);
-    free(step_pot);
+    free(Sf);
+}
+
+
+
+
+
+void SSCNsingle(EqDataPkg EQ, int N, double dt, int cyclic, Carray S,
+     char fname[], int n)
+{
+
+/** Same method of SSCNSM with the wave function propagated in single
+  * precision. The Crank-Nicolson matrices are set up and the  left
+  * hand side factorized once in double (see cftriCyclicFactor), thus
+  * each time-step is a tridiagonal product and two substitution sweeps
+  * over single precision arrays.  S is updated only to print/record
+  * and at the end. **/
+
+
+
+    int
+        k,
+        i,
+        M,
+        m;
+
+    double
+        a2,
+        dx,
+        g;
+
+    double complex
+        E,
+        a1,
+        Idt;
+
+    struct GPObservables
+        obs;
+
+
+
+    Rarray
+        V;
+
+    Carray
+        upper,
+        lower,
+        mid;
+
+    CFarray
+        Sf,
+        rhs,
+        rhs_upper,
+        rhs_lower,
+        rhs_mid;
+
+    CFTriFactMat
+        cnfact;
+
+    FILE
+        * out_data;
+
+
+
+    M = EQ->Mpos; // grid size
+    m = M - 1;    // grid size excluding the boundaries
+
+    Sf = cfarrDef(M);  // wave function in single precision
+    rhs = cfarrDef(m); // RHS of linear system to solve
+
+    // diagonals in double precision with corners in the last elements
+    // of upper and lower as in SSCNSM.
+    upper = carrDef(m);
+    lower = carrDef(m);
+    mid   = carrDef(m);
+
+    // RHS matrix of Crank-Nicolson rounded to single precision
+    rhs_upper = cfarrDef(m);
+    rhs_lower = cfarrDef(m);
+    rhs_mid   = cfarrDef(m);
+
+    cnfact = cftrifactDef(m);
+
+    out_data = fopen(fname, "w");
+    if (out_data == NULL)
+    {
+        printf("\n\nERROR: impossible to open file %s\n", fname);
+        exit(EXIT_FAILURE);
+    }
+
+    // Record initial data as first line
+    carr_inline(out_data, M, S);
+
+    // unpack equation parameters from structure
+    a2 = EQ->a2;
+    a1 = EQ->a1;
+    dx = EQ->dx;
+    g = EQ->inter;
+    V = EQ->V;
+    Idt = 0.0 - dt * I;
+
+
+
+    // RHS matrix from Crank-Nicolson Scheme (use upper as auxiliar)
+    carrFill(m, - a2 * dt / dx / dx + I, upper);
+    rcarrUpdate(m, upper, dt / 2, V, mid);
+
+    carrFill(m, a2 * dt / dx / dx / 2 + a1 * dt / dx / 4, upper);
+    if (cyclic) { upper[m-1] = a2 * dt / dx / dx / 2 - a1 * dt / dx / 4; }
+    else        { upper[m-1] = 0;                                        }
+
+    carrFill(m, a2 * dt / dx / dx / 2 - a1 * dt / dx / 4, lower);
+    if (cyclic) { lower[m-1] = a2 * dt / dx / dx / 2 + a1 * dt / dx / 4; }
+    else        { lower[m-1] = 0;                                        }
+
+    carr2cf(m, upper, rhs_upper);
+    carr2cf(m, lower, rhs_lower);
+    carr2cf(m, mid, rhs_mid);
+
+
+
+    // Cyclic tridiagonal matrix of linear system
+    carrFill(m, a2 * dt / dx /dx + I, upper);
+    rcarrUpdate(m, upper, -dt / 2, V, mid);
+
+    carrFill(m, - a2 * dt / dx / dx / 2 - a1 * dt / dx / 4, upper);
+    if (cyclic) { upper[m-1] = - a2 * dt / dx / dx / 2 + a1 * dt / dx / 4; }
+    else        { upper[m-1] = 0;                                          }
+
+    carrFill(m, - a2 * dt / dx / dx / 2 + a1 * dt / dx / 4, lower);
+    if (cyclic) { lower[m-1] = - a2 * dt / dx / dx / 2 - a1 * dt / dx / 4; }
+    else        { lower[m-1] = 0;                                          }
+
+    cftriCyclicFactor(m, upper, lower, mid, cnfact);
+
+
+
+    // Header of the screen output
+    printf("\n\n\n");
+    printf("     Time            Energy                   Norm");
+    sepline();
+
+
+
+    carr2cf(M, S, Sf);
+
+    k = 1;
+    for (i = 0; i < N; i++)
+    {
+
+        // Print in screen to quality and progress control
+        if ( i % 50 == 0 )
+        {
+            cf2carr(M, Sf, S);
+            Observables(M, dx, a2, a1, g, V, S, OBS_ENERGY | OBS_NORM,
+                        &obs);
+            E = obs.energy;
+            printf(" \n  %.4lf          ", i*dt);
+            printf("%15.7E          ", creal(E));
+            printf("%15.7E          ", obs.norm);
+        }
+
+
+
+        // Apply exponential with nonlinear part (V is in the CN matrices)
+        cfarrPotentialStep(M, Idt / 2, NULL, g, Sf);
+
+        // Solve linear part
+        cfarrTriMultiply(m, rhs_upper, rhs_lower, rhs_mid, Sf, rhs);
+        cftriFactSolve(cnfact, rhs, Sf);
+        if (cyclic) { Sf[M-1] = Sf[0]; } // Cyclic system
+        else        { Sf[M-1] = 0;     } // zero boundary
+
+        // Apply exponential with nonlinear part again
+        cfarrPotentialStep(M, Idt / 2, NULL, g, Sf);
+
+
+
+        // record data every n steps
+        if (k == n)
+        {
+            cf2carr(M, Sf, S);
+            carr_inline(out_data, M, S);
+            k = 1;
+        }
+        else { k = k + 1; }
+    }
+
+    cf2carr(M, Sf, S);
+
+    Observables(M, dx, a2, a1, g, V, S, OBS_ENERGY | OBS_NORM, &obs);
+    E = obs.energy;
+    printf(" \n  %.4lf          ", N*dt);
+    printf("%15.7E          ", creal(E));
+    printf("%15.7E          ", obs.norm);
+
+    sepline();
+
+    fclose(out_data);
+
+    free(Sf);
+    free(rhs);
+    free(upper);
+    free(lower);
+    free(mid);
+    free(rhs_upper);
+    free(rhs_lower);
+    free(rhs_mid);
+    CFTriFactFree(cnfact);
 }
 
 
@@ -273,6 +1134,11 @@ void SSCNLU(EqDataPkg EQ, int N, double dt, int cyclic, Carray S,
         a1,
         Idt;
 
+    struct GPObservables
+        obs;
+
+
+
     Rarray
         V,
         abs2;
@@ -396,13 +1262,14 @@ void SSCNLU(EqDataPkg EQ, int N, double dt, int cyclic, Carray S,
         carrAbs2(M, S, abs2);
 
         // Print in screen to quality and progress control
-        E = Energy(M, dx, a2, a1, g, V, S);
-
         if ( i % 50 == 0 )
         {
+            Observables(M, dx, a2, a1, g, V, S, OBS_ENERGY | OBS_NORM,
+                        &obs);
+            E = obs.energy;
             printf(" \n  %.4lf          ", i*dt);
             printf("%15.7E          ", creal(E));
-            printf("%15.7E          ", Rsimps(M, abs2, dx));
+            printf("%15.7E          ", obs.norm);
         }
 
 
@@ -429,11 +1296,11 @@ void SSCNLU(EqDataPkg EQ, int N, double dt, int cyclic, Carray S,
 
     }
 
-    carrAbs2(M, S, abs2);
-    E = Energy(M, dx, a2, a1, g, V, S);
+    Observables(M, dx, a2, a1, g, V, S, OBS_ENERGY | OBS_NORM, &obs);
+    E = obs.energy;
     printf(" \n  %.4lf          ", N*dt);
     printf("%15.7E          ", creal(E));
-    printf("%15.7E          ", Rsimps(M, abs2, dx));
+    printf("%15.7E          ", obs.norm);
     
     sepline();
 
@@ -474,6 +1341,10 @@ void SSCNSM(EqDataPkg EQ, int N, double dt, int cyclic, Carray S,
         m,
         j;
 
+    int
+        start,
+        len;
+
     double
         a2,
         dx,
@@ -484,6 +1355,11 @@ void SSCNSM(EqDataPkg EQ, int N, double dt, int cyclic, Carray S,
         a1,
         Idt;
 
+    struct GPObservables
+        obs;
+
+
+
     Rarray
         V,
         abs2;
@@ -603,35 +1479,49 @@ void SSCNSM(EqDataPkg EQ, int N, double dt, int cyclic, Carray S,
     k = 1;
     for (i = 0; i < N; i++)
     {
-        
-        carrAbs2(M, S, abs2);
 
-        // Print in screen to quality and progress control
-        E = Energy(M, dx, a2, a1, g, V, S);
+        // Apply exponential with nonlinear part. Each thread work in its
+        // own chunk of the grid in a single parallel region
+        #pragma omp parallel private(start, len) if (ompWorthy(M))
+        {
+            ompChunk(M, &start, &len);
+            carrAbs2(len, S + start, abs2 + start);
+            rcarrExp(len, g * Idt / 2, abs2 + start, exp_pot + start);
+            carrMultiply(len, exp_pot + start, S + start, linpart + start);
+        }
+
 
+
+        // Print in screen to quality and progress control
         if ( i % 50 == 0 )
         {
+            Observables(M, dx, a2, a1, g, V, S, OBS_ENERGY | OBS_NORM,
+                        &obs);
+            E = obs.energy;
             printf(" \n  %.4lf          ", i*dt);
             printf("%15.7E          ", creal(E));
-            printf("%15.7E          ", Rsimps(M, abs2, dx));
+            printf("%15.7E          ", obs.norm);
         }
 
 
 
-        // Apply exponential with nonlinear part
-        rcarrExp(M, g * Idt / 2, abs2, exp_pot);
-        carrMultiply(M, exp_pot, S, linpart);
-
         // Solve linear part
         CCSvec(m, cnmat->vec, cnmat->col, cnmat->m, linpart, rhs);
         triCyclicSM(m, upper, lower, mid, rhs, linpart);
         if (cyclic) { linpart[M-1] = linpart[0]; } // Cyclic system
         else        { linpart[M-1] = 0;          } // zero boundary
 
+
+
         // Apply exponential with nonlinear part again
-        carrAbs2(M, linpart, abs2);
-        rcarrExp(M, g * Idt / 2, abs2, exp_pot);
-        carrMultiply(M, exp_pot, linpart, S);
+        #pragma omp parallel private(start, len) if (ompWorthy(M))
+        {
+            ompChunk(M, &start, &len);
+            carrAbs2(len, linpart + start, abs2 + start);
+            rcarrExp(len, g * Idt / 2, abs2 + start, exp_pot + start);
+            carrMultiply(len, exp_pot + start, linpart + start, S + start);
+        }
+
 
 
         // record data every n steps
@@ -640,11 +1530,11 @@ void SSCNSM(EqDataPkg EQ, int N, double dt, int cyclic, Carray S,
 
     }
 
-    carrAbs2(M, S, abs2);
-    E = Energy(M, dx, a2, a1, g, V, S);
+    Observables(M, dx, a2, a1, g, V, S, OBS_ENERGY | OBS_NORM, &obs);
+    E = obs.energy;
     printf(" \n  %.4lf          ", N*dt);
     printf("%15.7E          ", creal(E));
-    printf("%15.7E          ", Rsimps(M, abs2, dx));
+    printf("%15.7E          ", obs.norm);
     
     sepline();
 
@@ -755,9 +1645,13 @@ void SSCNRK4(EqDataPkg EQ, int N, double dt, int cyclic, Carray S,
         a1,
         g[1];
 
+    struct GPObservables
+        obs;
+
+
+
     Rarray
-        V,
-        abs2;
+        V;
 
     Carray
         linpart,
@@ -780,7 +1674,6 @@ void SSCNRK4(EqDataPkg EQ, int N, double dt, int cyclic, Carray S,
     g[0] = EQ->inter;
     V = EQ->V;
 
-    abs2 = rarrDef(M);    // squared modulus of wave function at grid points
     linpart = carrDef(M); // linear part solution by Finite Differences
 
     // tridiagonal system with additional  cyclic  terms depending on
@@ -867,15 +1760,15 @@ void SSCNRK4(EqDataPkg EQ, int N, double dt, int cyclic, Carray S,
     k = 1;
     for (i = 0; i < N; i++)
     {
-        carrAbs2(M, S, abs2);
-
         // Print in screen to quality and progress control
-        E = Energy(M, dx, a2, a1, g[0], V, S);
         if ( i % 50 == 0 )
         {
+            Observables(M, dx, a2, a1, g[0], V, S, OBS_ENERGY | OBS_NORM,
+                        &obs);
+            E = obs.energy;
             printf(" \n  %.4lf          ", i*dt);
             printf("%15.7E          ", creal(E));
-            printf("%15.7E          ", Rsimps(M, abs2, dx));
+            printf("%15.7E          ", obs.norm);
         }
 
 
@@ -897,11 +1790,11 @@ void SSCNRK4(EqDataPkg EQ, int N, double dt, int cyclic, Carray S,
         else        { k = k + 1;                          }
     }
 
-    carrAbs2(M, S, abs2);
-    E = Energy(M, dx, a2, a1, g[0], V, S);
+    Observables(M, dx, a2, a1, g[0], V, S, OBS_ENERGY | OBS_NORM, &obs);
+    E = obs.energy;
     printf(" \n  %.4lf          ", N*dt);
     printf("%15.7E          ", creal(E));
-    printf("%15.7E          ", Rsimps(M, abs2, dx));
+    printf("%15.7E          ", obs.norm);
 
     sepline();
 
@@ -912,7 +1805,6 @@ void SSCNRK4(EqDataPkg EQ, int N, double dt, int cyclic, Carray S,
     free(lower);
     free(mid);
     free(rhs);
-    free(abs2);
     CCSFree(cnmat);
 }
 
@@ -948,9 +1840,13 @@ void SSFFTRK4(EqDataPkg EQ, int N, double dt, Carray S, char fname[], int n)
         a1,
         Idt = 0 - dt * I;
 
+    struct GPObservables
+        obs;
+
+
+
     Rarray
-        V,
-        abs2;
+        V;
 
     Carray
         argRK4,      // output of linear and nonlinear pot
@@ -982,8 +1878,6 @@ void SSFFTRK4(EqDataPkg EQ, int N, double dt, Carray S, char fname[], int n)
     // Record initial data as first line
     carr_inline(out_data, M, S);
 
-    abs2 = rarrDef(M);
-
     argRK4 = carrDef(M);      // input in RK4
     exp_der = carrDef(m);     // exponential of derivative operator
     forward_fft = carrDef(m); // go to frequency space
@@ -1034,16 +1928,15 @@ void SSFFTRK4(EqDataPkg EQ, int N, double dt, Carray S, char fname[], int n)
     k = 1;
     for (i = 0; i < N; i++)
     {
-
-        carrAbs2(M, S, abs2);
-
         // Print in screen to quality and progress control
-        E = Energy(M, dx, a2, a1, g, V, S);
         if ( i % 50 == 0 )
         {
+            Observables(M, dx, a2, a1, g, V, S, OBS_ENERGY | OBS_NORM,
+                        &obs);
+            E = obs.energy;
             printf(" \n  %.4lf          ", i*dt);
             printf("%15.7E          ", creal(E));
-            printf("%15.7E          ", Rsimps(M, abs2, dx));
+            printf("%15.7E          ", obs.norm);
         }
 
 
@@ -1068,11 +1961,11 @@ void SSFFTRK4(EqDataPkg EQ, int N, double dt, Carray S, char fname[], int n)
 
     }
 
-    carrAbs2(M, S, abs2);
-    E = Energy(M, dx, a2, a1, g, V, S);
+    Observables(M, dx, a2, a1, g, V, S, OBS_ENERGY | OBS_NORM, &obs);
+    E = obs.energy;
     printf(" \n  %.4lf          ", N*dt);
     printf("%15.7E          ", creal(E));
-    printf("%15.7E          ", Rsimps(M, abs2, dx));
+    printf("%15.7E          ", obs.norm);
 
     sepline();
 
@@ -1084,7 +1977,6 @@ void SSFFTRK4(EqDataPkg EQ, int N, double dt, Carray S, char fname[], int n)
     free(forward_fft);
     free(back_fft);
     free(argRK4);
-    free(abs2);
     free(PotArg);
 }
 
@@ -1154,6 +2046,11 @@ void CFDS(EqDataPkg EQ, int N, double dt, int cyclic, Carray S,
 
 
 
+    struct GPObservables
+        obs;
+
+
+
     Rarray
         abs2 = rarrDef(M); // abs square of wave function
 
@@ -1247,21 +2144,21 @@ void CFDS(EqDataPkg EQ, int N, double dt, int cyclic, Carray S,
     k = 1;
     for (i = 0; i < N; i++)
     {
-
-        carrAbs2(M, S, abs2);
-
         // Print in screen to quality and progress control
-        aux = Energy(M, dx, a2, a1, inter, V, S);
         if ( i % 50 == 0 )
         {
+            Observables(M, dx, a2, a1, inter, V, S, OBS_ENERGY | OBS_NORM,
+                        &obs);
+            aux = obs.energy;
             printf(" \n  %7d          ", i);
             printf("%15.7E          ", creal(aux));
-            printf("%15.7E          ", Rsimps(M, abs2, dx));
+            printf("%15.7E          ", obs.norm);
         }
 
 
 
         // Apply exponential with nonlinear part
+        carrAbs2(M, S, abs2);
         rcarrExp(M, inter * Idt / 2, abs2, stepexp);
         carrMultiply(M, stepexp, S, linpart);
 
@@ -1328,11 +2225,11 @@ void CFDS(EqDataPkg EQ, int N, double dt, int cyclic, Carray S,
 
     }
 
-    carrAbs2(M, S, abs2);
-    aux = Energy(M, dx, a2, a1, inter, V, S);
+    Observables(M, dx, a2, a1, inter, V, S, OBS_ENERGY | OBS_NORM, &obs);
+    aux = obs.energy;
     printf(" \n  %7d          ", N);
     printf("%15.7E          ", creal(aux));
-    printf("%15.7E          ", Rsimps(M, abs2, dx));
+    printf("%15.7E          ", obs.norm);
 
     sepline();
 
@@ -1340,7 +2237,6 @@ void CFDS(EqDataPkg EQ, int N, double dt, int cyclic, Carray S,
 
     free(stepexp);
     free(linpart);
-    free(abs2);
     free(upper);
     free(lower);
     free(mid);
@@ -1419,8 +2315,12 @@ void sineDVR(EqDataPkg EQ, int N, double dt, Carray S, char fname[], int n)
         E,
         a1;
 
+    struct GPObservables
+        obs;
+
+
+
     Rarray
-        abs2,
         D1mat,
         D2mat,
         uDVR;
@@ -1445,7 +2345,6 @@ void sineDVR(EqDataPkg EQ, int N, double dt, Carray S, char fname[], int n)
 
     L = (M + 1) * dx; // length of the sine DVR box
 
-    abs2 = rarrDef(M);
 
     D1mat = rarrDef(M * M); // derivative matrix
     D2mat = rarrDef(M);     // second derivative matrix(diagonal)
@@ -1595,15 +2494,15 @@ void sineDVR(EqDataPkg EQ, int N, double dt, Carray S, char fname[], int n)
     k = 1;
     for (i = 0; i < N; i++)
     {
-        carrAbs2(M, S, abs2);
-
         // Print in screen to quality and progress control
-        E = Energy(M, dx, a2, a1, g, EQ->V, S);
         if ( i % 50 == 0 )
         {
+            Observables(M, dx, a2, a1, g, EQ->V, S, OBS_ENERGY | OBS_NORM,
+                        &obs);
+            E = obs.energy;
             printf(" \n  %.4lf          ", i*dt);
             printf("%15.7E          ", creal(E));
-            printf("%15.7E          ", Rsimps(M,abs2,dx));
+            printf("%15.7E          ", obs.norm);
         }
 
 
@@ -1624,17 +2523,16 @@ void sineDVR(EqDataPkg EQ, int N, double dt, Carray S, char fname[], int n)
         else        { k = k + 1;                          }
     }
 
-    carrAbs2(M, S, abs2);
-    E = Energy(M, dx, a2, a1, g, EQ->V, S);
+    Observables(M, dx, a2, a1, g, EQ->V, S, OBS_ENERGY | OBS_NORM, &obs);
+    E = obs.energy;
     printf(" \n  %.4lf          ",N*dt);
     printf("%15.7E          ",creal(E));
-    printf("%15.7E          ",Rsimps(M,abs2,dx));
+    printf("%15.7E          ",obs.norm);
 
     sepline();
 
     fclose(out_data);
 
-    free(abs2);
     free(aDVR);
     free(RK4arg);
 }
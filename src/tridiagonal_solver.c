@@ -124,6 +124,513 @@ double complex checkLU(int n, Carray upper, Carray lower, Carray mid)
 
 
 
+/*          ***********************************************
+
+                 PARTITIONED (SPIKE) TRIDIAGONAL SOLVER
+
+            ***********************************************          */
+
+
+
+/* For large systems the rows are split in one contiguous partition per
+ * thread. Each thread solve its own partition by the Thomas algorithm
+ * for the RHS and for the two 'spikes', the columns that  couple  the
+ * partition to its neighbors. The solution of  a  partition  k  is
+ *
+ *      x = y - v x[first(k) - 1] - w x[last(k) + 1]
+ *
+ * and the unknowns at the borders of the partitions satisfy a reduced
+ * system of 2 (p - 1) equations, block tridiagonal with 2x2 blocks, in
+ * the pairs (x[last(k)], x[first(k + 1)]), that is solved by a single
+ * thread. At the end every thread correct its partition. It  does about
+ * 2.5 times the operations of the Thomas algorithm, then it is used for
+ * at least 3 threads. Like the Thomas algorithm there is no pivoting. */
+
+
+
+#ifdef _OPENMP
+
+
+
+static int spikeWorthy(int n)
+{
+    if (omp_get_max_threads() < 3) return 0;
+    if (n < 8 * omp_get_max_threads()) return 0;
+    return ompWorthy(n);
+}
+
+
+
+static void spikeBlock(int len, Carray upper, Carray lower, Carray mid,
+       Carray f, double complex vl, double complex wr, Carray u, Carray y,
+       Carray v, Carray w)
+{
+
+/** Thomas algorithm in a partition for the RHS f (solution in y),  the
+  * left spike vl e_first (solution in v) and right spike wr e_last (in
+  * w). The diagonals are given starting from the partition first row **/
+
+    int
+        i,
+        i0;
+
+    double complex
+        l;
+
+    if (mid[0] == 0)
+    {
+        // Only possible in the first partition (vl = 0). Do the  same
+        // system reduction of triDiag: x1 is given by first equation
+        // and [x0 x2 x3 ...] solves a tridiagonal system
+        y[1] = f[0] / upper[0];
+        v[1] = 0;
+        w[1] = 0;
+
+        u[0] = lower[0];
+        y[0] = f[1] - mid[1] * y[1];
+        v[0] = 0;
+        w[0] = 0;
+
+        u[2] = mid[2];
+        y[2] = f[2] - lower[1] * y[1];
+        v[2] = 0;
+        w[2] = 0;
+
+        i0 = 3;
+    }
+    else
+    {
+        u[0] = mid[0];
+        y[0] = f[0];
+        v[0] = vl;
+        w[0] = 0;
+
+        i0 = 1;
+    }
+
+    for (i = i0; i < len; i++)
+    {
+        l = lower[i-1] / u[i-1];
+        u[i] = mid[i] - l * upper[i-1];
+        y[i] = f[i] - l * y[i-1];
+        v[i] = - l * v[i-1];
+        w[i] = 0;
+    }
+
+    y[len-1] = y[len-1] / u[len-1];
+    v[len-1] = v[len-1] / u[len-1];
+    w[len-1] = wr / u[len-1];
+
+    for (i = len - 2; i >= i0 - 1; i--)
+    {
+        y[i] = (y[i] - upper[i] * y[i+1]) / u[i];
+        v[i] = (v[i] - upper[i] * v[i+1]) / u[i];
+        w[i] = (w[i] - upper[i] * w[i+1]) / u[i];
+    }
+
+    if (i0 == 3)
+    {
+        // unknown x0 was stored in position 0 with pivot u[0]
+        y[0] = (y[0] - upper[1] * y[2]) / u[0];
+        w[0] = (w[0] - upper[1] * w[2]) / u[0];
+    }
+}
+
+
+
+static void spikeReduced(int p, int * pos, Carray y, Carray v, Carray w,
+       Carray xl, Carray xf)
+{
+
+/** Solve the reduced system for the pairs a = x[last(k)] and b =
+  * x[first(k+1)], k = 0, ..., p - 2 with the 2x2 blocks
+  *
+  *     | 1    wl |         | vl  0 |           | 0   0  |
+  * D = |         |     L = |       |       U = |        |
+  *     | vf   1  |         | 0   0 |           | 0   wf |
+  *
+  * by block LU where only the upper right element c of D changes. The
+  * results are set in xl[k] = x[last(k)] and xf[k+1] = x[first(k+1)] **/
+
+    int
+        k,
+        e;
+
+    double complex
+        vl,
+        vf,
+        wf,
+        det;
+
+    Carray
+        c,
+        g0,
+        g1;
+
+    c = carrDef(p);
+    g0 = carrDef(p);
+    g1 = carrDef(p);
+
+    c[0] = w[pos[1] - 1];
+    g0[0] = y[pos[1] - 1];
+    g1[0] = y[pos[1]];
+
+    for (k = 1; k < p - 1; k++)
+    {
+        e = pos[k + 1];
+        vl = v[e - 1];
+        vf = v[pos[k]];
+        wf = w[pos[k]];
+        det = 1 - c[k-1] * vf;
+        c[k] = w[e - 1] + vl * wf * c[k-1] / det;
+        g0[k] = y[e - 1] - vl * (g0[k-1] - c[k-1] * g1[k-1]) / det;
+        g1[k] = y[e];
+    }
+
+    for (k = p - 2; k >= 0; k--)
+    {
+        e = pos[k + 1];
+        if (k < p - 2) g1[k] = g1[k] - w[e] * xf[k + 2];
+        vf = v[e];
+        det = 1 - c[k] * vf;
+        xl[k] = (g0[k] - c[k] * g1[k]) / det;
+        xf[k + 1] = (g1[k] - vf * g0[k]) / det;
+    }
+
+    free(c);
+    free(g0);
+    free(g1);
+}
+
+
+
+static int triDiagSpike(int n, Carray upper, Carray lower, Carray mid,
+       Carray RHS, Carray ans)
+{
+
+/** Partitioned solver of tridiagonal system, see the notes above.
+  * Return 0, without touching ans, if the team of threads formed  has
+  * less than 3 threads, and then the caller must use Thomas algorithm **/
+
+    int
+        i,
+        p,
+        id,
+        start,
+        len,
+        * pos;
+
+    double complex
+        vl,
+        wr;
+
+    Carray
+        u,
+        v,
+        w,
+        xl,
+        xf;
+
+    p = omp_get_max_threads();
+
+    pos = (int *) malloc((p + 1) * sizeof(int));
+    xl = carrDef(p);
+    xf = carrDef(p);
+    u = carrDef(n);
+    v = carrDef(n);
+    w = carrDef(n);
+
+    #pragma omp parallel private(i, id, start, len, vl, wr)
+    {
+        id = omp_get_thread_num();
+        ompChunk(n, &start, &len);
+        pos[id] = start;
+
+        #pragma omp single
+        {
+            p = omp_get_num_threads();
+            pos[p] = n;
+        }
+
+        // The team may be smaller than asked (thread limit or dynamic
+        // adjustment). All threads see the same p after the single
+        if (p >= 3)
+        {
+            vl = 0;
+            wr = 0;
+            if (start > 0) vl = lower[start - 1];
+            if (start + len < n) wr = upper[start + len - 1];
+
+            spikeBlock(len, upper + start, lower + start, mid + start,
+                    RHS + start, vl, wr, u + start, ans + start, v + start,
+                    w + start);
+
+            #pragma omp barrier
+
+            #pragma omp single
+            spikeReduced(p, pos, ans, v, w, xl, xf);
+
+            // correct the partition with the border values of neighbors
+            if (id > 0)
+            {
+                for (i = start; i < start + len; i++)
+                {
+                    ans[i] = ans[i] - v[i] * xl[id - 1];
+                }
+            }
+            if (id < p - 1)
+            {
+                for (i = start; i < start + len; i++)
+                {
+                    ans[i] = ans[i] - w[i] * xf[id + 1];
+                }
+            }
+        }
+    }
+
+    free(pos);
+    free(xl);
+    free(xf);
+    free(u);
+    free(v);
+    free(w);
+
+    return p >= 3;
+}
+
+
+
+static void rspikeBlock(int len, Rarray upper, Rarray lower, Rarray mid,
+       Rarray f, double vl, double wr, Rarray u, Rarray y,
+       Rarray v, Rarray w)
+{
+
+/** Real version of spikeBlock **/
+
+    int
+        i,
+        i0;
+
+    double
+        l;
+
+    if (mid[0] == 0)
+    {
+        // Only possible in the first partition (vl = 0). Do the  same
+        // system reduction of triDiag: x1 is given by first equation
+        // and [x0 x2 x3 ...] solves a tridiagonal system
+        y[1] = f[0] / upper[0];
+        v[1] = 0;
+        w[1] = 0;
+
+        u[0] = lower[0];
+        y[0] = f[1] - mid[1] * y[1];
+        v[0] = 0;
+        w[0] = 0;
+
+        u[2] = mid[2];
+        y[2] = f[2] - lower[1] * y[1];
+        v[2] = 0;
+        w[2] = 0;
+
+        i0 = 3;
+    }
+    else
+    {
+        u[0] = mid[0];
+        y[0] = f[0];
+        v[0] = vl;
+        w[0] = 0;
+
+        i0 = 1;
+    }
+
+    for (i = i0; i < len; i++)
+    {
+        l = lower[i-1] / u[i-1];
+        u[i] = mid[i] - l * upper[i-1];
+        y[i] = f[i] - l * y[i-1];
+        v[i] = - l * v[i-1];
+        w[i] = 0;
+    }
+
+    y[len-1] = y[len-1] / u[len-1];
+    v[len-1] = v[len-1] / u[len-1];
+    w[len-1] = wr / u[len-1];
+
+    for (i = len - 2; i >= i0 - 1; i--)
+    {
+        y[i] = (y[i] - upper[i] * y[i+1]) / u[i];
+        v[i] = (v[i] - upper[i] * v[i+1]) / u[i];
+        w[i] = (w[i] - upper[i] * w[i+1]) / u[i];
+    }
+
+    if (i0 == 3)
+    {
+        // unknown x0 was stored in position 0 with pivot u[0]
+        y[0] = (y[0] - upper[1] * y[2]) / u[0];
+        w[0] = (w[0] - upper[1] * w[2]) / u[0];
+    }
+}
+
+
+
+static void rspikeReduced(int p, int * pos, Rarray y, Rarray v, Rarray w,
+       Rarray xl, Rarray xf)
+{
+
+/** Real version of spikeReduced **/
+
+    int
+        k,
+        e;
+
+    double
+        vl,
+        vf,
+        wf,
+        det;
+
+    Rarray
+        c,
+        g0,
+        g1;
+
+    c = rarrDef(p);
+    g0 = rarrDef(p);
+    g1 = rarrDef(p);
+
+    c[0] = w[pos[1] - 1];
+    g0[0] = y[pos[1] - 1];
+    g1[0] = y[pos[1]];
+
+    for (k = 1; k < p - 1; k++)
+    {
+        e = pos[k + 1];
+        vl = v[e - 1];
+        vf = v[pos[k]];
+        wf = w[pos[k]];
+        det = 1 - c[k-1] * vf;
+        c[k] = w[e - 1] + vl * wf * c[k-1] / det;
+        g0[k] = y[e - 1] - vl * (g0[k-1] - c[k-1] * g1[k-1]) / det;
+        g1[k] = y[e];
+    }
+
+    for (k = p - 2; k >= 0; k--)
+    {
+        e = pos[k + 1];
+        if (k < p - 2) g1[k] = g1[k] - w[e] * xf[k + 2];
+        vf = v[e];
+        det = 1 - c[k] * vf;
+        xl[k] = (g0[k] - c[k] * g1[k]) / det;
+        xf[k + 1] = (g1[k] - vf * g0[k]) / det;
+    }
+
+    free(c);
+    free(g0);
+    free(g1);
+}
+
+
+
+static int realtriSpike(int n, Rarray upper, Rarray lower, Rarray mid,
+       Rarray RHS, Rarray ans)
+{
+
+/** Real version of triDiagSpike **/
+
+    int
+        i,
+        p,
+        id,
+        start,
+        len,
+        * pos;
+
+    double
+        vl,
+        wr;
+
+    Rarray
+        u,
+        v,
+        w,
+        xl,
+        xf;
+
+    p = omp_get_max_threads();
+
+    pos = (int *) malloc((p + 1) * sizeof(int));
+    xl = rarrDef(p);
+    xf = rarrDef(p);
+    u = rarrDef(n);
+    v = rarrDef(n);
+    w = rarrDef(n);
+
+    #pragma omp parallel private(i, id, start, len, vl, wr)
+    {
+        id = omp_get_thread_num();
+        ompChunk(n, &start, &len);
+        pos[id] = start;
+
+        #pragma omp single
+        {
+            p = omp_get_num_threads();
+            pos[p] = n;
+        }
+
+        // The team may be smaller than asked (thread limit or dynamic
+        // adjustment). All threads see the same p after the single
+        if (p >= 3)
+        {
+            vl = 0;
+            wr = 0;
+            if (start > 0) vl = lower[start - 1];
+            if (start + len < n) wr = upper[start + len - 1];
+
+            rspikeBlock(len, upper + start, lower + start, mid + start,
+                    RHS + start, vl, wr, u + start, ans + start, v + start,
+                    w + start);
+
+            #pragma omp barrier
+
+            #pragma omp single
+            rspikeReduced(p, pos, ans, v, w, xl, xf);
+
+            // correct the partition with the border values of neighbors
+            if (id > 0)
+            {
+                for (i = start; i < start + len; i++)
+                {
+                    ans[i] = ans[i] - v[i] * xl[id - 1];
+                }
+            }
+            if (id < p - 1)
+            {
+                for (i = start; i < start + len; i++)
+                {
+                    ans[i] = ans[i] - w[i] * xf[id + 1];
+                }
+            }
+        }
+    }
+
+    free(pos);
+    free(xl);
+    free(xf);
+    free(u);
+    free(v);
+    free(w);
+
+    return p >= 3;
+}
+
+
+
+#endif
+
+
+
 /*          ***********************************************
 
                           TRIDIAGONAL SOLVERS
@@ -155,6 +662,11 @@ void triDiag(int n, Carray upper, Carray lower, Carray mid, Carray RHS,
 
 
 
+#ifdef _OPENMP
+    // fall to the Thomas algorithm if the team has less than 3 threads
+    if (spikeWorthy(n) && triDiagSpike(n, upper, lower, mid, RHS, ans)) return;
+#endif
+
     u = carrDef(n);
     l = carrDef(n - 1);
     z = carrDef(n);
@@ -238,6 +750,110 @@ void triDiag(int n, Carray upper, Carray lower, Carray mid, Carray RHS,
 
 
 
+static void rowCombine(int k, double complex a, Carray x, double complex b,
+       Carray y, Carray v)
+{
+
+/** v[j] = a x[j] + b y[j] for j < k written with real arithmetic, thus
+  * the compiler vectorize the loop along the k right hand sides **/
+
+    int
+        j;
+
+    double
+        ar = creal(a),
+        ai = cimag(a),
+        br = creal(b),
+        bi = cimag(b),
+        re,
+        im,
+        * xx = (double *) x,
+        * yy = (double *) y,
+        * vv = (double *) v;
+
+    for (j = 0; j < k; j++)
+    {
+        re = ar * xx[2*j] - ai * xx[2*j+1] + br * yy[2*j] - bi * yy[2*j+1];
+        im = ar * xx[2*j+1] + ai * xx[2*j] + br * yy[2*j+1] + bi * yy[2*j];
+        vv[2*j] = re;
+        vv[2*j+1] = im;
+    }
+}
+
+
+
+void triDiagMulti(int n, int k, Carray upper, Carray lower, Carray mid,
+     Carray RHS, Carray ans)
+{
+
+/** Solve a tridiagonal system for k right hand sides at once. The RHS
+  * and the solutions are interleaved, RHS[i * k + j] is the  row  i  of
+  * the j-th vector. The factorization is done only once, and  in  each
+  * row the operations sweep the k vectors in contiguous memory.   Allow
+  * mid[0] = 0 with the same system reduction of triDiag. **/
+
+    int
+        i,
+        i0;
+
+    double complex
+        l;
+
+    Carray
+        u; // inverse of the pivots
+
+    u = carrDef(n);
+
+    if (cabs(mid[0]) == 0)
+    {
+        // row 1 of solutions is given by the first equation and
+        // [x0 x2 x3 ...] solves a tridiagonal system, with x0 in
+        // the row 0 of ans
+        rowCombine(k, 1.0 / upper[0], RHS, 0, RHS, ans + k);
+
+        u[0] = 1.0 / lower[0];
+        rowCombine(k, 1, RHS + k, - mid[1], ans + k, ans);
+
+        u[2] = 1.0 / mid[2];
+        rowCombine(k, 1, RHS + 2 * k, - lower[1], ans + k, ans + 2 * k);
+
+        i0 = 3;
+    }
+    else
+    {
+        u[0] = 1.0 / mid[0];
+        carrCopy(k, RHS, ans);
+
+        i0 = 1;
+    }
+
+    for (i = i0; i < n; i++)
+    {
+        l = lower[i-1] * u[i-1];
+        u[i] = 1.0 / (mid[i] - l * upper[i-1]);
+        rowCombine(k, 1, RHS + i * k, - l, ans + (i - 1) * k, ans + i * k);
+    }
+
+    carrScalarMultiply(k, ans + (n - 1) * k, u[n-1], ans + (n - 1) * k);
+
+    for (i = n - 2; i >= i0 - 1; i--)
+    {
+        rowCombine(k, u[i], ans + i * k, - upper[i] * u[i],
+                   ans + (i + 1) * k, ans + i * k);
+    }
+
+    if (i0 == 3)
+    {
+        rowCombine(k, u[0], ans, - upper[1] * u[0], ans + 2 * k, ans);
+    }
+
+    free(u);
+}
+
+
+
+
+
 void triCyclicLU(int n, Carray upper, Carray lower, Carray mid, Carray RHS,
      Carray ans)
 {
@@ -330,6 +946,45 @@ void triCyclicLU(int n, Carray upper, Carray lower, Carray mid, Carray RHS,
 
 
 
+static void triCyclicPair(int n, Carray upper, Carray lower, Carray mid,
+       Carray RHS, Carray U, Carray x, Carray w)
+{
+
+/** Solve the two tridiagonal systems of Sherman-Morrison formula with a
+  * single factorization, interleaving RHS and U as 2 right hand sides **/
+
+    int
+        i;
+
+    Carray
+        B,
+        X;
+
+    B = carrDef(2 * n);
+    X = carrDef(2 * n);
+
+    for (i = 0; i < n; i++)
+    {
+        B[2 * i] = RHS[i];
+        B[2 * i + 1] = U[i];
+    }
+
+    triDiagMulti(n, 2, upper, lower, mid, B, X);
+
+    for (i = 0; i < n; i++)
+    {
+        x[i] = X[2 * i];
+        w[i] = X[2 * i + 1];
+    }
+
+    free(B);
+    free(X);
+}
+
+
+
+
+
 void triCyclicSM(int n, Carray upper, Carray lower, Carray mid,
                  Carray RHS, Carray ans)
 {
@@ -386,13 +1041,20 @@ void triCyclicSM(int n, Carray upper, Carray lower, Carray mid,
     // Adjust last main diagonal element(required by the algorithm)
     mid[n-1] = mid[n-1] - upper[n-1] * lower[n-1] / factor;
 
-    #pragma omp parallel sections
+#ifdef _OPENMP
+    if (spikeWorthy(n))
     {
-        #pragma omp section
+        // each solve already use all threads
         triDiag(n, upper, lower, mid, RHS, x);
-        #pragma omp section
         triDiag(n, upper, lower, mid, U, w);
     }
+    else
+    {
+        triCyclicPair(n, upper, lower, mid, RHS, U, x, w);
+    }
+#else
+    triCyclicPair(n, upper, lower, mid, RHS, U, x, w);
+#endif
 
     factor = unconj_carrDot(n, V, x) / (1.0 + unconj_carrDot(n, V, w));
 
@@ -436,6 +1098,11 @@ void realtri(int n, Rarray upper, Rarray lower, Rarray mid, Rarray RHS,
         l,
         z;
 
+#ifdef _OPENMP
+    // fall to the Thomas algorithm if the team has less than 3 threads
+    if (spikeWorthy(n) && realtriSpike(n, upper, lower, mid, RHS, ans)) return;
+#endif
+
     u = rarrDef(n);
     l = rarrDef(n - 1);
     z = rarrDef(n);
@@ -514,3 +1181,524 @@ void realtri(int n, Rarray upper, Rarray lower, Rarray mid, Rarray RHS,
     free(z);
 
 }
+
+
+
+
+
+static void rtriFactor(int n, Rarray upper, Rarray lower, Rarray mid,
+       double top, double bottom, RTriFactMat F)
+{
+
+/** Factorize once a real tridiagonal matrix with corner elements top and
+  * bottom. If both corners are zero it is just a plain tridiagonal. Else
+  * the Sherman-Morrison formula is used with gamma = - mid[0] (or upper
+  * diagonal if mid[0] = 0 as in triCyclicSM),  so the first pivot of
+  * the modified matrix is never zero, and the correction vector z  is
+  * also computed here. **/
+
+    int
+        i;
+
+    double
+        gamma,
+        pivot;
+
+    Rarray
+        u;
+
+    F->n = n;
+    F->cyclic = (top != 0 || bottom != 0);
+
+    rarrCopy(n - 1, upper, F->upper);
+
+    gamma = - mid[0];
+    if (mid[0] == 0) gamma = upper[0];
+
+    pivot = mid[0];
+    if (F->cyclic) pivot = mid[0] - gamma;
+
+    if (pivot == 0)
+    {
+        printf("\n\n\tERROR : zero first pivot in tridiagonal factorization");
+        printf("\n\n");
+        exit(EXIT_FAILURE);
+    }
+
+    F->uinv[0] = 1.0 / pivot;
+    for (i = 1; i < n; i++)
+    {
+        F->l[i-1] = lower[i-1] * F->uinv[i-1];
+        pivot = mid[i] - F->l[i-1] * upper[i-1];
+        if (i == n - 1 && F->cyclic) pivot = pivot - top * bottom / gamma;
+        F->uinv[i] = 1.0 / pivot;
+    }
+
+    if (!F->cyclic) return;
+
+    // Sherman-Morrison: A = T + u v^T with u = [gamma 0 ... 0 bottom]
+    // and v = [1 0 ... 0 top/gamma].  Solve T z = u once
+    u = rarrDef(n);
+    rarrFill(n, 0, u);
+    u[0] = gamma;
+    u[n-1] = bottom;
+
+    F->cyclic = 0;
+    realtriFactSolve(F, 1, u, F->z);
+    F->cyclic = 1;
+
+    F->vlast = top / gamma;
+    F->denom = 1.0 + F->z[0] + F->vlast * F->z[n-1];
+
+    free(u);
+}
+
+
+
+
+
+void realtriFactor(int n, Rarray upper, Rarray lower, Rarray mid,
+     RTriFactMat F)
+{
+
+/** Factorize once a real tridiagonal matrix. upper and lower have size
+  * n - 1 as in realtri, but the first pivot mid[0] must be nonzero **/
+
+    rtriFactor(n, upper, lower, mid, 0, 0, F);
+}
+
+
+
+
+
+void realtriCyclicFactor(int n, Rarray upper, Rarray lower, Rarray mid,
+     RTriFactMat F)
+{
+
+/** Factorize once a real cyclic tridiagonal matrix, with the corner
+  * elements in upper[n-1] (top) and lower[n-1] (bottom) as  in  the
+  * complex triCyclicSM **/
+
+    rtriFactor(n, upper, lower, mid, upper[n-1], lower[n-1], F);
+}
+
+
+
+
+
+void realtriFactSolve(RTriFactMat F, int k, Rarray RHS, Rarray ans)
+{
+
+/** Solve for k right hand sides interleaved (RHS[i * k + j] is the row
+  * i of the j-th vector) with a factorization from realtriCyclicFactor.
+  * The loops over the k vectors are contiguous in memory. **/
+
+    int
+        i,
+        j,
+        n;
+
+    double
+        l,
+        c,
+        s;
+
+    Rarray
+        upper,
+        uinv,
+        z;
+
+    n = F->n;
+    upper = F->upper;
+    uinv = F->uinv;
+    z = F->z;
+
+    for (j = 0; j < k; j++) ans[j] = RHS[j];
+
+    for (i = 1; i < n; i++)
+    {
+        l = F->l[i-1];
+        for (j = 0; j < k; j++)
+        {
+            ans[i*k + j] = RHS[i*k + j] - l * ans[(i-1)*k + j];
+        }
+    }
+
+    c = uinv[n-1];
+    for (j = 0; j < k; j++) ans[(n-1)*k + j] = c * ans[(n-1)*k + j];
+
+    for (i = n - 2; i >= 0; i--)
+    {
+        c = uinv[i];
+        l = upper[i] * uinv[i];
+        for (j = 0; j < k; j++)
+        {
+            ans[i*k + j] = c * ans[i*k + j] - l * ans[(i+1)*k + j];
+        }
+    }
+
+    if (!F->cyclic) return;
+
+    for (j = 0; j < k; j++)
+    {
+        s = (ans[j] + F->vlast * ans[(n-1)*k + j]) / F->denom;
+        for (i = 0; i < n; i++) ans[i*k + j] = ans[i*k + j] - s * z[i];
+    }
+}
+
+
+
+            /*****************************************
+
+               COMPLEX SYSTEMS WITH PURE IMAGINARY
+                        MATRIX COEFFICIENTS
+
+             *****************************************/
+
+
+
+RTriFactMat triCyclicImagFactor(int n, Carray upper, Carray lower,
+            Carray mid)
+{
+
+/** If all the coefficients of the cyclic tridiagonal matrix A are  pure
+  * imaginary, as in Crank-Nicolson for imaginary time without first
+  * order derivative, return the factorization of the real matrix
+  * R = A / i, otherwise return NULL. Thus a system A x = b may be solved
+  * as R x = - i b with half of operations of the complex arithmetic. **/
+
+    int
+        i;
+
+    RTriFactMat
+        F;
+
+    Rarray
+        ru,
+        rl,
+        rm;
+
+    for (i = 0; i < n; i++)
+    {
+        if (creal(upper[i]) != 0) return NULL;
+        if (creal(lower[i]) != 0) return NULL;
+        if (creal(mid[i]) != 0) return NULL;
+    }
+
+    ru = rarrDef(n);
+    rl = rarrDef(n);
+    rm = rarrDef(n);
+
+    carrImagPart(n, upper, ru);
+    carrImagPart(n, lower, rl);
+    carrImagPart(n, mid, rm);
+
+    F = rtrifactDef(n);
+    realtriCyclicFactor(n, ru, rl, rm, F);
+
+    free(ru);
+    free(rl);
+    free(rm);
+
+    return F;
+}
+
+
+
+
+
+void triCyclicFactSolve(RTriFactMat F, Carray RHS, Carray ans)
+{
+
+/** Solve R x = RHS with complex RHS and real factorized matrix R. The
+  * real and imaginary parts are interleaved in memory,  thus they are
+  * handled as 2 real right hand sides without any copy **/
+
+    realtriFactSolve(F, 2, (double *) RHS, (double *) ans);
+}
+
+
+
+
+
+            /*****************************************
+
+               COMPLEX CYCLIC SYSTEMS FACTORIZED IN
+                 DOUBLE AND SOLVED IN SINGLE PRECISION
+
+             *****************************************/
+
+
+
+void cftriCyclicFactor(int n, Carray upper, Carray lower, Carray mid,
+     CFTriFactMat F)
+{
+
+/** Factorize once a complex cyclic tridiagonal matrix, with corners as in
+  * triCyclicSM, following the same steps of rtriFactor.  The pivots and
+  * the Sherman-Morrison vector are computed in double and only rounded
+  * to single precision when stored,  thus the  factorization  does  not
+  * accumulate round-off errors of single precision arithmetic **/
+
+    int
+        i;
+
+    double complex
+        top,
+        bottom,
+        gamma,
+        pivot;
+
+    Carray
+        l,
+        uinv,
+        z;
+
+    top = upper[n-1];
+    bottom = lower[n-1];
+
+    l = carrDef(n);
+    uinv = carrDef(n);
+    z = carrDef(n);
+
+    F->n = n;
+    F->cyclic = (top != 0 || bottom != 0);
+
+    gamma = - mid[0];
+    if (mid[0] == 0) gamma = upper[0];
+
+    pivot = mid[0];
+    if (F->cyclic) pivot = mid[0] - gamma;
+
+    if (pivot == 0)
+    {
+        printf("\n\n\tERROR : zero first pivot in tridiagonal factorization");
+        printf("\n\n");
+        exit(EXIT_FAILURE);
+    }
+
+    uinv[0] = 1.0 / pivot;
+    for (i = 1; i < n; i++)
+    {
+        l[i-1] = lower[i-1] * uinv[i-1];
+        pivot = mid[i] - l[i-1] * upper[i-1];
+        if (i == n - 1 && F->cyclic) pivot = pivot - top * bottom / gamma;
+        uinv[i] = 1.0 / pivot;
+    }
+
+    for (i = 0; i < n - 1; i++)
+    {
+        F->upper[i] = upper[i];
+        F->l[i] = l[i];
+    }
+    for (i = 0; i < n; i++) F->uinv[i] = uinv[i];
+
+    if (F->cyclic)
+    {
+        // Sherman-Morrison: solve T z = u with u = [gamma 0 ... 0 bottom]
+        carrFill(n, 0, z);
+        z[0] = gamma;
+        z[n-1] = bottom;
+        for (i = 1; i < n; i++) z[i] = z[i] - l[i-1] * z[i-1];
+        z[n-1] = uinv[n-1] * z[n-1];
+        for (i = n - 2; i >= 0; i--)
+        {
+            z[i] = uinv[i] * (z[i] - upper[i] * z[i+1]);
+        }
+
+        for (i = 0; i < n; i++) F->z[i] = z[i];
+        F->vlast = top / gamma;
+        F->denom = 1.0 + z[0] + (top / gamma) * z[n-1];
+    }
+
+    free(l);
+    free(uinv);
+    free(z);
+}
+
+
+
+
+
+void cftriFactSolve(CFTriFactMat F, CFarray RHS, CFarray ans)
+{
+
+/** Solve in single precision with a factorization of cftriCyclicFactor.
+  * The Sherman-Morrison scalar is accumulated in double.  RHS  and  ans
+  * must be different arrays **/
+
+    int
+        i,
+        n;
+
+    float complex
+        s;
+
+    CFarray
+        upper,
+        l,
+        uinv,
+        z;
+
+    n = F->n;
+    upper = F->upper;
+    l = F->l;
+    uinv = F->uinv;
+    z = F->z;
+
+    ans[0] = RHS[0];
+    for (i = 1; i < n; i++) ans[i] = RHS[i] - l[i-1] * ans[i-1];
+
+    ans[n-1] = uinv[n-1] * ans[n-1];
+    for (i = n - 2; i >= 0; i--)
+    {
+        ans[i] = uinv[i] * (ans[i] - upper[i] * ans[i+1]);
+    }
+
+    if (!F->cyclic) return;
+
+    s = ((double complex) ans[0] + (double complex) F->vlast * ans[n-1])
+      / (double complex) F->denom;
+
+    for (i = 0; i < n; i++) ans[i] = ans[i] - s * z[i];
+}
+
+
+
+
+
+static void inv2(double * A, double * Ainv)
+{
+
+/** Inverse of 2 x 2 matrix A stored in row major order **/
+
+    double
+        det;
+
+    det = A[0] * A[3] - A[1] * A[2];
+
+    if (det == 0)
+    {
+        printf("\n\n\tERROR : singular pivot block in block ");
+        printf("tridiagonal factorization\n\n");
+        exit(EXIT_FAILURE);
+    }
+
+    Ainv[0] =   A[3] / det;
+    Ainv[1] = - A[1] / det;
+    Ainv[2] = - A[2] / det;
+    Ainv[3] =   A[0] / det;
+}
+
+
+
+
+
+static void mul2(double * A, double * B, double * C)
+{
+
+/** C = A . B  for 2 x 2 matrices in row major order **/
+
+    double
+        c0,
+        c1,
+        c2;
+
+    c0 = A[0] * B[0] + A[1] * B[2];
+    c1 = A[0] * B[1] + A[1] * B[3];
+    c2 = A[2] * B[0] + A[3] * B[2];
+    C[3] = A[2] * B[1] + A[3] * B[3];
+    C[0] = c0;
+    C[1] = c1;
+    C[2] = c2;
+}
+
+
+
+
+
+void rblocktriFactor(int n, Rarray upper, Rarray lower, Rarray mid,
+     RBlockTriFactMat F)
+{
+
+/** Block LU (Thomas) factorization of the tridiagonal matrix of 2 x 2
+  * blocks.  Each block takes 4 consecutive numbers in row major order,
+  * mid has n blocks while upper and lower have n - 1.  Block j of upper
+  * is A[j][j+1] and block j of lower is A[j+1][j]. The pivot blocks are
+  * kept inverted and the upper blocks multiplied by them, thus a solve
+  * needs only 2 x 2 matrix-vector products **/
+
+    int
+        j;
+
+    double
+        S[4],
+        LC[4];
+
+    Rarray
+        c = F->c,
+        sinv = F->sinv;
+
+    if (n > 1) rarrCopy(4 * (n - 1), lower, F->lower);
+
+    inv2(mid, sinv);
+
+    for (j = 1; j < n; j++)
+    {
+        mul2(sinv + 4 * (j - 1), upper + 4 * (j - 1), c + 4 * (j - 1));
+        mul2(lower + 4 * (j - 1), c + 4 * (j - 1), LC);
+        S[0] = mid[4 * j] - LC[0];
+        S[1] = mid[4 * j + 1] - LC[1];
+        S[2] = mid[4 * j + 2] - LC[2];
+        S[3] = mid[4 * j + 3] - LC[3];
+        inv2(S, sinv + 4 * j);
+    }
+}
+
+
+
+
+
+void rblocktriSolve(RBlockTriFactMat F, Rarray RHS, Rarray ans)
+{
+
+/** Solve with the factorization of rblocktriFactor. The two components
+  * of block j are RHS[j] and RHS[j + n] (and the same for ans), as the
+  * real and imaginary parts of a complex system written in real form **/
+
+    int
+        j,
+        n = F->n;
+
+    double
+        b0,
+        b1,
+        * L,
+        * S,
+        * C;
+
+    Rarray
+        x0 = ans,
+        x1 = ans + n;
+
+    S = F->sinv;
+    x0[0] = S[0] * RHS[0] + S[1] * RHS[n];
+    x1[0] = S[2] * RHS[0] + S[3] * RHS[n];
+
+    for (j = 1; j < n; j++)
+    {
+        L = F->lower + 4 * (j - 1);
+        S = F->sinv + 4 * j;
+        b0 = RHS[j] - L[0] * x0[j - 1] - L[1] * x1[j - 1];
+        b1 = RHS[j + n] - L[2] * x0[j - 1] - L[3] * x1[j - 1];
+        x0[j] = S[0] * b0 + S[1] * b1;
+        x1[j] = S[2] * b0 + S[3] * b1;
+    }
+
+    for (j = n - 2; j >= 0; j--)
+    {
+        C = F->c + 4 * j;
+        x0[j] = x0[j] - C[0] * x0[j + 1] - C[1] * x1[j + 1];
+        x1[j] = x1[j] - C[2] * x0[j + 1] - C[3] * x1[j + 1];
+    }
+}